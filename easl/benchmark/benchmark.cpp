@@ -0,0 +1,998 @@
+/**
+*   \file   benchmark.cpp
+*   \author Dave Reid
+*   \brief  Microbenchmarks for each of the EASL function families.
+*
+*   Every family is timed for char, char16_t, char32_t and wchar_t strings across four corpora:
+*   pure ASCII, Latin (accented letters), CJK-heavy and emoji-heavy. The corpora all hold the same
+*   kind of space separated, multi-line text so that the numbers can be compared between encodings.
+*
+*   The results are written to stdout as CSV with the following columns:
+*       family,function,type,corpus,bytes,iterations,ns_per_op,bytes_per_sec
+*   where \c bytes is the size of the input for a single operation. Save the output of two builds
+*   and diff or join them on the first four columns to compare releases.
+*
+*   Building:
+*       cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+*       cmake --build build --config Release
+*   or directly with GCC:
+*       g++ -O2 -pthread -iquote ../source benchmark.cpp -o easl_benchmark
+*   On GCC and Clang the source directory must be given with -iquote rather than -I because
+*   EASL's string.h would otherwise be picked up in place of the standard <string.h>.
+*
+*   Options:
+*       --filter <text>   Only run the benchmarks whose family or function contains <text>.
+*       --min-time <ms>   The minimum time to spend on each benchmark. Defaults to 100.
+*       --size <bytes>    The approximate size of each corpus in UTF-8 bytes. Defaults to 65536.
+*
+*   The "parallel" family only starts any threads when the corpus is larger than EASL_PARALLEL_THRESHOLD,
+*   so it needs a --size of a few MB to be any different from the single threaded functions.
+*/
+#include "easl.h"
+#include "easlext.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#if (PLATFORM == PLATFORM_WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+using namespace easl;
+
+
+/// The number of nanoseconds each benchmark should run for at a minimum.
+static double g_min_time = 100.0 * 1000000.0;
+
+/// The approximate size of each corpus in UTF-8 bytes.
+static size_t g_corpus_size = 65536;
+
+/// The text that must appear in the family or function name of a benchmark for it to run.
+static const char *g_filter = NULL;
+
+/// Every result is added to this so that the compiler can not remove the work being timed.
+static volatile size_t g_sink = 0;
+
+
+/**
+*   \brief  Retrieves a monotonic time stamp in nanoseconds.
+*/
+inline double now()
+{
+#if (PLATFORM == PLATFORM_WINDOWS)
+    static LARGE_INTEGER frequency = {0};
+    if (frequency.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&frequency);
+    }
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    return static_cast<double>(counter.QuadPart) * 1000000000.0 / static_cast<double>(frequency.QuadPart);
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<double>(ts.tv_sec) * 1000000000.0 + static_cast<double>(ts.tv_nsec);
+#endif
+}
+
+
+template <typename T> inline const char * type_name();
+template <> inline const char * type_name<char>()     { return "char"; }
+template <> inline const char * type_name<char16_t>() { return "char16_t"; }
+template <> inline const char * type_name<char32_t>() { return "char32_t"; }
+template <> inline const char * type_name<wchar_t>()  { return "wchar_t"; }
+
+
+/**
+*   \brief  A pseudo random number generator. The corpora must be identical between runs, so we can't use rand().
+*/
+struct random_generator
+{
+    random_generator() : state(0x2545F491)
+    {
+    }
+
+    /**
+    *   \brief  Retrieves a number in the range [min, max].
+    */
+    unsigned int next(unsigned int min, unsigned int max)
+    {
+        state = state * 1103515245 + 12345;
+        return min + static_cast<unsigned int>((state >> 8) % (max - min + 1));
+    }
+
+    unsigned int state;
+};
+
+
+/**
+*   \brief  A corpus before it has been converted to a particular string type.
+*/
+struct source_corpus
+{
+    source_corpus(const char *nameIn) : name(nameIn), text(), words(), last_line(0)
+    {
+    }
+
+    /// The name of the corpus as it appears in the results.
+    const char *name;
+
+    /// The text of the corpus. This is always null terminated.
+    std::vector<char32_t> text;
+
+    /// Each word in the corpus.
+    std::vector<std::vector<char32_t> > words;
+
+    /// The index in \c text of the start of the last line.
+    size_t last_line;
+};
+
+
+/**
+*   \brief  Converts UTF-32 text into the given string type.
+*/
+template <typename T>
+std::vector<T> convert(const std::vector<char32_t> &text)
+{
+    std::vector<char32_t> temp(text);
+    temp.push_back('\0');
+
+    const char32_t *src = &temp[0];
+
+    std::vector<T> result(copysize<T>(src));
+    copy(&result[0], src, result.size());
+
+    return result;
+}
+
+/**
+*   \brief  Appends a string literal to UTF-32 text.
+*/
+inline void append(std::vector<char32_t> &text, const char *str)
+{
+    while (*str != '\0')
+    {
+        text.push_back(static_cast<char32_t>(*str++));
+    }
+}
+
+inline void append(std::vector<char32_t> &text, const std::vector<char32_t> &str)
+{
+    text.insert(text.end(), str.begin(), str.end());
+}
+
+
+/**
+*   \brief  Generates a word for the given corpus.
+*/
+std::vector<char32_t> make_word(const char *corpus, random_generator &rng)
+{
+    static const char *ascii_words[] =
+    {
+        "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "string", "library",
+        "encoding", "unicode", "buffer", "character", "pointer", "length", "token", "list",
+        "path", "file", "value", "search", "split", "line", "copy", "compare", "parse", "format"
+    };
+    static const size_t ascii_word_count = sizeof(ascii_words) / sizeof(ascii_words[0]);
+
+    std::vector<char32_t> word;
+
+    if (strcmp(corpus, "cjk") == 0)
+    {
+        // Runs of two to four ideographs from the CJK Unified Ideographs block.
+        unsigned int count = rng.next(2, 4);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            word.push_back(static_cast<char32_t>(rng.next(0x4E00, 0x9FA5)));
+        }
+
+        // The odd bit of ASCII, like you'd see with numbers and names in real text.
+        if (rng.next(0, 9) == 0)
+        {
+            append(word, ascii_words[rng.next(0, ascii_word_count - 1)]);
+        }
+
+        return word;
+    }
+
+    append(word, ascii_words[rng.next(0, ascii_word_count - 1)]);
+
+    if (strcmp(corpus, "latin") == 0)
+    {
+        // Swap roughly a third of the letters for ones from Latin-1 Supplement and Latin Extended-A.
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            if (rng.next(0, 2) == 0)
+            {
+                uchar32_t ch;
+                do
+                {
+                    ch = rng.next(0xC0, 0x17F);
+                } while (ch == 0xD7 || ch == 0xF7);     // Skip the multiplication and division signs.
+
+                word[i] = static_cast<char32_t>(ch);
+            }
+        }
+    }
+    else if (strcmp(corpus, "emoji") == 0)
+    {
+        // Most words are followed by one or two emoji from Miscellaneous Symbols and Pictographs and Emoticons.
+        if (rng.next(0, 3) != 0)
+        {
+            unsigned int count = rng.next(1, 2);
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                word.push_back(static_cast<char32_t>(rng.next(0x1F300, 0x1F64F)));
+            }
+        }
+    }
+
+    return word;
+}
+
+/**
+*   \brief  Generates a corpus.
+*/
+source_corpus make_corpus(const char *name)
+{
+    source_corpus corpus(name);
+
+    random_generator rng;
+    size_t utf8_size = 0;
+    size_t words_on_line = 0;
+
+    while (utf8_size < g_corpus_size)
+    {
+        if (!corpus.words.empty())
+        {
+            // Lines are between 8 and 15 words long.
+            if (words_on_line >= 8 && rng.next(0, 7) == 0)
+            {
+                corpus.text.push_back('\n');
+                corpus.last_line = corpus.text.size();
+                words_on_line = 0;
+            }
+            else
+            {
+                corpus.text.push_back(' ');
+            }
+
+            utf8_size += 1;
+        }
+
+        std::vector<char32_t> word = make_word(name, rng);
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            utf8_size += charwidth<char>(word[i]);
+        }
+
+        append(corpus.text, word);
+        corpus.words.push_back(word);
+        ++words_on_line;
+    }
+
+    return corpus;
+}
+
+
+/**
+*   \brief  A corpus converted to a particular string type, along with everything the benchmarks need.
+*/
+template <typename T>
+struct corpus
+{
+    corpus(const source_corpus &source) : name(source.name)
+    {
+        text = convert<T>(source.text);
+        text_length = text.size() - 1;
+
+        // The needle for substring searches is the last line, so it is only found near the end.
+        std::vector<char32_t> needle_src(source.text.begin() + source.last_line, source.text.end());
+        needle = convert<T>(needle_src);
+        needle_length = needle.size() - 1;
+
+        // The list for extractlist() holds each word of the corpus.
+        std::vector<char32_t> list_src;
+        list_src.push_back('{');
+        for (size_t i = 0; i < source.words.size(); ++i)
+        {
+            if (i > 0)
+            {
+                append(list_src, ", ");
+            }
+
+            append(list_src, source.words[i]);
+        }
+        list_src.push_back('}');
+        list = convert<T>(list_src);
+
+        // The paths are made from the first few words.
+#if (PLATFORM == PLATFORM_WINDOWS)
+        const char *root = "C:/";
+#else
+        const char *root = "/";
+#endif
+
+        std::vector<char32_t> path_src;
+        std::vector<char32_t> base_src;
+        std::vector<char32_t> relative_src;
+        append(path_src, root);
+        append(base_src, root);
+        append(relative_src, "../..");
+        for (size_t i = 0; i < 6 && i < source.words.size(); ++i)
+        {
+            append(path_src, source.words[i]);
+            append(path_src, "/");
+
+            if (i < 3)
+            {
+                append(base_src, source.words[i]);
+                append(base_src, "/");
+            }
+            else
+            {
+                append(relative_src, "/");
+                append(relative_src, source.words[i]);
+            }
+        }
+        append(path_src, "file.txt");
+        append(base_src, "other/folder");
+        append(relative_src, "/file.txt");
+
+        path     = convert<T>(path_src);
+        base     = convert<T>(base_src);
+        relative = convert<T>(relative_src);
+
+        std::vector<char32_t> number_src;
+        append(number_src, "-1234567");
+        number = convert<T>(number_src);
+    }
+
+    /// Returns the size in bytes of a null terminated string held in a vector.
+    static size_t bytes(const std::vector<T> &str)
+    {
+        return (str.size() - 1) * sizeof(T);
+    }
+
+    const char *name;
+
+    std::vector<T> text;
+    size_t         text_length;
+
+    std::vector<T> needle;
+    size_t         needle_length;
+
+    std::vector<T> list;
+    std::vector<T> path;
+    std::vector<T> base;
+    std::vector<T> relative;
+    std::vector<T> number;
+};
+
+
+/**
+*   \brief  Determines whether or not a benchmark should be run based on --filter.
+*/
+inline bool included(const char *family, const char *function)
+{
+    return g_filter == NULL || strstr(family, g_filter) != NULL || strstr(function, g_filter) != NULL;
+}
+
+/**
+*   \brief                 Times a benchmark and prints its result.
+*   \param  family    [in] The family of functions being benchmarked.
+*   \param  function  [in] The function or overload being benchmarked.
+*   \param  c         [in] The corpus the benchmark is using.
+*   \param  bytes     [in] The size of the input to a single operation.
+*   \param  benchmark [in] The functor performing a single operation.
+*
+*   \remarks
+*       The number of iterations is doubled until the benchmark runs for at least --min-time.
+*/
+template <typename T, typename F>
+void run(const char *family, const char *function, const corpus<T> &c, size_t bytes, F benchmark)
+{
+    if (!included(family, function))
+    {
+        return;
+    }
+
+    // Warm up the caches and anything that is lazily initialised, like the CPU feature checks.
+    benchmark();
+
+    size_t iterations = 1;
+    double elapsed;
+    for (;;)
+    {
+        double start = now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            benchmark();
+        }
+        elapsed = now() - start;
+
+        if (elapsed >= g_min_time)
+        {
+            break;
+        }
+
+        iterations *= 2;
+    }
+
+    double ns_per_op     = elapsed / static_cast<double>(iterations);
+    double bytes_per_sec = static_cast<double>(bytes) * 1000000000.0 / ns_per_op;
+
+    printf("%s,%s,%s,%s,%lu,%lu,%.2f,%.0f\n", family, function, type_name<T>(), c.name,
+           static_cast<unsigned long>(bytes), static_cast<unsigned long>(iterations), ns_per_op, bytes_per_sec);
+    fflush(stdout);
+}
+
+
+// Each benchmark is a functor that performs a single operation. They're functors rather than
+// functions so that the call can be inlined into the timing loop.
+
+template <typename T>
+struct bench_length
+{
+    bench_length(const T *strIn) : str(strIn) {}
+    void operator()() { g_sink += length(str); }
+    const T *str;
+};
+
+template <typename T>
+struct bench_charcount
+{
+    bench_charcount(const T *strIn) : str(strIn) {}
+    void operator()() { g_sink += charcount(str); }
+    const T *str;
+};
+
+template <typename T, typename U>
+struct bench_copy
+{
+    bench_copy(const T *srcIn, std::vector<U> &destIn) : src(srcIn), dest(destIn) {}
+    void operator()() { g_sink += copy(&dest[0], src, dest.size()); }
+    const T *src;
+    std::vector<U> &dest;
+};
+
+template <typename T>
+struct bench_copysize
+{
+    bench_copysize(const T *srcIn) : src(srcIn) {}
+    void operator()() { g_sink += copysize<char>(src) + copysize<char16_t>(src) + copysize<char32_t>(src); }
+    const T *src;
+};
+
+template <typename T, typename U>
+struct bench_parallel_copy
+{
+    bench_parallel_copy(const T *srcIn, std::vector<U> &destIn) : src(srcIn), dest(destIn) {}
+    void operator()() { g_sink += parallel_copy(&dest[0], src, dest.size()); }
+    const T *src;
+    std::vector<U> &dest;
+};
+
+template <typename T>
+struct bench_parallel_charcount
+{
+    bench_parallel_charcount(const T *strIn) : str(strIn) {}
+    void operator()() { g_sink += parallel_charcount(str); }
+    const T *str;
+};
+
+struct bench_parallel_validate_utf8
+{
+    bench_parallel_validate_utf8(const char *strIn, size_t strLengthIn) : str(strIn), str_length(strLengthIn) {}
+    void operator()() { g_sink += parallel_validate_utf8(str, str_length); }
+    const char *str;
+    size_t str_length;
+};
+
+struct bench_validate_utf8
+{
+    bench_validate_utf8(const char *strIn, size_t strLengthIn) : str(strIn), str_length(strLengthIn) {}
+    void operator()() { g_sink += validate_utf8(str, str_length); }
+    const char *str;
+    size_t str_length;
+};
+
+template <typename T>
+struct bench_compare
+{
+    bench_compare(const T *str1In, const T *str2In) : str1(str1In), str2(str2In) {}
+    void operator()() { g_sink += static_cast<size_t>(compare(str1, str2)); }
+    const T *str1;
+    const T *str2;
+};
+
+template <typename T>
+struct bench_equal
+{
+    bench_equal(const T *str1In, const T *str2In, bool caseSensitiveIn) : str1(str1In), str2(str2In), case_sensitive(caseSensitiveIn) {}
+    void operator()() { g_sink += equal(str1, str2, case_sensitive); }
+    const T *str1;
+    const T *str2;
+    bool case_sensitive;
+};
+
+template <typename T>
+struct bench_findfirst_char
+{
+    bench_findfirst_char(const T *strIn) : str(strIn) {}
+    void operator()() { g_sink += (findfirst(str, '~') == NULL); }     // '~' is never in a corpus, so the whole string is searched.
+    const T *str;
+};
+
+template <typename T>
+struct bench_findlast_char
+{
+    bench_findlast_char(const T *strIn) : str(strIn) {}
+    void operator()() { g_sink += (findlast(str, '~') == NULL); }
+    const T *str;
+};
+
+template <typename T>
+struct bench_findfirst_string
+{
+    bench_findfirst_string(const T *strIn, const T *needleIn) : str(strIn), needle(needleIn) {}
+    void operator()() { g_sink += (findfirst(str, needle) == NULL); }
+    const T *str;
+    const T *needle;
+};
+
+template <typename T>
+struct bench_findfirstnocase
+{
+    bench_findfirstnocase(const T *strIn, const T *needleIn) : str(strIn), needle(needleIn) {}
+    void operator()() { g_sink += (findfirstnocase(str, needle) == NULL); }
+    const T *str;
+    const T *needle;
+};
+
+template <typename T>
+struct bench_findfirst_searcher
+{
+    bench_findfirst_searcher(const T *strIn, const T *needleIn) : str(strIn), needle(needleIn) {}
+    void operator()() { g_sink += (findfirst(str, needle) == NULL); }
+    const T *str;
+    searcher<T> needle;
+};
+
+template <typename T>
+struct bench_count_lines
+{
+    bench_count_lines(const T *strIn) : str(strIn), needle(line_feed, 1) {}
+    void operator()() { g_sink += count(str, needle); }
+    const T *str;
+    static const T line_feed[2];
+    searcher<T> needle;
+};
+
+template <typename T>
+const T bench_count_lines<T>::line_feed[2] = {'\n', '\0'};
+
+template <typename T>
+struct bench_findall_searcher
+{
+    bench_findall_searcher(const T *strIn, const T *needleIn) : str(strIn), needle(needleIn) {}
+    void operator()()
+    {
+        match_range<const T, T> matches = findall(str, needle);
+        for (typename match_range<const T, T>::iterator i = matches.begin(); i != matches.end(); ++i)
+        {
+            g_sink += static_cast<size_t>(i->end - i->start);
+        }
+    }
+    const T *str;
+    searcher<T> needle;
+};
+
+/// Builds a multi_searcher for 2000 keywords, a few of which are words that show up in the corpora.
+template <typename T>
+search::multi_searcher<T> make_keyword_searcher()
+{
+    static const char *words[] = {"Search", "SPLIT", "token", "Pointer"};
+
+    std::vector<std::vector<T> > keywords;
+    for (int i = 0; i < 2000; ++i)
+    {
+        std::vector<char32_t> keyword;
+        if (i < 4)
+        {
+            append(keyword, words[i]);
+        }
+        else
+        {
+            char name[32];
+            sprintf(name, "keyword%d", i);
+            append(keyword, name);
+        }
+
+        keywords.push_back(convert<T>(keyword));
+    }
+
+    std::vector<const T *> patterns;
+    for (size_t i = 0; i < keywords.size(); ++i)
+    {
+        patterns.push_back(&keywords[i][0]);
+    }
+
+    return search::multi_searcher<T>(&patterns[0], patterns.size(), true);
+}
+
+template <typename T>
+struct bench_multi_searcher
+{
+    bench_multi_searcher(const T *strIn, size_t strLengthIn) : str(strIn), str_length(strLengthIn), searcher(make_keyword_searcher<T>()), matches() {}
+    void operator()()
+    {
+        matches.clear();
+        g_sink += searcher.findall(str, str_length, matches);
+    }
+    const T *str;
+    size_t str_length;
+    search::multi_searcher<T> searcher;
+    std::vector<search::multi_match> matches;
+};
+
+template <typename T>
+struct bench_containsprintablechar
+{
+    // A blank payload of the same size as the corpus, so the whole string is checked.
+    bench_containsprintablechar(size_t strLength) : str(strLength, T(' ')) {}
+    void operator()() { g_sink += search::containsprintablechar(&str[0], str.size()); }
+    std::vector<T> str;
+};
+
+template <typename T>
+struct bench_findfirstof
+{
+    bench_findfirstof(const T *strIn) : str(strIn)
+    {
+        charset[0] = '~';
+        charset[1] = '|';
+        charset[2] = '^';
+        charset[3] = '\0';
+    }
+    void operator()() { g_sink += (findfirstof(str, charset) == NULL); }
+    const T *str;
+    T charset[4];
+};
+
+template <typename T>
+struct bench_findfirstof_charset
+{
+    bench_findfirstof_charset(const T *strIn) : str(strIn), set()
+    {
+        // More than findfirstof() handles by searching for each character in turn.
+        static const char chars[] = "~|^`{}#@";
+        for (const char *ch = chars; *ch != '\0'; ++ch)
+        {
+            set.add(static_cast<uchar32_t>(*ch));
+        }
+    }
+    void operator()() { g_sink += (findfirstof(str, set) == NULL); }
+    const T *str;
+    charset<T> set;
+};
+
+template <typename T>
+struct bench_split
+{
+    bench_split(T *strIn, size_t strLengthIn) : str(strIn), str_length(strLengthIn), list()
+    {
+        delimiter[0] = ' ';
+        delimiter[1] = '\0';
+    }
+    void operator()()
+    {
+        list.clear();
+        split(str, delimiter, list, false, str_length);
+        g_sink += list.size();
+    }
+    T *str;
+    size_t str_length;
+    T delimiter[2];
+    std::vector<reference_string<T> > list;
+};
+
+template <typename T>
+struct bench_nextline
+{
+    bench_nextline(T *strIn) : str(strIn) {}
+    void operator()()
+    {
+        reference_string<T> line;
+        T *temp = str;
+        while (nextline(line, temp))
+        {
+            g_sink += length(line);
+        }
+    }
+    T *str;
+};
+
+template <typename T>
+struct bench_replace
+{
+    bench_replace(std::vector<T> &strIn) : str(strIn), replaced(false) {}
+    void operator()()
+    {
+        // Each call swaps the spaces for underscores or back again, so the string is the same every second call.
+        if (replaced)
+        {
+            g_sink += replace(&str[0], '_', ' ', str.size(), str.size() - 1);
+        }
+        else
+        {
+            g_sink += replace(&str[0], ' ', '_', str.size(), str.size() - 1);
+        }
+
+        replaced = !replaced;
+    }
+    std::vector<T> &str;
+    bool replaced;
+};
+
+template <typename T>
+struct bench_parse
+{
+    bench_parse(const T *strIn) : str(strIn) {}
+    void operator()() { g_sink += static_cast<size_t>(parse<int>(str)); }
+    const T *str;
+};
+
+template <typename T>
+struct bench_tostring
+{
+    bench_tostring() : value(-1234567) {}
+    void operator()()
+    {
+        T dest[32];
+        tostring(value, dest);
+        g_sink += static_cast<size_t>(dest[0]);
+    }
+    int value;
+};
+
+template <typename T>
+struct bench_nexttoken
+{
+    bench_nexttoken(T *strIn) : str(strIn) {}
+    void operator()()
+    {
+        reference_string<T> token;
+        T *temp = str;
+        while (tokens::nexttoken(temp, token, NULL))
+        {
+            g_sink += 1;
+        }
+    }
+    T *str;
+};
+
+template <typename T>
+struct bench_extracttokens
+{
+    bench_extracttokens(T *strIn) : str(strIn), list() {}
+    void operator()()
+    {
+        list.clear();
+        tokens::extracttokens(str, list, NULL);
+        g_sink += list.size();
+    }
+    T *str;
+    std::vector<reference_string<T> > list;
+};
+
+template <typename T>
+struct bench_extractlist
+{
+    bench_extractlist(T *strIn) : str(strIn), items() {}
+    void operator()()
+    {
+        items.clear();
+        list::extractlist(str, items);
+        g_sink += items.size();
+    }
+    T *str;
+    std::vector<reference_string<T> > items;
+};
+
+template <typename T>
+struct bench_getfileext
+{
+    bench_getfileext(const T *pathIn) : path(pathIn) {}
+    void operator()()
+    {
+        T dest[64];
+        g_sink += paths::getfileext(dest, path);
+    }
+    const T *path;
+};
+
+template <typename T>
+struct bench_splitpath
+{
+    bench_splitpath(T *pathIn) : path(pathIn) {}
+    void operator()()
+    {
+        reference_string<T> folder;
+        reference_string<T> file;
+        paths::splitpath(path, folder, file);
+        g_sink += length(file);
+    }
+    T *path;
+};
+
+template <typename T>
+struct bench_isabsolute
+{
+    bench_isabsolute(const T *pathIn) : path(pathIn) {}
+    void operator()() { g_sink += paths::isabsolute(path); }
+    const T *path;
+};
+
+template <typename T>
+struct bench_absolute
+{
+    bench_absolute(const T *pathIn, const T *baseIn) : path(pathIn), base(baseIn) {}
+    void operator()()
+    {
+        T dest[1024];
+        g_sink += paths::absolute(dest, path, base);
+    }
+    const T *path;
+    const T *base;
+};
+
+template <typename T>
+struct bench_relative
+{
+    bench_relative(const T *pathIn, const T *baseIn) : path(pathIn), base(baseIn) {}
+    void operator()()
+    {
+        T dest[1024];
+        g_sink += paths::relative(dest, path, base);
+    }
+    const T *path;
+    const T *base;
+};
+
+
+/**
+*   \brief  Runs the validator benchmarks. validate_utf8() only exists for char strings.
+*/
+template <typename T>
+inline void run_validate(const corpus<T> &)
+{
+}
+
+inline void run_validate(const corpus<char> &c)
+{
+    run("copy",     "validate_utf8",          c, corpus<char>::bytes(c.text), bench_validate_utf8(&c.text[0], c.text_length));
+    run("parallel", "parallel_validate_utf8", c, corpus<char>::bytes(c.text), bench_parallel_validate_utf8(&c.text[0], c.text_length));
+}
+
+
+/**
+*   \brief  Runs every benchmark for a single string type and corpus.
+*/
+template <typename T>
+void run_all(const source_corpus &source)
+{
+    corpus<T> c(source);
+
+    const T *text       = &c.text[0];
+    T       *text_mut   = &c.text[0];
+    size_t   text_bytes = corpus<T>::bytes(c.text);
+
+    // A second copy of the text so that compare() and equal() have to look at every character.
+    std::vector<T> other(c.text);
+
+    run("length", "length", c, text_bytes, bench_length<T>(text));
+
+    run("charcount", "charcount", c, text_bytes, bench_charcount<T>(text));
+
+    std::vector<char>     dest8(copysize<char>(text));
+    std::vector<char16_t> dest16(copysize<char16_t>(text));
+    std::vector<char32_t> dest32(copysize<char32_t>(text));
+    run("copy", "copy_to_utf8",  c, text_bytes, bench_copy<T, char>(text, dest8));
+    run("copy", "copy_to_utf16", c, text_bytes, bench_copy<T, char16_t>(text, dest16));
+    run("copy", "copy_to_utf32", c, text_bytes, bench_copy<T, char32_t>(text, dest32));
+    run("copy", "copysize",      c, text_bytes, bench_copysize<T>(text));
+    run_validate(c);
+
+    run("parallel", "parallel_copy_to_utf8",  c, text_bytes, bench_parallel_copy<T, char>(text, dest8));
+    run("parallel", "parallel_copy_to_utf16", c, text_bytes, bench_parallel_copy<T, char16_t>(text, dest16));
+    run("parallel", "parallel_charcount",     c, text_bytes, bench_parallel_charcount<T>(text));
+
+    run("compare", "compare",                c, text_bytes, bench_compare<T>(text, &other[0]));
+    run("compare", "equal",                  c, text_bytes, bench_equal<T>(text, &other[0], true));
+    run("compare", "equal_case_insensitive", c, text_bytes, bench_equal<T>(text, &other[0], false));
+
+    run("findfirst", "findfirst_char",   c, text_bytes, bench_findfirst_char<T>(text));
+    run("findfirst", "findfirst_string", c, text_bytes, bench_findfirst_string<T>(text, &c.needle[0]));
+    run("findfirst", "findfirst_searcher", c, text_bytes, bench_findfirst_searcher<T>(text, &c.needle[0]));
+    run("findfirst", "findfirstnocase",  c, text_bytes, bench_findfirstnocase<T>(text, &c.needle[0]));
+    run("findfirst", "findlast_char",    c, text_bytes, bench_findlast_char<T>(text));
+    run("findfirst", "findall_searcher", c, text_bytes, bench_findall_searcher<T>(text, &c.needle[0]));
+    run("findfirst", "count_lines",      c, text_bytes, bench_count_lines<T>(text));
+    run("findfirst", "findfirstof",      c, text_bytes, bench_findfirstof<T>(text));
+    run("findfirst", "findfirstof_charset", c, text_bytes, bench_findfirstof_charset<T>(text));
+
+    run("split", "split", c, text_bytes, bench_split<T>(text_mut, c.text_length));
+
+    run("search", "multi_searcher", c, text_bytes, bench_multi_searcher<T>(text, c.text_length));
+    run("search", "containsprintablechar", c, text_bytes, bench_containsprintablechar<T>(c.text_length));
+
+    run("nextline", "nextline", c, text_bytes, bench_nextline<T>(text_mut));
+
+    std::vector<T> replace_text(c.text);
+    run("replace", "replace", c, text_bytes, bench_replace<T>(replace_text));
+
+    run("parse", "parse_int",    c, corpus<T>::bytes(c.number), bench_parse<T>(&c.number[0]));
+    run("parse", "tostring_int", c, corpus<T>::bytes(c.number), bench_tostring<T>());
+
+    run("tokens", "nexttoken",     c, text_bytes, bench_nexttoken<T>(text_mut));
+    run("tokens", "extracttokens", c, text_bytes, bench_extracttokens<T>(text_mut));
+
+    run("list", "extractlist", c, corpus<T>::bytes(c.list), bench_extractlist<T>(&c.list[0]));
+
+    run("paths", "getfileext", c, corpus<T>::bytes(c.path),     bench_getfileext<T>(&c.path[0]));
+    run("paths", "splitpath",  c, corpus<T>::bytes(c.path),     bench_splitpath<T>(&c.path[0]));
+    run("paths", "isabsolute", c, corpus<T>::bytes(c.path),     bench_isabsolute<T>(&c.path[0]));
+    run("paths", "absolute",   c, corpus<T>::bytes(c.relative), bench_absolute<T>(&c.relative[0], &c.base[0]));
+    run("paths", "relative",   c, corpus<T>::bytes(c.path),     bench_relative<T>(&c.path[0], &c.base[0]));
+}
+
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            g_filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+        {
+            g_min_time = atof(argv[++i]) * 1000000.0;
+        }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            g_corpus_size = static_cast<size_t>(atol(argv[++i]));
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--filter <text>] [--min-time <ms>] [--size <bytes>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static const char *corpus_names[] = {"ascii", "latin", "cjk", "emoji"};
+
+    printf("family,function,type,corpus,bytes,iterations,ns_per_op,bytes_per_sec\n");
+
+    for (size_t i = 0; i < sizeof(corpus_names) / sizeof(corpus_names[0]); ++i)
+    {
+        source_corpus source = make_corpus(corpus_names[i]);
+
+        run_all<char>(source);
+        run_all<char16_t>(source);
+        run_all<char32_t>(source);
+        run_all<wchar_t>(source);
+    }
+
+    return 0;
+}
@@ -3,8 +3,9 @@
 *   \author Dave Reid
 *   \brief  Header file for private UTF encoded string functionality.
 *
-*   Some of the code here is taken from ftp://www.unicode.org/Public/PROGRAMS/CVTUTF/.
-*   The full copyright notice can be found at the bottom of this document.
+*   Some of the code here is taken from ftp://www.unicode.org/Public/PROGRAMS/CVTUTF/ and
+*   from Bjoern Hoehrmann's UTF-8 decoder. The full copyright notices can be found at the
+*   bottom of this document.
 *
 *   The functions in this file should not be used from outside EASL.
 */
@@ -69,6 +70,41 @@ static const uchar32_t g_offsetsFromUTF8[6] = {0x00000000UL, 0x00003080UL, 0x000
  */
 static const unsigned char g_firstByteMark[7] = {0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC};
 
+/*
+ * States of the UTF-8 decoding automaton in g_utf8DFA. Every other state means
+ * that the decoder is in the middle of a multi-byte sequence.
+ */
+#define UNI_UTF8_ACCEPT         0
+#define UNI_UTF8_REJECT         12
+
+/*
+ * The UTF-8 decoding automaton by Bjoern Hoehrmann. The full copyright notice can
+ * be found at the bottom of this document.
+ *
+ * The first 256 entries map each byte to a character class. The rest is the
+ * transition table, indexed with the current state plus the class of the next
+ * byte. States are premultiplied by 12 (the number of classes) so that the next
+ * state can be used as an index directly. Overlong forms, surrogates and values
+ * above U+10FFFF all lead to UNI_UTF8_REJECT, as does a null byte in the middle of
+ * a sequence.
+ */
+static const unsigned char g_utf8DFA[364] = {
+     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,  9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+     7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,  7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+     8, 8, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    10, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 3, 3, 11, 6, 6, 6, 5, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+
+     0,12,24,36,60,96,84,12,12,12,48,72, 12,12,12,12,12,12,12,12,12,12,12,12,
+    12, 0,12,12,12,12,12, 0,12, 0,12,12, 12,24,12,12,12,12,12,24,12,24,12,12,
+    12,12,12,12,12,12,12,24,12,12,12,12, 12,24,12,12,12,12,12,12,12,24,12,12,
+    12,12,12,12,12,12,12,36,12,36,12,12, 12,36,12,12,12,12,12,36,12,36,12,12,
+    12,36,12,12,12,12,12,12,12,12,12,12
+};
+
 /**
 *   \brief              Determines if the next UTF-8 character in the specified string is legal.
 *   \param  str    [in] The string whose first character needs to be checked.
@@ -128,7 +164,8 @@ inline bool is_legal_utf8(const char *str, unsigned short length)
 
             case 0xED:
                 {
-                    if (a < 0x9F)
+                    // 0xED 0xA0 and above are UTF-16 surrogates.
+                    if (a < 0x80 || a > 0x9F)
                     {
                         return false;
                     }
@@ -148,7 +185,8 @@ inline bool is_legal_utf8(const char *str, unsigned short length)
 
             case 0xF4:
                 {
-                    if (a < 0x8F)
+                    // 0xF4 0x90 and above are larger than U+10FFFF.
+                    if (a < 0x80 || a > 0x8F)
                     {
                         return false;
                     }
@@ -307,3 +345,26 @@ void _movestrdown(T *source, size_t count, size_t sourceSize)
  * for internal or external distribution as long as this notice
  * remains attached.
  */
+
+
+/*
+ * Copyright (c) 2008-2010 Bjoern Hoehrmann <bjoern@hoehrmann.de>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
@@ -0,0 +1,139 @@
+/**
+*   \file   _simd.h
+*   \author Dave Reid
+*   \brief  Private header file for the vectorised code paths.
+*
+*   This header pulls in the intrinsics for the instruction sets that were enabled in
+*   setup.h and defines a few bit manipulation helpers that the vectorised kernels use
+*   to turn comparison masks into offsets.
+*   \par
+*   When EASL_SIMD_DISPATCH is defined, the intrinsics for every instruction set are made
+*   available. Kernels that use an instruction set which isn't enabled at compile time are
+*   marked with EASL_TARGET and must only be called after checking cpu_supports().
+*
+*   The functions in this file should not be used from outside EASL.
+*/
+#ifndef __EASL_SIMD_H_
+#define __EASL_SIMD_H_
+
+#include "setup.h"
+#include "cpu.h"
+
+#if defined(EASL_SIMD_DISPATCH) || defined(EASL_SIMD_AVX2) || defined(EASL_SIMD_AVX512BW)
+#include <immintrin.h>
+#elif defined(EASL_SIMD_SSE42)
+#include <nmmintrin.h>
+#elif defined(EASL_SIMD_SSSE3)
+#include <tmmintrin.h>
+#elif defined(EASL_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace easl
+{
+
+/**
+*   \brief             Retrieves the index of the lowest set bit in a mask.
+*   \param  mask [in]  The mask to scan. This can not be 0.
+*   \return            The zero based index of the lowest set bit.
+*/
+inline unsigned int _bitscan_forward(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+
+    return static_cast<unsigned int>(index);
+#elif defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+#else
+    unsigned int index = 0;
+    while ((mask & 1) == 0)
+    {
+        mask >>= 1;
+        ++index;
+    }
+
+    return index;
+#endif
+}
+
+/**
+*   \brief             Retrieves the index of the highest set bit in a mask.
+*   \param  mask [in]  The mask to scan. This can not be 0.
+*   \return            The zero based index of the highest set bit.
+*/
+inline unsigned int _bitscan_reverse(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+
+    return static_cast<unsigned int>(index);
+#elif defined(__GNUC__)
+    return 31 - static_cast<unsigned int>(__builtin_clz(mask));
+#else
+    unsigned int index = 31;
+    while ((mask & 0x80000000) == 0)
+    {
+        mask <<= 1;
+        --index;
+    }
+
+    return index;
+#endif
+}
+
+/**
+*   \brief             Retrieves the index of the lowest set bit in a 64-bit mask.
+*   \param  mask [in]  The mask to scan. This can not be 0.
+*   \return            The zero based index of the lowest set bit.
+*/
+inline unsigned int _bitscan_forward64(unsigned long long mask)
+{
+    unsigned int low = static_cast<unsigned int>(mask);
+    if (low != 0)
+    {
+        return _bitscan_forward(low);
+    }
+
+    return 32 + _bitscan_forward(static_cast<unsigned int>(mask >> 32));
+}
+
+/**
+*   \brief             Retrieves the number of set bits in a mask.
+*   \param  mask [in]  The mask whose bits should be counted.
+*   \return            The number of bits that are set in \c mask.
+*/
+inline unsigned int _popcount(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_popcount(mask));
+#else
+    // We can't rely on the popcnt instruction being available with Visual C, so we'll
+    // just do the usual bit twiddling.
+    mask = mask - ((mask >> 1) & 0x55555555);
+    mask = (mask & 0x33333333) + ((mask >> 2) & 0x33333333);
+    mask = (mask + (mask >> 4)) & 0x0F0F0F0F;
+
+    return (mask * 0x01010101) >> 24;
+#endif
+}
+
+/**
+*   \brief             Retrieves the number of set bits in a 64-bit mask.
+*   \param  mask [in]  The mask whose bits should be counted.
+*   \return            The number of bits that are set in \c mask.
+*/
+inline unsigned int _popcount64(unsigned long long mask)
+{
+    return _popcount(static_cast<unsigned int>(mask)) + _popcount(static_cast<unsigned int>(mask >> 32));
+}
+
+}
+
+#endif // __EASL_SIMD_H_
@@ -0,0 +1,545 @@
+/**
+*   \file   _transcode_kernels.h
+*   \author Dave Reid
+*   \brief  Private header file for the block transcoder kernels.
+*
+*   This file has no include guard. transcode.h includes it once for the instruction sets
+*   that are enabled at compile time and, when EASL_SIMD_DISPATCH is defined, once more for
+*   each instruction set that can be picked at runtime. The following macros must be defined
+*   before it is included:
+*       - EASL_KERNEL_NAMESPACE: the namespace inside easl to put the kernels in.
+*       - EASL_KERNEL_TARGET: the target of every function, see EASL_TARGET.
+*       - EASL_KERNEL_USE_SSSE3 and EASL_KERNEL_USE_AVX2: defined if the kernels can use them.
+*
+*   The functions in this file should not be used from outside EASL.
+*/
+
+namespace easl
+{
+namespace EASL_KERNEL_NAMESPACE
+{
+
+#if defined(EASL_SIMD_SSE2)
+/**
+*   \brief                  Decodes the run of similar UTF-8 characters at the start of a 16 byte block.
+*   \param  input     [in]  The block.
+*   \param  chars     [out] Receives the decoded characters. See remarks.
+*   \param  count     [out] Receives the number of characters that were decoded.
+*   \return                 The number of bytes that were decoded; or 0 if the first character needs the scalar path.
+*
+*   \remarks
+*       The return value divided by \c count gives the width of the decoded characters. For ASCII,
+*       \c chars is the input itself (one byte per character). For 2 byte sequences \c chars has
+*       8 16-bit lanes, and for 3 byte sequences \c chars has 4 32-bit lanes.
+*       \par
+*       Only whole, well formed characters are decoded. The null terminator is never decoded.
+*/
+EASL_KERNEL_TARGET inline size_t _utf8_decode_block(__m128i input, __m128i &chars, size_t &count)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    // Leading ASCII characters that are not the null terminator.
+    unsigned int stop = _mm_movemask_epi8(input) | _mm_movemask_epi8(_mm_cmpeq_epi8(input, zero));
+    if ((stop & 1) == 0)
+    {
+        count = (stop == 0) ? 16 : _bitscan_forward(stop);
+        chars = input;
+
+        return count;
+    }
+
+    // Leading 2 byte sequences. Each 16-bit lane holds the lead byte in the low half and the
+    // continuation byte in the high half. 0xC0 and 0xC1 are overlong and not allowed.
+    __m128i two = _mm_cmpeq_epi16(_mm_and_si128(input, _mm_set1_epi16((short)0xC0E0)), _mm_set1_epi16((short)0x80C0));
+    two = _mm_andnot_si128(_mm_cmpeq_epi16(_mm_and_si128(input, _mm_set1_epi16(0x001E)), zero), two);
+
+    stop = ~_mm_movemask_epi8(two) & 0xFFFF;
+    if ((stop & 1) == 0)
+    {
+        count = (stop == 0) ? 8 : _bitscan_forward(stop) / 2;
+        chars = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(input, _mm_set1_epi16(0x001F)), 6),
+                             _mm_and_si128(_mm_srli_epi16(input, 8), _mm_set1_epi16(0x003F)));
+
+        return count * 2;
+    }
+
+#if defined(EASL_KERNEL_USE_SSSE3)
+    // Leading 3 byte sequences. We look at the first 12 bytes as 4 sequences and move each one into a
+    // 32-bit lane with the lead byte at the top. Overlong sequences and encoded surrogates are rejected.
+    __m128i lanes = _mm_shuffle_epi8(input, _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1));
+    __m128i ch    = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(lanes, 4), _mm_set1_epi32(0xF000)),
+                                              _mm_and_si128(_mm_srli_epi32(lanes, 2), _mm_set1_epi32(0x0FC0))),
+                                 _mm_and_si128(lanes, _mm_set1_epi32(0x003F)));
+
+    __m128i three = _mm_cmpeq_epi32(_mm_and_si128(lanes, _mm_set1_epi32(0x00F0C0C0)), _mm_set1_epi32(0x00E08080));
+    three = _mm_and_si128(three, _mm_cmpgt_epi32(ch, _mm_set1_epi32(0x07FF)));
+    three = _mm_andnot_si128(_mm_and_si128(_mm_cmpgt_epi32(ch, _mm_set1_epi32(0xD7FF)), _mm_cmplt_epi32(ch, _mm_set1_epi32(0xE000))), three);
+
+    stop = ~_mm_movemask_epi8(three) & 0xFFFF;
+    if ((stop & 1) == 0)
+    {
+        count = (stop == 0) ? 4 : _bitscan_forward(stop) / 4;
+        chars = ch;
+
+        return count * 3;
+    }
+#endif
+
+    return 0;
+}
+
+/**
+*   \brief                  Encodes the run of similar characters at the start of 8 16-bit lanes as UTF-8.
+*   \param  input     [in]  The characters to encode.
+*   \param  stop      [in]  Lanes that can not be encoded by this function have all of their bits set.
+*   \param  dest      [out] The buffer that will receive the UTF-8 string. There must be room for 32 bytes.
+*   \param  written   [out] Receives the number of bytes that were written to \c dest.
+*   \return                 The number of characters that were encoded; or 0 if the first character needs the scalar path.
+*
+*   \remarks
+*       Surrogates and the null terminator are never encoded by this function.
+*/
+EASL_KERNEL_TARGET inline size_t _utf8_encode_block(__m128i input, __m128i stop, unsigned char *dest, size_t &written)
+{
+    const __m128i zero = _mm_setzero_si128();
+
+    // The null terminator is never encoded.
+    stop = _mm_or_si128(stop, _mm_cmpeq_epi16(input, zero));
+
+    __m128i high = _mm_and_si128(input, _mm_set1_epi16((short)0xF800));
+    __m128i not_ascii = _mm_andnot_si128(_mm_cmpeq_epi16(_mm_and_si128(input, _mm_set1_epi16((short)0xFF80)), zero), _mm_set1_epi16(-1));
+
+    // ASCII.
+    unsigned int mask = _mm_movemask_epi8(_mm_or_si128(stop, not_ascii));
+    if ((mask & 1) == 0)
+    {
+        size_t count = (mask == 0) ? 8 : _bitscan_forward(mask) / 2;
+        _mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(input, input));
+
+        written = count;
+        return count;
+    }
+
+    // Characters between 0x80 and 0x7FF become 2 byte sequences.
+    __m128i two = _mm_and_si128(not_ascii, _mm_cmpeq_epi16(high, zero));
+    mask = _mm_movemask_epi8(_mm_andnot_si128(stop, two)) ^ 0xFFFF;
+    if ((mask & 1) == 0)
+    {
+        size_t count = (mask == 0) ? 8 : _bitscan_forward(mask) / 2;
+
+        __m128i lead = _mm_or_si128(_mm_srli_epi16(input, 6), _mm_set1_epi16(0x00C0));
+        __m128i cont = _mm_or_si128(_mm_and_si128(input, _mm_set1_epi16(0x003F)), _mm_set1_epi16(0x0080));
+        _mm_storeu_si128((__m128i *)dest, _mm_or_si128(lead, _mm_slli_epi16(cont, 8)));
+
+        written = count * 2;
+        return count;
+    }
+
+#if defined(EASL_KERNEL_USE_SSSE3)
+    // Characters above 0x7FF become 3 byte sequences. Surrogates are left for the scalar path.
+    __m128i three = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi16(high, zero), _mm_cmpeq_epi16(high, _mm_set1_epi16((short)0xD800))), _mm_set1_epi16(-1));
+    mask = _mm_movemask_epi8(_mm_andnot_si128(stop, three)) ^ 0xFFFF;
+    if ((mask & 1) == 0)
+    {
+        size_t count = (mask == 0) ? 8 : _bitscan_forward(mask) / 2;
+
+        __m128i byte0 = _mm_or_si128(_mm_srli_epi16(input, 12), _mm_set1_epi16(0x00E0));
+        __m128i byte1 = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(input, 6), _mm_set1_epi16(0x003F)), _mm_set1_epi16(0x0080));
+        __m128i byte2 = _mm_or_si128(_mm_and_si128(input, _mm_set1_epi16(0x003F)), _mm_set1_epi16(0x0080));
+        __m128i pairs = _mm_or_si128(byte0, _mm_slli_epi16(byte1, 8));
+
+        // Each 32-bit lane now gets the 3 bytes of a single character, which are then packed together.
+        const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+        _mm_storeu_si128((__m128i *)dest,        _mm_shuffle_epi8(_mm_unpacklo_epi16(pairs, byte2), pack));
+        _mm_storeu_si128((__m128i *)(dest + 12), _mm_shuffle_epi8(_mm_unpackhi_epi16(pairs, byte2), pack));
+
+        written = count * 3;
+        return count;
+    }
+#endif
+
+    return 0;
+}
+#endif
+
+
+/**
+*   \brief  UTF-8 to UTF-16 transcoder. T must be a 16-bit type.
+*/
+template <typename T>
+EASL_KERNEL_TARGET inline size_t _transcode_utf8_to_utf16(T *dest, size_t destSize, const char *&source, const char *sourceEnd)
+{
+    const unsigned char *src = reinterpret_cast<const unsigned char *>(source);
+    const unsigned char *end = reinterpret_cast<const unsigned char *>(sourceEnd);
+
+    size_t count = 0;
+    for (;;)
+    {
+#if defined(EASL_SIMD_SSE2)
+        {
+            uchar16_t *out = reinterpret_cast<uchar16_t *>(dest);
+
+            // The stores write whole registers, which can be more units than the characters they
+            // hold, so they need room for 32 units. If the size of the destination is unknown (-1)
+            // everything goes through the scalar path. When we're only counting, it doesn't matter.
+            while (end - src >= 16 && (out == NULL || (destSize != (size_t)-1 && destSize - count >= 32)))
+            {
+#if defined(EASL_KERNEL_USE_AVX2)
+                if (end - src >= 32)
+                {
+                    __m256i input = _mm256_loadu_si256((const __m256i *)src);
+                    if ((_mm256_movemask_epi8(input) | _mm256_movemask_epi8(_mm256_cmpeq_epi8(input, _mm256_setzero_si256()))) == 0)
+                    {
+                        if (out != NULL)
+                        {
+                            _mm256_storeu_si256((__m256i *)(out + count),      _mm256_cvtepu8_epi16(_mm256_castsi256_si128(input)));
+                            _mm256_storeu_si256((__m256i *)(out + count + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(input, 1)));
+                        }
+
+                        src   += 32;
+                        count += 32;
+                        continue;
+                    }
+                }
+#endif
+                __m128i chars;
+                size_t  chars_count;
+                size_t  bytes = _utf8_decode_block(_mm_loadu_si128((const __m128i *)src), chars, chars_count);
+                if (bytes == 0)
+                {
+                    break;
+                }
+
+                if (out != NULL)
+                {
+                    if (bytes == chars_count)
+                    {
+                        _mm_storeu_si128((__m128i *)(out + count),     _mm_unpacklo_epi8(chars, _mm_setzero_si128()));
+                        _mm_storeu_si128((__m128i *)(out + count + 8), _mm_unpackhi_epi8(chars, _mm_setzero_si128()));
+                    }
+                    else if (bytes == chars_count * 2)
+                    {
+                        _mm_storeu_si128((__m128i *)(out + count), chars);
+                    }
+#if defined(EASL_KERNEL_USE_SSSE3)
+                    else
+                    {
+                        _mm_storel_epi64((__m128i *)(out + count), _mm_shuffle_epi8(chars, _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1)));
+                    }
+#endif
+                }
+
+                src   += bytes;
+                count += chars_count;
+            }
+        }
+#endif
+
+        // One character at a time until we can go back to the vector loop.
+        if (src >= end || *src == '\0')
+        {
+            break;
+        }
+
+        uchar32_t ch = *src;
+        size_t width = 1;
+        if (ch >= 0x80)
+        {
+            width = _decode_utf8_char(src, end, ch);
+            if (width == 0)
+            {
+                break;
+            }
+        }
+
+        size_t units = (ch > UNI_MAX_BMP) ? 2 : 1;
+        if (dest != NULL)
+        {
+            if (destSize - count < units)
+            {
+                break;
+            }
+
+            if (units == 1)
+            {
+                dest[count] = static_cast<T>(ch);
+            }
+            else
+            {
+                ch -= UNI_HALF_BASE;
+                dest[count]     = static_cast<T>((ch >> UNI_HALF_SHIFT) + UNI_SUR_HIGH_START);
+                dest[count + 1] = static_cast<T>((ch & UNI_HALF_MASK) + UNI_SUR_LOW_START);
+            }
+        }
+
+        src   += width;
+        count += units;
+    }
+
+    source = reinterpret_cast<const char *>(src);
+    return count;
+}
+
+/**
+*   \brief  UTF-8 to UTF-32 transcoder. T must be at least 32 bits. The vector paths are only used when T is exactly 32 bits.
+*/
+template <typename T>
+EASL_KERNEL_TARGET inline size_t _transcode_utf8_to_utf32(T *dest, size_t destSize, const char *&source, const char *sourceEnd)
+{
+    const unsigned char *src = reinterpret_cast<const unsigned char *>(source);
+    const unsigned char *end = reinterpret_cast<const unsigned char *>(sourceEnd);
+
+    size_t count = 0;
+    for (;;)
+    {
+#if defined(EASL_SIMD_SSE2)
+        if (dest == NULL || sizeof(T) == 4)
+        {
+            const __m128i zero = _mm_setzero_si128();
+
+            // Same as the UTF-16 version, except that the widest store is 16 units.
+            while (end - src >= 16 && (dest == NULL || (destSize != (size_t)-1 && destSize - count >= 16)))
+            {
+                __m128i chars;
+                size_t  chars_count;
+                size_t  bytes = _utf8_decode_block(_mm_loadu_si128((const __m128i *)src), chars, chars_count);
+                if (bytes == 0)
+                {
+                    break;
+                }
+
+                if (dest != NULL)
+                {
+                    __m128i *out = reinterpret_cast<__m128i *>(dest + count);
+
+                    if (bytes == chars_count)
+                    {
+                        __m128i lo = _mm_unpacklo_epi8(chars, zero);
+                        __m128i hi = _mm_unpackhi_epi8(chars, zero);
+                        _mm_storeu_si128(out,     _mm_unpacklo_epi16(lo, zero));
+                        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, zero));
+                        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, zero));
+                        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, zero));
+                    }
+                    else if (bytes == chars_count * 2)
+                    {
+                        _mm_storeu_si128(out,     _mm_unpacklo_epi16(chars, zero));
+                        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(chars, zero));
+                    }
+                    else
+                    {
+                        _mm_storeu_si128(out, chars);
+                    }
+                }
+
+                src   += bytes;
+                count += chars_count;
+            }
+        }
+#endif
+
+        if (src >= end || *src == '\0')
+        {
+            break;
+        }
+
+        uchar32_t ch = *src;
+        size_t width = 1;
+        if (ch >= 0x80)
+        {
+            width = _decode_utf8_char(src, end, ch);
+            if (width == 0)
+            {
+                break;
+            }
+        }
+
+        if (dest != NULL)
+        {
+            if (destSize == count)
+            {
+                break;
+            }
+
+            dest[count] = static_cast<T>(ch);
+        }
+
+        src   += width;
+        count += 1;
+    }
+
+    source = reinterpret_cast<const char *>(src);
+    return count;
+}
+
+/**
+*   \brief  UTF-16 to UTF-8 transcoder. T must be a 16-bit type.
+*/
+template <typename T>
+EASL_KERNEL_TARGET inline size_t _transcode_utf16_to_utf8(char *dest, size_t destSize, const T *&source, const T *sourceEnd)
+{
+    const uchar16_t *src = reinterpret_cast<const uchar16_t *>(source);
+    const uchar16_t *end = reinterpret_cast<const uchar16_t *>(sourceEnd);
+    unsigned char   *out = reinterpret_cast<unsigned char *>(dest);
+
+    size_t count = 0;
+    for (;;)
+    {
+#if defined(EASL_SIMD_SSE2)
+        {
+            // When we're only counting, the vector code writes to a scratch buffer instead.
+            unsigned char scratch[32];
+
+            // _utf8_encode_block() can store up to 28 bytes, so we need room for 32.
+            while (end - src >= 8 && (out == NULL || (destSize != (size_t)-1 && destSize - count >= 32)))
+            {
+#if defined(EASL_KERNEL_USE_AVX2)
+                if (end - src >= 16)
+                {
+                    __m256i input = _mm256_loadu_si256((const __m256i *)src);
+                    __m256i ascii = _mm256_cmpeq_epi16(_mm256_and_si256(input, _mm256_set1_epi16((short)0xFF80)), _mm256_setzero_si256());
+                    ascii = _mm256_andnot_si256(_mm256_cmpeq_epi16(input, _mm256_setzero_si256()), ascii);
+
+                    if ((unsigned int)_mm256_movemask_epi8(ascii) == 0xFFFFFFFF)
+                    {
+                        if (out != NULL)
+                        {
+                            __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(input), _mm256_extracti128_si256(input, 1));
+                            _mm_storeu_si128((__m128i *)(out + count), packed);
+                        }
+
+                        src   += 16;
+                        count += 16;
+                        continue;
+                    }
+                }
+#endif
+                size_t written;
+                size_t chars = _utf8_encode_block(_mm_loadu_si128((const __m128i *)src), _mm_setzero_si128(), (out != NULL) ? out + count : scratch, written);
+                if (chars == 0)
+                {
+                    break;
+                }
+
+                src   += chars;
+                count += written;
+            }
+        }
+#endif
+
+        if (src >= end || *src == 0)
+        {
+            break;
+        }
+
+        uchar32_t ch = *src;
+        size_t units = 1;
+        if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_HIGH_END)
+        {
+            // The high surrogate must be followed by a low surrogate. If it isn't, we have an
+            // error and need to stop.
+            if (end - src < 2 || src[1] < UNI_SUR_LOW_START || src[1] > UNI_SUR_LOW_END)
+            {
+                break;
+            }
+
+            ch = ((ch - UNI_SUR_HIGH_START) << UNI_HALF_SHIFT) + (src[1] - UNI_SUR_LOW_START) + UNI_HALF_BASE;
+            units = 2;
+        }
+        else if (ch >= UNI_SUR_LOW_START && ch <= UNI_SUR_LOW_END)
+        {
+            // An unpaired low surrogate can't be represented in UTF-8.
+            ch = UNI_REPLACEMENT_CHAR;
+        }
+
+        size_t width = _encode_utf8_char(NULL, ch);
+        if (out != NULL)
+        {
+            if (destSize - count < width)
+            {
+                break;
+            }
+
+            _encode_utf8_char(out + count, ch);
+        }
+
+        src   += units;
+        count += width;
+    }
+
+    source = reinterpret_cast<const T *>(src);
+    return count;
+}
+
+/**
+*   \brief  UTF-32 to UTF-8 transcoder. T must be at least 32 bits. The vector paths are only used when T is exactly 32 bits.
+*/
+template <typename T>
+EASL_KERNEL_TARGET inline size_t _transcode_utf32_to_utf8(char *dest, size_t destSize, const T *&source, const T *sourceEnd)
+{
+    const T       *src = source;
+    unsigned char *out = reinterpret_cast<unsigned char *>(dest);
+
+    size_t count = 0;
+    for (;;)
+    {
+#if defined(EASL_SIMD_SSE2)
+        if (sizeof(T) == 4)
+        {
+            unsigned char scratch[32];
+
+            while (sourceEnd - src >= 8 && (out == NULL || (destSize != (size_t)-1 && destSize - count >= 32)))
+            {
+                __m128i a = _mm_loadu_si128((const __m128i *)src);
+                __m128i b = _mm_loadu_si128((const __m128i *)(src + 4));
+
+                // Characters above the BMP are left for the scalar path. The bias lets us use
+                // the signed saturating pack to get down to 16 bits.
+                const __m128i bias = _mm_set1_epi32(0x8000);
+                __m128i bmp = _mm_packs_epi32(_mm_cmpeq_epi32(_mm_srli_epi32(a, 16), _mm_setzero_si128()),
+                                              _mm_cmpeq_epi32(_mm_srli_epi32(b, 16), _mm_setzero_si128()));
+                __m128i input = _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias)), _mm_set1_epi16((short)0x8000));
+
+                size_t written;
+                size_t chars = _utf8_encode_block(input, _mm_andnot_si128(bmp, _mm_set1_epi16(-1)), (out != NULL) ? out + count : scratch, written);
+                if (chars == 0)
+                {
+                    break;
+                }
+
+                src   += chars;
+                count += written;
+            }
+        }
+#endif
+
+        if (src >= sourceEnd || *src == 0)
+        {
+            break;
+        }
+
+        // Surrogates and characters above U+10FFFF are replaced.
+        uchar32_t ch = validate_utf32_char(static_cast<uchar32_t>(*src));
+
+        size_t width = _encode_utf8_char(NULL, ch);
+        if (out != NULL)
+        {
+            if (destSize - count < width)
+            {
+                break;
+            }
+
+            _encode_utf8_char(out + count, ch);
+        }
+
+        src   += 1;
+        count += width;
+    }
+
+    source = src;
+    return count;
+}
+
+
+}
+}
@@ -0,0 +1,401 @@
+/**
+*   \file   allocator.h
+*   \author Dave Reid
+*   \brief  Header file for the memory allocators.
+*
+*   An allocator is any class with the following two methods:
+*
+*       void * allocate(size_t size);
+*       void deallocate(void *ptr);
+*
+*   The string classes take an allocator as a template parameter, and the functions that
+*   need temporary buffers (parse() and vformat(), for example) use temp_allocator.
+*
+*   heap_allocator uses the global heap. It has no state, so it doesn't take up any room
+*   in the string classes.
+*
+*   arena_allocator allocates from an arena. Memory is never freed individually. Instead,
+*   everything is freed at once when the arena is reset or destroyed. This is useful for
+*   strings that all have the same lifetime, such as those created while processing a
+*   single request.
+*
+*   scratch_allocator allocates from a small stack that is local to the current thread. The
+*   memory is cheapest to free in the reverse order that it was allocated, but blocks can be
+*   freed in any order on the thread that allocated them. Allocations that don't fit on the
+*   stack go to the heap. This is what temp_allocator is by default. Define
+*   EASL_OPTION_TEMP_ALLOCATOR to the name of another allocator to change it.
+*/
+#ifndef __EASL_ALLOCATOR_H_
+#define __EASL_ALLOCATOR_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <new>
+#include "setup.h"
+
+// The size in bytes of the stack used by scratch_allocator for each thread.
+#ifndef EASL_OPTION_SCRATCH_SIZE
+#define EASL_OPTION_SCRATCH_SIZE    4096
+#endif
+
+namespace easl
+{
+
+/**
+*   \brief              Rounds an allocation size up so that the next allocation is properly aligned.
+*   \param  size  [in]  The size to round up.
+*   \return             The rounded size.
+*/
+inline size_t _align_allocation(size_t size)
+{
+    const size_t alignment = 2 * sizeof(void *);
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+
+/**
+*   \brief  Allocator that uses the global heap.
+*/
+class heap_allocator
+{
+public:
+
+    /**
+    *   \brief            Allocates a block of memory.
+    *   \param  size [in] The size of the block in bytes.
+    *   \return           A pointer to the new block.
+    */
+    void * allocate(size_t size)
+    {
+        return ::operator new(size);
+    }
+
+    /**
+    *   \brief           Frees a block of memory that was allocated with allocate().
+    *   \param  ptr [in] The block to free. Can be NULL.
+    */
+    void deallocate(void *ptr)
+    {
+        ::operator delete(ptr);
+    }
+};
+
+
+/**
+*   \brief  A bump pointer arena.
+*
+*   Memory is allocated from chunks by moving a pointer forward. Individual allocations can
+*   not be freed. Instead, reset() frees everything at once, keeping the most recent chunk
+*   around for the next round of allocations.
+*
+*   Arenas can not be copied. Use arena_allocator to refer to an arena from a string.
+*/
+class arena
+{
+public:
+
+    /**
+    *   \brief                 Constructor.
+    *   \param  chunkSize [in] The size in bytes of the chunks that are allocated from the heap.
+    */
+    explicit arena(size_t chunkSize = 4096)
+        : head(NULL), pos(NULL), end(NULL), chunk_size(chunkSize)
+    {
+    }
+
+    /**
+    *   \brief  Destructor.
+    */
+    ~arena()
+    {
+        this->_free_chunks(this->head);
+    }
+
+
+    /**
+    *   \brief            Allocates a block of memory.
+    *   \param  size [in] The size of the block in bytes.
+    *   \return           A pointer to the new block.
+    */
+    void * allocate(size_t size)
+    {
+        size = _align_allocation(size);
+
+        if (static_cast<size_t>(this->end - this->pos) < size)
+        {
+            this->_add_chunk(size);
+        }
+
+        void *ptr = this->pos;
+        this->pos += size;
+
+        return ptr;
+    }
+
+    /**
+    *   \brief  Frees everything that has been allocated from the arena.
+    *
+    *   \remarks
+    *       The most recent chunk is kept so that it can be reused.
+    */
+    void reset()
+    {
+        if (this->head != NULL)
+        {
+            this->_free_chunks(this->head->next);
+            this->head->next = NULL;
+
+            this->pos = reinterpret_cast<unsigned char *>(this->head) + _align_allocation(sizeof(chunk));
+        }
+    }
+
+
+private:
+
+    /// The header at the start of each chunk.
+    struct chunk
+    {
+        /// The previous chunk.
+        chunk *next;
+
+        /// The size of the chunk in bytes, including the header.
+        size_t size;
+    };
+
+    /**
+    *   \brief                    Allocates a new chunk and makes it the current one.
+    *   \param  minSize      [in] The size of the allocation that needs to fit in the chunk.
+    */
+    void _add_chunk(size_t minSize)
+    {
+        size_t header_size = _align_allocation(sizeof(chunk));
+        size_t size        = header_size + minSize;
+        if (size < this->chunk_size)
+        {
+            size = this->chunk_size;
+        }
+
+        chunk *new_chunk = static_cast<chunk *>(::operator new(size));
+        new_chunk->next = this->head;
+        new_chunk->size = size;
+
+        this->head = new_chunk;
+        this->pos  = reinterpret_cast<unsigned char *>(new_chunk) + header_size;
+        this->end  = reinterpret_cast<unsigned char *>(new_chunk) + size;
+    }
+
+    /**
+    *   \brief              Frees a list of chunks.
+    *   \param  first [in]  The first chunk in the list.
+    */
+    static void _free_chunks(chunk *first)
+    {
+        while (first != NULL)
+        {
+            chunk *next = first->next;
+            ::operator delete(first);
+
+            first = next;
+        }
+    }
+
+
+    /// The most recently allocated chunk.
+    chunk *head;
+
+    /// The next free byte in the current chunk.
+    unsigned char *pos;
+
+    /// The end of the current chunk.
+    unsigned char *end;
+
+    /// The minimum size of each chunk.
+    size_t chunk_size;
+
+
+    // Arenas can not be copied.
+    arena(const arena &);
+    arena & operator =(const arena &);
+};
+
+
+/**
+*   \brief  Allocator that allocates from an arena.
+*
+*   \remarks
+*       The arena must outlive everything that uses the allocator. A default constructed
+*       arena_allocator can not allocate anything, so strings using it need to be given an
+*       allocator when they are constructed.
+*/
+class arena_allocator
+{
+public:
+
+    /**
+    *   \brief  Default constructor.
+    */
+    arena_allocator() : source(NULL)
+    {
+    }
+
+    /**
+    *   \brief              Constructor.
+    *   \param  source [in] The arena to allocate from.
+    */
+    arena_allocator(arena &source) : source(&source)
+    {
+    }
+
+
+    /// \copydoc heap_allocator::allocate()
+    void * allocate(size_t size)
+    {
+        assert(this->source != NULL);
+
+        return this->source->allocate(size);
+    }
+
+    /**
+    *   \brief           Does nothing. The memory is freed when the arena is reset or destroyed.
+    *   \param  ptr [in] The block to free.
+    */
+    void deallocate(void *)
+    {
+    }
+
+
+private:
+
+    /// The arena to allocate from.
+    arena *source;
+};
+
+
+/**
+*   \brief  The header in front of each block on the scratch stack.
+*/
+struct _scratch_header
+{
+    /// The offset of the header of the block below this one.
+    size_t previous;
+
+    /// Whether or not the block has been freed while other blocks were above it.
+    size_t freed;
+};
+
+/**
+*   \brief  The per-thread stack used by scratch_allocator.
+*/
+struct _scratch_stack
+{
+    /// The memory for the stack. The union makes sure it is properly aligned.
+    union
+    {
+        unsigned char bytes[EASL_OPTION_SCRATCH_SIZE];
+        void *        alignment[2];
+    } buffer;
+
+    /// The offset of the top of the stack.
+    size_t top;
+
+    /// The offset of the header of the block at the top of the stack. Only valid when \c top is not 0.
+    size_t last;
+};
+
+#ifdef EASL_THREAD_LOCAL
+/**
+*   \brief  Retrieves the scratch stack for the current thread.
+*/
+inline _scratch_stack & _get_scratch_stack()
+{
+    static EASL_THREAD_LOCAL _scratch_stack stack;
+    return stack;
+}
+#endif
+
+/**
+*   \brief  Allocator that allocates from a stack that is local to the current thread.
+*
+*   \remarks
+*       Each block has a small header that links it to the block below it. Freeing the block at
+*       the top of the stack pops it straight away. A block that is freed while other blocks are
+*       above it is only marked as free, and it is popped along with them once they have been
+*       freed as well. This way, a string that allocates its new buffer before freeing its old
+*       one never has its new buffer handed out again.
+*       \par
+*       Memory must be freed on the thread that allocated it. If the stack is full, or the compiler
+*       doesn't support thread local storage, the heap is used instead.
+*/
+class scratch_allocator
+{
+public:
+
+    /// \copydoc heap_allocator::allocate()
+    void * allocate(size_t size)
+    {
+#ifdef EASL_THREAD_LOCAL
+        _scratch_stack &stack = _get_scratch_stack();
+
+        const size_t header_size = _align_allocation(sizeof(_scratch_header));
+
+        size = _align_allocation(size);
+        if (EASL_OPTION_SCRATCH_SIZE - stack.top >= header_size && EASL_OPTION_SCRATCH_SIZE - stack.top - header_size >= size)
+        {
+            _scratch_header *header = reinterpret_cast<_scratch_header *>(stack.buffer.bytes + stack.top);
+            header->previous = stack.last;
+            header->freed    = 0;
+
+            stack.last = stack.top;
+            stack.top += header_size + size;
+
+            return reinterpret_cast<unsigned char *>(header) + header_size;
+        }
+#endif
+
+        return ::operator new(size);
+    }
+
+    /// \copydoc heap_allocator::deallocate()
+    void deallocate(void *ptr)
+    {
+#ifdef EASL_THREAD_LOCAL
+        _scratch_stack &stack = _get_scratch_stack();
+
+        unsigned char *bytes = static_cast<unsigned char *>(ptr);
+        if (bytes >= stack.buffer.bytes && bytes < stack.buffer.bytes + EASL_OPTION_SCRATCH_SIZE)
+        {
+            reinterpret_cast<_scratch_header *>(bytes - _align_allocation(sizeof(_scratch_header)))->freed = 1;
+
+            // Pop every freed block from the top of the stack.
+            while (stack.top > 0)
+            {
+                _scratch_header *header = reinterpret_cast<_scratch_header *>(stack.buffer.bytes + stack.last);
+                if (!header->freed)
+                {
+                    break;
+                }
+
+                stack.top  = stack.last;
+                stack.last = header->previous;
+            }
+
+            return;
+        }
+#endif
+
+        ::operator delete(ptr);
+    }
+};
+
+
+// The allocator used for temporary buffers inside the library.
+#ifdef EASL_OPTION_TEMP_ALLOCATOR
+typedef EASL_OPTION_TEMP_ALLOCATOR temp_allocator;
+#else
+typedef scratch_allocator temp_allocator;
+#endif
+
+
+}
+
+#endif // __EASL_ALLOCATOR_H_
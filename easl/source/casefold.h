@@ -0,0 +1,194 @@
+/**
+*   \file   casefold.h
+*   \author Dave Reid
+*   \brief  Header file for casefold() and the helpers for case insensitive comparisons.
+*/
+#ifndef __EASL_CASEFOLD_H_
+#define __EASL_CASEFOLD_H_
+
+#include "types.h"
+#include "_simd.h"
+#include "_private.h"
+#include "_casefold_tables.h"
+#include "nextchar.h"
+#include "literal.h"
+#include "searcher.h"
+#include "containsonlyascii.h"
+
+namespace easl
+{
+
+/**
+*   \brief            Retrieves the simple case folding of a character.
+*   \param  ch  [in]  The character to fold.
+*   \return           The folded character; or \c ch if it has no case folding.
+*
+*   \remarks
+*       Two strings are equal without regard to case if their characters fold to the same characters.
+*       This is the simple case folding from the Unicode character database, which always folds one
+*       character to one character. For example, 'A' and 'a' both fold to 'a', and U+212A KELVIN SIGN
+*       folds to 'k', but U+00DF LATIN SMALL LETTER SHARP S does not fold to "ss".
+*       \par
+*       ASCII is handled without looking at the tables. Other characters are looked up in two stages,
+*       first by their block of 64 characters and then by their position in the block.
+*/
+inline uchar32_t casefold(uchar32_t ch)
+{
+    if (ch < 0x80)
+    {
+        return (ch >= 'A' && ch <= 'Z') ? ch + ('a' - 'A') : ch;
+    }
+
+    if ((ch >> 6) >= sizeof(g_caseFoldBlocks))
+    {
+        return ch;
+    }
+
+    uchar32_t delta = g_caseFoldDeltas[(static_cast<size_t>(g_caseFoldBlocks[ch >> 6]) << 6) | (ch & 0x3F)];
+
+    return (ch & ~static_cast<uchar32_t>(0xFFFF)) | ((ch + delta) & 0xFFFF);
+}
+
+
+#if defined(EASL_SIMD_SSE2)
+/**
+*   \brief              Folds the ASCII letters in a register to lower case.
+*   \param  input [in]  The code units to fold.
+*   \param  width [in]  The size of a code unit in bytes. This must be 1, 2 or 4.
+*
+*   \remarks
+*       Code units outside of ASCII come out in an unspecified state, so the caller must check for
+*       them separately.
+*/
+inline __m128i _casefold_ascii(__m128i input, size_t width)
+{
+    __m128i upper = _mm_and_si128(
+        _searcher_cmpgt(input, _searcher_broadcast('A' - 1, width), width),
+        _searcher_cmpgt(_searcher_broadcast('Z' + 1, width), input, width));
+
+    return _mm_or_si128(input, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+}
+#endif
+
+/**
+*   \brief               Retrieves the number of leading T's of two strings that can be skipped by a case insensitive comparison.
+*   \param  str1   [in]  The first string.
+*   \param  str2   [in]  The second string.
+*   \param  count  [in]  The number of T's that can be read from both strings.
+*   \return              The number of T's that can be skipped. Both strings are at the start of a character after them.
+*
+*   \remarks
+*       Whole 16 byte blocks are checked with SSE2. A block is skipped if it is the same in both strings,
+*       or if it is ASCII in both strings and the two are equal once the letters are folded. The checking
+*       stops at the first block that is neither, so the caller has to compare from there on one
+*       character at a time.
+*       \par
+*       A block that is the same in both strings can end in the middle of a character, in which case the
+*       part of the character that was skipped is given back. Since everything up to there is the same in
+*       both strings, the character starts at the same place in both.
+*       \par
+*       Nothing is skipped when the two strings use different encodings.
+*/
+template <typename T, typename U>
+inline size_t _casefold_skip_blocks(const T *str1, const U *str2, size_t count)
+{
+    size_t skipped = 0;
+
+#if defined(EASL_SIMD_SSE2)
+    if (sizeof(T) == sizeof(U) && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4))
+    {
+        const size_t  width  = sizeof(T);
+        const char   *bytes1 = reinterpret_cast<const char *>(str1);
+        const char   *bytes2 = reinterpret_cast<const char *>(str2);
+        const size_t  bytes  = count * width;
+        const __m128i mask   = _ascii_mask(width);
+        const __m128i zero   = _mm_setzero_si128();
+
+        size_t i = 0;
+        for ( ; i + 16 <= bytes; i += 16)
+        {
+            __m128i input1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes1 + i));
+            __m128i input2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes2 + i));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(input1, input2)) == 0xFFFF)
+            {
+                continue;
+            }
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(_mm_or_si128(input1, input2), mask), zero)) != 0xFFFF)
+            {
+                break;
+            }
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(_casefold_ascii(input1, width), _casefold_ascii(input2, width))) != 0xFFFF)
+            {
+                break;
+            }
+        }
+
+        skipped = i / width;
+
+        if (skipped < count)
+        {
+            if (width == 1)
+            {
+                for (size_t n = 0; n < 3 && skipped > 0 && (_literal_unit(str1[skipped]) & 0xC0) == 0x80; ++n)
+                {
+                    --skipped;
+                }
+            }
+            else if (width == 2)
+            {
+                uchar32_t unit = static_cast<uchar16_t>(str1[skipped]);
+                if (skipped > 0 && unit >= UNI_SUR_LOW_START && unit <= UNI_SUR_LOW_END)
+                {
+                    --skipped;
+                }
+            }
+        }
+    }
+#else
+    (void)str1;
+    (void)str2;
+    (void)count;
+#endif
+
+    return skipped;
+}
+
+/**
+*   \brief                   Retrieves the next character in a string and folds it.
+*   \param  str    [in, out] Pointer to the character to retrieve. This is moved past the character.
+*   \param  strEnd [in]      Pointer to the end of the string.
+*   \return                  The folded character.
+*
+*   \remarks
+*       A code unit that doesn't start a valid character is skipped on its own. It is returned as a value
+*       above the last Unicode character, so it only ever compares equal to the same invalid code unit
+*       and it sorts after every valid character.
+*/
+template <typename T>
+inline uchar32_t _casefold_next(const T *&str, const T *strEnd)
+{
+    uchar32_t unit = _literal_unit(*str);
+    if (unit < 0x80)
+    {
+        ++str;
+        return casefold(unit);
+    }
+
+    const T *start = str;
+    uchar32_t ch = nextchar(str, strEnd);
+    if (str == start)
+    {
+        ++str;
+        return UNI_MAX_LEGAL_UTF32 + 1 + unit;
+    }
+
+    return casefold(ch);
+}
+
+
+}
+
+#endif // __EASL_CASEFOLD_H_
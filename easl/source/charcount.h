@@ -6,12 +6,187 @@
 #ifndef __EASL_CHARCOUNT_H_
 #define __EASL_CHARCOUNT_H_
 
+#include "_simd.h"
 #include "nextchar.h"
 #include "length.h"
 
 namespace easl
 {
 
+#if defined(EASL_KERNEL_AVX512BW)
+/**
+*   \brief                 AVX-512BW kernel for _charcount_utf8(). Counts whole 64 byte blocks.
+*   \param  str   [in, out] The string to count the characters of. This is moved past the counted blocks.
+*   \param  end   [in]      Pointer to the end of the string.
+*   \return                 The number of bytes that are not continuation bytes.
+*/
+EASL_TARGET("avx512bw") inline size_t _charcount_utf8_avx512bw(const char *&str, const char *end)
+{
+    const __m512i threshold = _mm512_set1_epi8(-65);
+
+    size_t count = 0;
+    while (end - str >= 64)
+    {
+        count += _popcount64(_mm512_cmpgt_epi8_mask(_mm512_loadu_si512((const void *)str), threshold));
+        str   += 64;
+    }
+
+    return count;
+}
+#endif
+
+#if defined(EASL_KERNEL_AVX2)
+/**
+*   \brief                 AVX2 kernel for _charcount_utf8(). Counts whole 32 byte blocks.
+*   \param  str   [in, out] The string to count the characters of. This is moved past the counted blocks.
+*   \param  end   [in]      Pointer to the end of the string.
+*   \return                 The number of bytes that are not continuation bytes.
+*/
+EASL_TARGET("avx2") inline size_t _charcount_utf8_avx2(const char *&str, const char *end)
+{
+    const __m256i threshold = _mm256_set1_epi8(-65);
+
+    size_t count = 0;
+    while (end - str >= 32)
+    {
+        __m256i input = _mm256_loadu_si256((const __m256i *)str);
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(input, threshold)));
+
+        count += _popcount(mask);
+        str   += 32;
+    }
+
+    return count;
+}
+#endif
+
+/**
+*   \brief                 Counts the characters in a UTF-8 string.
+*   \param  str       [in] The string to count the characters of.
+*   \param  strLength [in] The length of the string in bytes. There can not be a null terminator before this.
+*   \return                The number of bytes that are not continuation bytes.
+*/
+inline size_t _charcount_utf8(const char *str, size_t strLength)
+{
+    const char *end = str + strLength;
+    size_t count = 0;
+
+    // Every byte that isn't a continuation byte (0x80 - 0xBF) starts a new character. As signed
+    // bytes, continuation bytes are everything below -64. Short strings aren't worth checking
+    // the CPU for. Whatever the wider kernels leave over is counted 16 bytes at a time.
+    if (strLength >= 64)
+    {
+#if defined(EASL_KERNEL_AVX512BW)
+        if (cpu_supports(EASL_CPU_AVX512BW))
+        {
+            count += _charcount_utf8_avx512bw(str, end);
+        }
+#endif
+#if defined(EASL_KERNEL_AVX2)
+        if (cpu_supports(EASL_CPU_AVX2))
+        {
+            count += _charcount_utf8_avx2(str, end);
+        }
+#endif
+    }
+#if defined(EASL_SIMD_SSE2)
+    const __m128i threshold = _mm_set1_epi8(-65);
+    while (end - str >= 16)
+    {
+        __m128i input = _mm_loadu_si128((const __m128i *)str);
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpgt_epi8(input, threshold)));
+
+        count += _popcount(mask);
+        str   += 16;
+    }
+#endif
+
+    while (str < end)
+    {
+        if ((*str & 0xC0) != 0x80)
+        {
+            ++count;
+        }
+
+        ++str;
+    }
+
+    return count;
+}
+
+/**
+*   \brief                 Counts the characters in a UTF-16 string.
+*   \param  str       [in] The string to count the characters of.
+*   \param  strLength [in]  The length of the string in T's. There can not be a null terminator before this.
+*   \param  units     [out] Receives the number of T's that were counted. Can be NULL.
+*   \return                 The number of characters, stopping at the first unpaired high surrogate.
+*
+*   \remarks
+*       This gives the same result as counting with nextchar(), which treats an unpaired low surrogate
+*       as a character and stops at an unpaired high surrogate. A surrogate pair that is split by the
+*       end of the string is not counted.
+*/
+template <typename T>
+inline size_t _charcount_utf16(const T *str, size_t strLength, size_t *units = NULL)
+{
+    const uchar16_t *src = reinterpret_cast<const uchar16_t *>(str);
+    const uchar16_t *end = src + strLength;
+    size_t count = 0;
+
+#if defined(EASL_SIMD_SSE2)
+    // A block of 8 units has 8 characters, minus one for each surrogate pair. We also look at the
+    // unit after the block to check that every high surrogate is followed by a low surrogate. If
+    // the block ends with a high surrogate, its low surrogate is skipped along with the block.
+    const __m128i surrogate_mask = _mm_set1_epi16((short)0xFC00);
+    const __m128i high_start     = _mm_set1_epi16((short)UNI_SUR_HIGH_START);
+    const __m128i low_start      = _mm_set1_epi16((short)UNI_SUR_LOW_START);
+
+    while (end - src > 8)
+    {
+        __m128i is_high  = _mm_cmpeq_epi16(_mm_and_si128(_mm_loadu_si128((const __m128i *)src),       surrogate_mask), high_start);
+        __m128i next_low = _mm_cmpeq_epi16(_mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 1)), surrogate_mask), low_start);
+
+        if (_mm_movemask_epi8(_mm_andnot_si128(next_low, is_high)) != 0)
+        {
+            // Unpaired high surrogate. The scalar loop will stop there.
+            break;
+        }
+
+        unsigned int mask  = static_cast<unsigned int>(_mm_movemask_epi8(is_high));
+        size_t       extra = (mask >> 15) & 1;
+
+        count += 8 + extra - _popcount(mask) / 2;
+        src   += 8 + extra;
+    }
+#endif
+
+    while (src < end)
+    {
+        uchar32_t ch = *src++;
+        if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_HIGH_END)
+        {
+            if (src == end || *src < UNI_SUR_LOW_START || *src > UNI_SUR_LOW_END)
+            {
+                // The high surrogate is not counted.
+                --src;
+                break;
+            }
+
+            ++src;
+        }
+
+        ++count;
+    }
+
+    if (units != NULL)
+    {
+        *units = src - reinterpret_cast<const uchar16_t *>(str);
+    }
+
+    return count;
+}
+
+
 /**
 *   \brief                 Retrieves the number of characters in the given string.
 *   \param  str       [in] The string to check.
@@ -24,6 +199,10 @@ namespace easl
 *       \par
 *       This function does not return the number of bytes in the string. Rather, it calculates
 *       the number of characters in the string, not including the null terminator.
+*       \par
+*       UTF-8 and UTF-16 strings are counted without decoding them. For UTF-8 strings, this is done
+*       by counting the bytes that are not continuation bytes, so the string is assumed to be well
+*       formed. Use validate_utf8() first if that is not known.
 */
 template <typename T>
 inline size_t charcount(const T *str, size_t strLength)
@@ -38,6 +217,48 @@ inline size_t charcount(const T *str, size_t strLength)
     return count;
 }
 
+// Optimized cases. The null terminator is found first, after which the characters are counted
+// without having to decode them.
+inline size_t charcount(const char *str, size_t strLength)
+{
+    strLength = (strLength == (size_t)-1) ? easl::length(str) : easl::length(str, strLength);
+
+#ifdef EASL_ONLY_ASCII
+    return strLength;
+#else
+    return _charcount_utf8(str, strLength);
+#endif
+}
+inline size_t charcount(const char16_t *str, size_t strLength)
+{
+    strLength = (strLength == (size_t)-1) ? easl::length(str) : easl::length(str, strLength);
+
+#ifdef EASL_ONLY_ASCII
+    return strLength;
+#else
+    return _charcount_utf16(str, strLength);
+#endif
+}
+inline size_t charcount(const char32_t *str, size_t strLength)
+{
+    return (strLength == (size_t)-1) ? easl::length(str) : easl::length(str, strLength);
+}
+inline size_t charcount(const wchar_t *str, size_t strLength)
+{
+    strLength = (strLength == (size_t)-1) ? easl::length(str) : easl::length(str, strLength);
+
+    if (sizeof(wchar_t) == 2)
+    {
+#ifdef EASL_ONLY_ASCII
+        return strLength;
+#else
+        return _charcount_utf16(str, strLength);
+#endif
+    }
+
+    return strLength;
+}
+
 // Optimized case. Uses easl::length() if we're only using ASCII.
 template <typename T>
 inline size_t charcount(const T *str)
@@ -49,10 +270,82 @@ inline size_t charcount(const T *str)
     return charcount(str, (size_t)-1);
 }
 
+/**
+*   \brief                 Counts the characters between two pointers.
+*   \param  str       [in] Pointer to the start of the string.
+*   \param  strEnd    [in] Pointer to the end of the string.
+*   \return                The number of characters between \c str and \c strEnd.
+*
+*   \remarks
+*       Null characters are counted like any other character and nothing past \c strEnd is read.
+*/
+template <typename T>
+inline size_t _charcount_span(const T *str, const T *strEnd)
+{
+    size_t count = 0;
+    while (str < strEnd)
+    {
+        const T *next = str;
+        nextchar(next, strEnd);
+
+        if (next == str)
+        {
+            break;
+        }
+
+        str = next;
+        ++count;
+    }
+
+    return count;
+}
+inline size_t _charcount_span(const char *str, const char *strEnd)
+{
+#ifdef EASL_ONLY_ASCII
+    return strEnd - str;
+#else
+    return _charcount_utf8(str, strEnd - str);
+#endif
+}
+inline size_t _charcount_span(const char16_t *str, const char16_t *strEnd)
+{
+#ifdef EASL_ONLY_ASCII
+    return strEnd - str;
+#else
+    return _charcount_utf16(str, strEnd - str);
+#endif
+}
+inline size_t _charcount_span(const char32_t *str, const char32_t *strEnd)
+{
+    return strEnd - str;
+}
+inline size_t _charcount_span(const wchar_t *str, const wchar_t *strEnd)
+{
+    if (sizeof(wchar_t) == 2)
+    {
+#ifdef EASL_ONLY_ASCII
+        return strEnd - str;
+#else
+        return _charcount_utf16(str, strEnd - str);
+#endif
+    }
+
+    return strEnd - str;
+}
+
+/**
+*   \brief           Retrieves the number of characters in a reference string.
+*   \param  str [in] The string to check.
+*   \return          The number of characters that make up the string.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Null characters inside the string
+*       are counted like any other character.
+*/
 template <typename T>
 inline size_t charcount(const reference_string<T> &str)
 {
-    return charcount(str.start, str.end - str.start);
+    return _charcount_span(str.start, str.end);
 }
 
 }
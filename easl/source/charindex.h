@@ -0,0 +1,317 @@
+/**
+*   \file   charindex.h
+*   \author Dave Reid
+*   \brief  Header file for the charindex class.
+*
+*   Finding the character at a given index in a variable width string means decoding every
+*   character before it. A charindex decodes the string once and records the offset of every
+*   Kth character. Finding a character after that only means decoding at most K - 1 characters
+*   from the closest recorded offset.
+*
+*   The index refers to the string it was built for. If that string is modified or freed, the
+*   index needs to be rebuilt.
+*/
+#ifndef __EASL_CHARINDEX_H_
+#define __EASL_CHARINDEX_H_
+
+#include <assert.h>
+#include <vector>
+#include "nextchar.h"
+#include "length.h"
+#include "reference_string.h"
+
+namespace easl
+{
+
+/**
+*   \brief  Class for finding characters by index in constant time.
+*
+*   The class stores the offset of every \c interval characters in the string, where
+*   \c interval is given when the index is built. Smaller intervals mean faster lookups
+*   but more memory. The default of 32 uses about one size_t for every 32 characters.
+*/
+template <typename T>
+class charindex
+{
+public:
+
+    /**
+    *   \brief  Default constructor. The index is empty until build() is called.
+    */
+    charindex() : str(NULL), len(0), chars(0), interval(32)
+    {
+    }
+
+    /**
+    *   \brief                 Constructor.
+    *   \param  str       [in] The string to build the index for.
+    *   \param  strLength [in] The length in T's of the string, not including the null terminator.
+    *   \param  interval  [in] The number of characters between each recorded offset.
+    */
+    charindex(const T *str, size_t strLength = -1, size_t interval = 32) : str(NULL), len(0), chars(0), interval(interval)
+    {
+        this->build(str, strLength, interval);
+    }
+
+    /**
+    *   \brief                 Constructor.
+    *   \param  str       [in] The string to build the index for.
+    *   \param  interval  [in] The number of characters between each recorded offset.
+    */
+    charindex(const reference_string<T> &str, size_t interval = 32) : str(NULL), len(0), chars(0), interval(interval)
+    {
+        this->build(str.start, easl::length(str), interval);
+    }
+
+
+    /**
+    *   \brief                 Builds the index for a string.
+    *   \param  str       [in] The string to build the index for.
+    *   \param  strLength [in] The length in T's of the string, not including the null terminator.
+    *   \param  interval  [in] The number of characters between each recorded offset.
+    *
+    *   \remarks
+    *       The string is indexed up to the null terminator, the end of the string or the first
+    *       invalid character, whichever comes first. A character that is split by the end of the
+    *       string is not included.
+    *       \par
+    *       To index a string object, pass its c_str() and length().
+    */
+    void build(const T *str, size_t strLength = -1, size_t interval = 32)
+    {
+        assert(str != NULL);
+        assert(interval > 0);
+
+        this->str      = str;
+        this->interval = interval;
+        this->marks.clear();
+
+        const T *temp       = str;
+        size_t   count      = 0;
+        bool     terminated = false;
+        while (static_cast<size_t>(temp - str) < strLength)
+        {
+            if (count % interval == 0)
+            {
+                this->marks.push_back(temp - str);
+            }
+
+            // When we have a length, the string might not be null terminated, so the decoder must
+            // not read past it. A character split by the end leaves the pointer where it was.
+            const T  *next = temp;
+            uchar32_t ch   = (strLength != (size_t)-1) ? easl::nextchar(next, str + strLength) : easl::nextchar(next);
+            if (ch == '\0' || next == temp)
+            {
+                terminated = true;
+                break;
+            }
+
+            temp = next;
+            ++count;
+        }
+
+        // When the loop stops on the null terminator or a split character, a mark may have been added
+        // for the end of the string. It isn't needed. When it stops at the end of the string, no such
+        // mark was added.
+        if (terminated && count > 0 && count % interval == 0)
+        {
+            this->marks.pop_back();
+        }
+        else if (this->marks.empty())
+        {
+            this->marks.push_back(0);
+        }
+
+        this->len   = temp - str;
+        this->chars = count;
+    }
+
+    /**
+    *   \brief  Empties the index.
+    */
+    void clear()
+    {
+        this->str   = NULL;
+        this->len   = 0;
+        this->chars = 0;
+        this->marks.clear();
+    }
+
+
+    /**
+    *   \brief  Retrieves the string the index was built for.
+    */
+    const T * c_str() const
+    {
+        return this->str;
+    }
+
+    /**
+    *   \brief  Retrieves the length in T's of the indexed part of the string.
+    */
+    size_t length() const
+    {
+        return this->len;
+    }
+
+    /**
+    *   \brief  Retrieves the number of characters in the indexed part of the string.
+    */
+    size_t charcount() const
+    {
+        return this->chars;
+    }
+
+
+    /**
+    *   \brief             Retrieves the offset of a character.
+    *   \param  index [in] The zero based index of the character.
+    *   \return            The offset in T's of the character; or -1 if the index is past the end of the string.
+    *
+    *   \remarks
+    *       An index equal to charcount() is allowed, and returns length().
+    */
+    size_t offset(size_t index) const
+    {
+        if (index > this->chars)
+        {
+            return (size_t)-1;
+        }
+
+        size_t block = index / this->interval;
+        if (block >= this->marks.size())
+        {
+            return this->len;
+        }
+
+        const T *temp = this->str + this->marks[block];
+        for (size_t i = index - block * this->interval; i > 0; --i)
+        {
+            easl::nextchar(temp);
+        }
+
+        return temp - this->str;
+    }
+
+    /**
+    *   \brief                 Retrieves the offsets of several characters in one pass.
+    *   \param  indices   [in]  The zero based indices of the characters. These must be sorted from lowest to highest.
+    *   \param  count     [in]  The number of indices.
+    *   \param  offsets   [out] Receives the offset in T's of each character, or -1 for indices past the end of the string.
+    *
+    *   \remarks
+    *       The string is decoded from the closest recorded offset before each index, unless the
+    *       previous index was closer. This means that indices close together are found by decoding
+    *       the string once.
+    */
+    void offsets(const size_t *indices, size_t count, size_t *offsets) const
+    {
+        const T *temp    = this->str;
+        size_t   current = 0;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t index = indices[i];
+            assert(i == 0 || indices[i - 1] <= index);
+
+            if (index > this->chars)
+            {
+                offsets[i] = (size_t)-1;
+                continue;
+            }
+
+            if (index == this->chars)
+            {
+                temp    = this->str + this->len;
+                current = this->chars;
+
+                offsets[i] = this->len;
+                continue;
+            }
+
+            // Jump forward to the closest mark if it's past where we are now.
+            size_t block = index / this->interval;
+            if (block < this->marks.size() && block * this->interval > current)
+            {
+                current = block * this->interval;
+                temp    = this->str + this->marks[block];
+            }
+
+            while (current < index)
+            {
+                easl::nextchar(temp);
+                ++current;
+            }
+
+            offsets[i] = temp - this->str;
+        }
+    }
+
+    /**
+    *   \brief             Retrieves a character by index.
+    *   \param  index [in] The zero based index of the character.
+    *   \return            The character; or 0 if the index is past the end of the string.
+    */
+    uchar32_t getchar(size_t index) const
+    {
+        if (index >= this->chars)
+        {
+            return '\0';
+        }
+
+        const T *temp = this->str + this->offset(index);
+        return easl::nextchar(temp);
+    }
+
+    /**
+    *   \brief             Retrieves a section of the string by character index.
+    *   \param  start [in] The index of the first character in the section.
+    *   \param  count [in] The number of characters in the section. This is clamped to the end of the string.
+    *   \return            A reference string pointing to the section.
+    */
+    reference_string<const T> slice(size_t start, size_t count = -1) const
+    {
+        if (start > this->chars)
+        {
+            start = this->chars;
+        }
+
+        if (count > this->chars - start)
+        {
+            count = this->chars - start;
+        }
+
+        size_t bounds[2] = {start, start + count};
+        size_t result[2];
+        this->offsets(bounds, 2, result);
+
+        reference_string<const T> section;
+        section.start = this->str + result[0];
+        section.end   = this->str + result[1];
+
+        return section;
+    }
+
+
+private:
+
+    /// The string the index was built for.
+    const T *str;
+
+    /// The length in T's of the indexed part of the string.
+    size_t len;
+
+    /// The number of characters in the indexed part of the string.
+    size_t chars;
+
+    /// The number of characters between each mark.
+    size_t interval;
+
+    /// The offset of every interval'th character, starting with the first one.
+    std::vector<size_t> marks;
+};
+
+
+}
+
+#endif // __EASL_CHARINDEX_H_
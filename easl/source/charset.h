@@ -0,0 +1,628 @@
+/**
+*   \file   charset.h
+*   \author Dave Reid
+*   \brief  Header file for the charset class.
+*/
+#ifndef __EASL_CHARSET_H_
+#define __EASL_CHARSET_H_
+
+#include <assert.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "types.h"
+#include "_simd.h"
+#include "length.h"
+#include "nextchar.h"
+#include "prevchar.h"
+
+namespace easl
+{
+
+/**
+*   \brief                  Builds the nibble tables for the charset kernels.
+*   \param  members   [in]  Whether or not each of the 256 byte values is in the set.
+*   \param  lowTable  [out] Receives the 16 bucket masks for the low nibble of a byte.
+*   \param  highTable [out] Receives the 16 bucket masks for the high nibble of a byte.
+*
+*   \remarks
+*       Each high nibble is put in a bucket with the other high nibbles that have the same set of
+*       low nibbles, and a byte is in the set when the masks for both of it's nibbles have a bucket
+*       in common. There are only 8 buckets, so if there are more distinct sets than that, the rest
+*       share the last bucket. That bucket then lets through some bytes that aren't in the set, so
+*       whatever the kernel finds must be checked again.
+*/
+inline void _charset_tables(const bool *members, unsigned char *lowTable, unsigned char *highTable)
+{
+    unsigned int low_sets[16];
+    for (unsigned int high = 0; high < 16; ++high)
+    {
+        low_sets[high] = 0;
+        for (unsigned int low = 0; low < 16; ++low)
+        {
+            if (members[(high << 4) | low])
+            {
+                low_sets[high] |= 1 << low;
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        lowTable[i]  = 0;
+        highTable[i] = 0;
+    }
+
+    unsigned int buckets[8];
+    unsigned int bucket_count = 0;
+
+    for (unsigned int high = 0; high < 16; ++high)
+    {
+        if (low_sets[high] == 0)
+        {
+            continue;
+        }
+
+        unsigned int bucket = 0;
+        while (bucket < bucket_count && buckets[bucket] != low_sets[high])
+        {
+            ++bucket;
+        }
+
+        if (bucket == bucket_count)
+        {
+            if (bucket_count < 8)
+            {
+                buckets[bucket_count++] = low_sets[high];
+            }
+            else
+            {
+                bucket = 7;
+                buckets[bucket] |= low_sets[high];
+            }
+        }
+
+        highTable[high] |= static_cast<unsigned char>(1 << bucket);
+    }
+
+    for (unsigned int bucket = 0; bucket < bucket_count; ++bucket)
+    {
+        for (unsigned int low = 0; low < 16; ++low)
+        {
+            if ((buckets[bucket] & (1 << low)) != 0)
+            {
+                lowTable[low] |= static_cast<unsigned char>(1 << bucket);
+            }
+        }
+    }
+}
+
+#if defined(EASL_KERNEL_SSSE3)
+/**
+*   \brief                  Looks up 16 bytes in the nibble tables from _charset_tables().
+*   \return                 A mask with a bit set for each byte that might be in the set.
+*/
+EASL_TARGET("ssse3") inline unsigned int _charset_lookup_ssse3(__m128i input, __m128i lowTable, __m128i highTable)
+{
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+
+    __m128i low  = _mm_shuffle_epi8(lowTable,  _mm_and_si128(input, low_nibble));
+    __m128i high = _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble));
+
+    return static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128()))) ^ 0xFFFF;
+}
+
+/**
+*   \brief                  Looks up a block of 16 code units in the nibble tables from _charset_tables().
+*   \param  block     [in]  Pointer to the first code unit of the block.
+*   \param  width     [in]  The size of a code unit in bytes. This must be 1, 2 or 4.
+*   \param  lowTable  [in]  The low nibble table.
+*   \param  highTable [in]  The high nibble table.
+*   \return                 A mask with a bit set for each code unit that might be in the set.
+*
+*   \remarks
+*       Wider code units are packed down to bytes with saturation before they're looked up. Anything
+*       from 0x100 up is looked up as 0xFF, except for the top half of the range of a code unit,
+*       which is looked up as 0.
+*/
+EASL_TARGET("ssse3") inline unsigned int _charset_block_ssse3(const char *block, size_t width, __m128i lowTable, __m128i highTable)
+{
+    const __m128i *source = reinterpret_cast<const __m128i *>(block);
+
+    __m128i input;
+    if (width == 1)
+    {
+        input = _mm_loadu_si128(source);
+    }
+    else if (width == 2)
+    {
+        input = _mm_packus_epi16(_mm_loadu_si128(source), _mm_loadu_si128(source + 1));
+    }
+    else
+    {
+        input = _mm_packus_epi16(_mm_packs_epi32(_mm_loadu_si128(source),     _mm_loadu_si128(source + 1)),
+                                 _mm_packs_epi32(_mm_loadu_si128(source + 2), _mm_loadu_si128(source + 3)));
+    }
+
+    return _charset_lookup_ssse3(input, lowTable, highTable);
+}
+
+/**
+*   \brief                  SSSE3 kernel that skips code units that aren't in a set, 16 at a time.
+*   \param  str       [in]  Pointer to the start of the string.
+*   \param  strEnd    [in]  Pointer to the end of the string.
+*   \param  width     [in]  The size of a code unit in bytes. This must be 1, 2 or 4.
+*   \param  lowTable  [in]  The low nibble table from _charset_tables().
+*   \param  highTable [in]  The high nibble table from _charset_tables().
+*   \return                 A pointer to the first code unit that might be in the set, or to the start of
+*                           the last partial block if none were found.
+*/
+EASL_TARGET("ssse3") inline const char * _charset_skip_ssse3(const char *str, const char *strEnd, size_t width, const unsigned char *lowTable, const unsigned char *highTable)
+{
+    const __m128i low_table  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lowTable));
+    const __m128i high_table = _mm_loadu_si128(reinterpret_cast<const __m128i *>(highTable));
+    const size_t  step       = 16 * width;
+
+    while (static_cast<size_t>(strEnd - str) >= step)
+    {
+        unsigned int mask = _charset_block_ssse3(str, width, low_table, high_table);
+        if (mask != 0)
+        {
+            return str + _bitscan_forward(mask) * width;
+        }
+
+        str += step;
+    }
+
+    return str;
+}
+
+/**
+*   \brief                  SSSE3 kernel that skips code units that aren't in a set, 16 at a time, working back from the end of the string.
+*   \param  str       [in]  Pointer to the start of the string.
+*   \param  strEnd    [in]  Pointer to the end of the string.
+*   \param  width     [in]  The size of a code unit in bytes. This must be 1, 2 or 4.
+*   \param  lowTable  [in]  The low nibble table from _charset_tables().
+*   \param  highTable [in]  The high nibble table from _charset_tables().
+*   \return                 A pointer to just past the last code unit that might be in the set, or to the end
+*                           of the first partial block if none were found.
+*/
+EASL_TARGET("ssse3") inline const char * _charset_skip_back_ssse3(const char *str, const char *strEnd, size_t width, const unsigned char *lowTable, const unsigned char *highTable)
+{
+    const __m128i low_table  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lowTable));
+    const __m128i high_table = _mm_loadu_si128(reinterpret_cast<const __m128i *>(highTable));
+    const size_t  step       = 16 * width;
+
+    while (static_cast<size_t>(strEnd - str) >= step)
+    {
+        unsigned int mask = _charset_block_ssse3(strEnd - step, width, low_table, high_table);
+        if (mask != 0)
+        {
+            return strEnd - step + (_bitscan_reverse(mask) + 1) * width;
+        }
+
+        strEnd -= step;
+    }
+
+    return strEnd;
+}
+#endif
+
+
+/**
+*   \brief  A set of characters that has been prepared for searching.
+*
+*   The set is built once, after which findfirstof() and findlastof() can look for any of it's
+*   characters without going back over the set for every character of the string:
+*
+*   \code
+*   easl::charset<char> separators(",;|");
+*   const char *field_end = easl::findfirstof(line, separators, lineLength);
+*   \endcode
+*
+*   ASCII characters are kept in a 128-bit bitmap. Everything else is kept as a sorted list of
+*   ranges of code points, so large blocks like a whole script cost no more than a single
+*   character.
+*
+*   When searching, ASCII code units can be checked without decoding, since they're always
+*   characters on their own. With SSSE3, the code units are checked 16 at a time with a nibble
+*   table lookup, and only code units outside of ASCII need to be decoded, and only when the set
+*   has non-ASCII characters in it.
+*/
+template <typename T>
+class charset
+{
+public:
+
+    /**
+    *   \brief  Constructor. The set starts out empty.
+    */
+    charset()
+        : m_ranges()
+    {
+        _clear();
+        _update_tables();
+    }
+
+    /**
+    *   \brief                  Constructor.
+    *   \param  chars      [in] The characters to add to the set.
+    *   \param  charsLength[in] The length in T's of the characters string, not including the null terminator.
+    */
+    charset(const T *chars, size_t charsLength = -1)
+        : m_ranges()
+    {
+        _clear();
+        add(chars, charsLength);
+    }
+
+
+    /**
+    *   \brief                  Adds every character of a string to the set.
+    *   \param  chars       [in] The characters to add to the set.
+    *   \param  charsLength [in] The length in T's of the string, not including the null terminator.
+    *
+    *   \remarks
+    *       If the length is -1, the string must be null terminated. Invalid sequences are skipped.
+    */
+    void add(const T *chars, size_t charsLength = -1)
+    {
+        assert(chars != NULL);
+
+        const T *chars_end = chars + ((charsLength == (size_t)-1) ? length(chars) : charsLength);
+        while (chars < chars_end)
+        {
+            const T *next = chars;
+            uchar32_t ch = nextchar(next, chars_end);
+
+            if (next == chars)
+            {
+                ++chars;
+                continue;
+            }
+
+            _insert(ch, ch);
+            chars = next;
+        }
+
+        _normalize();
+        _update_tables();
+    }
+
+    /**
+    *   \brief                 Adds a character to the set.
+    *   \param  character [in] The character to add.
+    */
+    void add(uchar32_t character)
+    {
+        add(character, character);
+    }
+
+    /**
+    *   \brief             Adds a range of characters to the set.
+    *   \param  first [in] The first character of the range.
+    *   \param  last  [in] The last character of the range. This is included in the range.
+    */
+    void add(uchar32_t first, uchar32_t last)
+    {
+        assert(first <= last);
+
+        _insert(first, last);
+        _normalize();
+        _update_tables();
+    }
+
+
+    /**
+    *   \brief                 Determines if a character is in the set.
+    *   \param  character [in] The character to check.
+    *   \return                True if the character is in the set; false otherwise.
+    */
+    bool contains(uchar32_t character) const
+    {
+        if (character < 0x80)
+        {
+            return (m_ascii[character >> 5] & (1U << (character & 31))) != 0;
+        }
+
+        // Find the last range that starts at or before the character.
+        std::vector<std::pair<uchar32_t, uchar32_t> >::const_iterator i =
+            std::upper_bound(m_ranges.begin(), m_ranges.end(), std::make_pair(character, (uchar32_t)-1));
+
+        return i != m_ranges.begin() && character <= (i - 1)->second;
+    }
+
+    /**
+    *   \brief  Determines if the set only contains ASCII characters.
+    */
+    bool ascii_only() const
+    {
+        return m_ranges.empty();
+    }
+
+
+    /**
+    *   \brief               Finds the first character between two pointers that is in the set.
+    *   \param  str     [in] Pointer to the start of the string to search.
+    *   \param  strEnd  [in] Pointer to the end of the string to search.
+    *   \return              A pointer to the first character that is in the set; or NULL if there isn't one.
+    *
+    *   \remarks
+    *       The string does not need to be null terminated and nothing at or past \c strEnd is read.
+    *       Invalid sequences are skipped one T at a time.
+    */
+    const T * find(const T *str, const T *strEnd) const
+    {
+        assert(str <= strEnd);
+
+        while ((str = _skip(str, strEnd)) < strEnd)
+        {
+            // _skip() only stops on ASCII code units that are in the set.
+            if (_unit(*str) < 0x80)
+            {
+                return str;
+            }
+
+            const T *next = str;
+            uchar32_t ch = nextchar(next, strEnd);
+
+            if (next == str)
+            {
+                ++str;
+                continue;
+            }
+
+            if (contains(ch))
+            {
+                return str;
+            }
+
+            str = next;
+        }
+
+        return NULL;
+    }
+
+    /**
+    *   \brief                 Finds the first character in a string that is in the set.
+    *   \param  str       [in] The string to search.
+    *   \param  strLength [in] The length in T's of the string, not including the null terminator.
+    *   \return                A pointer to the first character that is in the set; or NULL if there isn't one.
+    *
+    *   \remarks
+    *       The search stops at the first null character, even when the length is given.
+    */
+    const T * find(const T *str, size_t strLength = -1) const
+    {
+        assert(str != NULL);
+
+        return find(str, str + ((strLength == (size_t)-1) ? length(str) : length(str, strLength)));
+    }
+
+
+    /**
+    *   \brief               Finds the last character between two pointers that is in the set.
+    *   \param  str     [in] Pointer to the start of the string to search.
+    *   \param  strEnd  [in] Pointer to the end of the string to search.
+    *   \return              A pointer to the last character that is in the set; or NULL if there isn't one.
+    *
+    *   \remarks
+    *       This works the same way as find(), but starts from the end of the string. Non-ASCII
+    *       characters are decoded with prevchar().
+    */
+    const T * find_last(const T *str, const T *strEnd) const
+    {
+        assert(str <= strEnd);
+
+        while ((strEnd = _skip_back(str, strEnd)) > str)
+        {
+            if (_unit(strEnd[-1]) < 0x80)
+            {
+                return strEnd - 1;
+            }
+
+            const T *prev = strEnd;
+            uchar32_t ch = prevchar(prev, str);
+
+            if (prev == strEnd)
+            {
+                --strEnd;
+                continue;
+            }
+
+            if (contains(ch))
+            {
+                return prev;
+            }
+
+            strEnd = prev;
+        }
+
+        return NULL;
+    }
+
+    /**
+    *   \brief                 Finds the last character in a string that is in the set.
+    *   \param  str       [in] The string to search.
+    *   \param  strLength [in] The length in T's of the string, not including the null terminator.
+    *   \return                A pointer to the last character that is in the set; or NULL if there isn't one.
+    *
+    *   \remarks
+    *       The string ends at the first null character, even when the length is given.
+    */
+    const T * find_last(const T *str, size_t strLength = -1) const
+    {
+        assert(str != NULL);
+
+        return find_last(str, str + ((strLength == (size_t)-1) ? length(str) : length(str, strLength)));
+    }
+
+
+private:
+
+    /// Retrieves a code unit as an unsigned value.
+    static uchar32_t _unit(T unit)
+    {
+        if (sizeof(T) == 1)
+        {
+            return static_cast<unsigned char>(unit);
+        }
+        else if (sizeof(T) == 2)
+        {
+            return static_cast<uchar16_t>(unit);
+        }
+
+        return static_cast<uchar32_t>(unit);
+    }
+
+    /// Determines if a code unit needs a closer look: it's either an ASCII character in the set or part of a non-ASCII character when the set has any.
+    bool _candidate(T unit) const
+    {
+        uchar32_t value = _unit(unit);
+        if (value < 0x80)
+        {
+            return (m_ascii[value >> 5] & (1U << (value & 31))) != 0;
+        }
+
+        return !m_ranges.empty();
+    }
+
+    /// Skips code units that don't need a closer look.
+    const T * _skip(const T *str, const T *strEnd) const
+    {
+        while (str < strEnd)
+        {
+#if defined(EASL_KERNEL_SSSE3)
+            if (sizeof(T) <= 4 && static_cast<size_t>(strEnd - str) >= 16 && cpu_supports(EASL_CPU_SSSE3))
+            {
+                str = reinterpret_cast<const T *>(_charset_skip_ssse3(reinterpret_cast<const char *>(str), reinterpret_cast<const char *>(strEnd), sizeof(T), m_low_table, m_high_table));
+                if (str == strEnd)
+                {
+                    break;
+                }
+            }
+#endif
+
+            if (_candidate(*str))
+            {
+                return str;
+            }
+
+            ++str;
+        }
+
+        return strEnd;
+    }
+
+    /// Skips code units that don't need a closer look, working back from the end. Returns a pointer to just past the code unit that was stopped on.
+    const T * _skip_back(const T *str, const T *strEnd) const
+    {
+        while (str < strEnd)
+        {
+#if defined(EASL_KERNEL_SSSE3)
+            if (sizeof(T) <= 4 && static_cast<size_t>(strEnd - str) >= 16 && cpu_supports(EASL_CPU_SSSE3))
+            {
+                strEnd = reinterpret_cast<const T *>(_charset_skip_back_ssse3(reinterpret_cast<const char *>(str), reinterpret_cast<const char *>(strEnd), sizeof(T), m_low_table, m_high_table));
+                if (str == strEnd)
+                {
+                    break;
+                }
+            }
+#endif
+
+            if (_candidate(strEnd[-1]))
+            {
+                return strEnd;
+            }
+
+            --strEnd;
+        }
+
+        return str;
+    }
+
+    /// Empties the set.
+    void _clear()
+    {
+        m_ascii[0] = m_ascii[1] = m_ascii[2] = m_ascii[3] = 0;
+        m_ranges.clear();
+    }
+
+    /// Adds a range of characters without sorting the ranges. The ASCII part goes in the bitmap.
+    void _insert(uchar32_t first, uchar32_t last)
+    {
+        for ( ; first < 0x80 && first <= last; ++first)
+        {
+            m_ascii[first >> 5] |= 1U << (first & 31);
+        }
+
+        if (first <= last)
+        {
+            m_ranges.push_back(std::make_pair(first, last));
+        }
+    }
+
+    /// Sorts the ranges and joins the ones that overlap or touch.
+    void _normalize()
+    {
+        if (m_ranges.empty())
+        {
+            return;
+        }
+
+        std::sort(m_ranges.begin(), m_ranges.end());
+
+        size_t count = 1;
+        for (size_t i = 1; i < m_ranges.size(); ++i)
+        {
+            std::pair<uchar32_t, uchar32_t> &prev = m_ranges[count - 1];
+            if (m_ranges[i].first <= prev.second || m_ranges[i].first - prev.second == 1)
+            {
+                if (m_ranges[i].second > prev.second)
+                {
+                    prev.second = m_ranges[i].second;
+                }
+            }
+            else
+            {
+                m_ranges[count++] = m_ranges[i];
+            }
+        }
+
+        m_ranges.resize(count);
+    }
+
+    /// Rebuilds the nibble tables for the SIMD kernels.
+    void _update_tables()
+    {
+        bool members[256];
+        for (uchar32_t value = 0; value < 256; ++value)
+        {
+            members[value] = _candidate(static_cast<T>(value));
+        }
+
+        // The kernels for wider code units look up the top half of the code unit range as 0.
+        if (sizeof(T) > 1 && !m_ranges.empty())
+        {
+            members[0] = true;
+        }
+
+        _charset_tables(members, m_low_table, m_high_table);
+    }
+
+
+    /// The bitmap of ASCII characters in the set.
+    unsigned int m_ascii[4];
+
+    /// The sorted, non-overlapping ranges of non-ASCII characters in the set.
+    std::vector<std::pair<uchar32_t, uchar32_t> > m_ranges;
+
+    /// The nibble tables for the SIMD kernels.
+    unsigned char m_low_table[16];
+    unsigned char m_high_table[16];
+};
+
+
+}
+
+#endif // __EASL_CHARSET_H_
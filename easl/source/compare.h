@@ -9,9 +9,11 @@
 #include <string.h>
 #include <assert.h>
 #include "nextchar.h"
+#include "encoding.h"
 #include "length.h"
 #include "reference_string.h"
 #include "charwidth.h"
+#include "literal.h"
 
 namespace easl
 {
@@ -72,6 +74,99 @@ inline int compare(const reference_string<T> &str1, const reference_string<U> &s
     return compare(str1.start, str2.start, length(str1), length(str2));
 }
 
+/**
+*   \brief                  Compares two strings that have the same encoding, decoding them as described by an encoding tag.
+*   \param  str1       [in] The first string to compare.
+*   \param  str2       [in] The second string to compare.
+*   \param  str1Length [in] The length in T's of the first string.
+*   \param  str2Length [in] The length in T's of the second string.
+*   \param  encoding   [in] The encoding tag of both strings. See encoding.h.
+*   \return                 0 if the two strings are equal; -1 if \c str1 is lower than \c str2; +1 otherwise.
+*
+*   \remarks
+*       This works like compare(const T *, const U *, size_t, size_t). Both strings are described by the same
+*       tag, so they need to use the same type of code unit. With a strict tag, an invalid character is
+*       compared as if it were a null terminator.
+*/
+template <typename T, int Encoding, bool Strict>
+inline int compare(const T *str1, const T *str2, size_t str1Length, size_t str2Length, encoding_tag<Encoding, Strict> encoding)
+{
+    assert(str1 != NULL);
+    assert(str2 != NULL);
+
+    int ret = 0;
+
+    while (str1Length > 0 && str2Length > 0)
+    {
+        const T *next1 = str1;
+        const T *next2 = str2;
+
+        uchar32_t ch1 = nextchar(next1, encoding);
+        uchar32_t ch2 = nextchar(next2, encoding);
+
+        ret = (ch1 < ch2) ? -1 : (ch1 > ch2) ? 1 : 0;
+
+        if (ret != 0 || ch2 == '\0')
+        {
+            break;
+        }
+
+        str1Length -= next1 - str1;
+        str2Length -= next2 - str2;
+        str1 = next1;
+        str2 = next2;
+    }
+
+    return ret;
+}
+
+
+/**
+*   \brief                 Compares a string with a literal.
+*   \param  str       [in] The string to compare.
+*   \param  lit       [in] The literal to compare the string with.
+*   \param  strLength [in] The length in T's of the string.
+*   \return                0 if the two are equal; -1 if \c str is lower than \c lit; +1 otherwise.
+*
+*   \remarks
+*       The string is compared against the version of the literal with the same encoding, so the code
+*       units are compared directly without decoding. The order is the same as the other compare()
+*       overloads.
+*       \par
+*       If the length of the string is unknown, but it is NULL terminated, set the length to -1.
+*/
+template <typename T, typename U, size_t N>
+inline int compare(const T *str, const literal<U, N> &lit, size_t strLength = -1)
+{
+    assert(str != NULL);
+
+    reference_string<const T> other = _literal_string(lit, static_cast<const T *>(NULL));
+    size_t other_length = length(other);
+
+    for (size_t i = 0; ; ++i)
+    {
+        // The end of either string is treated like a null terminator.
+        uchar32_t unit1 = (i < strLength)    ? _literal_unit(str[i])         : 0;
+        uchar32_t unit2 = (i < other_length) ? _literal_unit(other.start[i]) : 0;
+
+        if (unit1 != unit2)
+        {
+            return (unit1 < unit2) ? -1 : 1;
+        }
+
+        if (unit1 == 0)
+        {
+            return 0;
+        }
+    }
+}
+
+template <typename T, typename U, size_t N>
+inline int compare(const reference_string<T> &str, const literal<U, N> &lit)
+{
+    return compare(str.start, lit, length(str));
+}
+
 
 }
 
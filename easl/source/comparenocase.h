@@ -0,0 +1,131 @@
+/**
+*   \file   comparenocase.h
+*   \author Dave Reid
+*   \brief  Header file for comparenocase() implementations.
+*/
+#ifndef __EASL_COMPARENOCASE_H_
+#define __EASL_COMPARENOCASE_H_
+
+#include <assert.h>
+#include "casefold.h"
+#include "length.h"
+#include "literal.h"
+#include "reference_string.h"
+
+namespace easl
+{
+
+/**
+*   \brief                  Compares two strings between pointers without regard to case.
+*   \param  str1       [in] Pointer to the start of the first string.
+*   \param  str1End    [in] Pointer to the end of the first string.
+*   \param  str2       [in] Pointer to the start of the second string.
+*   \param  str2End    [in] Pointer to the end of the second string.
+*   \return                 0 if the two strings are equal; -1 if \c str1 is lower than \c str2; +1 otherwise.
+*
+*   \remarks
+*       Characters are compared by their case folding. When both strings use the same encoding, they are
+*       compared 16 bytes at a time with _casefold_skip_blocks(), and only the block where that stops is
+*       compared one character at a time before going back to whole blocks.
+*/
+template <typename T, typename U>
+inline int _compare_nocase(const T *str1, const T *str1End, const U *str2, const U *str2End)
+{
+    for (;;)
+    {
+        size_t count1 = str1End - str1;
+        size_t count2 = str2End - str2;
+
+        size_t skipped = _casefold_skip_blocks(str1, str2, (count1 < count2) ? count1 : count2);
+        str1 += skipped;
+        str2 += skipped;
+
+        // Characters are compared until the first string is past the block that couldn't be skipped.
+        const T *block_end = str1 + 16 / sizeof(T);
+        if (sizeof(T) != sizeof(U) || block_end > str1End)
+        {
+            block_end = str1End;
+        }
+
+        do
+        {
+            if (str1 == str1End || str2 == str2End)
+            {
+                return (str1 != str1End) ? 1 : (str2 != str2End) ? -1 : 0;
+            }
+
+            uchar32_t ch1 = _casefold_next(str1, str1End);
+            uchar32_t ch2 = _casefold_next(str2, str2End);
+
+            if (ch1 != ch2)
+            {
+                return (ch1 < ch2) ? -1 : 1;
+            }
+        } while (str1 < block_end);
+    }
+}
+
+
+/**
+*   \brief                  Compares two strings without regard to case.
+*   \param  str1       [in] The first string to compare.
+*   \param  str2       [in] The second string to compare.
+*   \param  str1Length [in] The length in T's of the first string.
+*   \param  str2Length [in] The length in U's of the second string.
+*   \return                 0 if the two strings are equal; -1 if \c str1 is lower than \c str2; +1 otherwise.
+*
+*   \remarks
+*       This is the case insensitive version of compare(const T *, const U *, size_t, size_t). "Hello"
+*       equals "HELLO". Characters are compared by their simple case folding (see casefold()), so
+*       the order is that of the folded characters.
+*       \par
+*       Each string ends at its first null character. If the length of a string is unknown, but it is
+*       NULL terminated, set the length to -1.
+*/
+template <typename T, typename U>
+inline int comparenocase(const T *str1, const U *str2, size_t str1Length = -1, size_t str2Length = -1)
+{
+    assert(str1 != NULL);
+    assert(str2 != NULL);
+
+    const T *str1_end = str1 + ((str1Length == (size_t)-1) ? length(str1) : length(str1, str1Length));
+    const U *str2_end = str2 + ((str2Length == (size_t)-1) ? length(str2) : length(str2, str2Length));
+
+    return _compare_nocase(str1, str1_end, str2, str2_end);
+}
+
+template <typename T, typename U>
+inline int comparenocase(const reference_string<T> &str1, const reference_string<U> &str2)
+{
+    return comparenocase(str1.start, str2.start, length(str1), length(str2));
+}
+
+/**
+*   \brief                 Compares a string with a literal without regard to case.
+*   \param  str       [in] The string to compare.
+*   \param  lit       [in] The literal to compare the string with.
+*   \param  strLength [in] The length in T's of the string.
+*   \return                0 if the two are equal; -1 if \c str is lower than \c lit; +1 otherwise.
+*
+*   \remarks
+*       The string is compared against the version of the literal with the same encoding, so ASCII
+*       blocks can be compared without decoding either of them.
+*/
+template <typename T, typename U, size_t N>
+inline int comparenocase(const T *str, const literal<U, N> &lit, size_t strLength = -1)
+{
+    reference_string<const T> other = _literal_string(lit, static_cast<const T *>(NULL));
+
+    return comparenocase(str, other.start, strLength, length(other));
+}
+
+template <typename T, typename U, size_t N>
+inline int comparenocase(const reference_string<T> &str, const literal<U, N> &lit)
+{
+    return comparenocase(str.start, lit, length(str));
+}
+
+
+}
+
+#endif // __EASL_COMPARENOCASE_H_
@@ -0,0 +1,186 @@
+/**
+*   \file   containsonlyascii.h
+*   \author Dave Reid
+*   \brief  Header file for containsonlyascii() implementations.
+*/
+#ifndef __EASL_CONTAINSONLYASCII_H_
+#define __EASL_CONTAINSONLYASCII_H_
+
+#include <assert.h>
+#include "types.h"
+#include "_simd.h"
+#include "length.h"
+#include "reference_string.h"
+
+namespace easl
+{
+
+#if defined(EASL_SIMD_SSE2)
+/**
+*   \brief              Retrieves the bits that must be clear in every code unit of an ASCII string.
+*   \param  width [in]  The size of a code unit in bytes.
+*
+*   \remarks
+*       This is 0x80 in the lowest byte of each code unit and 0xFF in the rest.
+*/
+inline __m128i _ascii_mask(size_t width)
+{
+    if (width == 1)
+    {
+        return _mm_set1_epi8((char)0x80);
+    }
+    else if (width == 2)
+    {
+        return _mm_set1_epi16((short)0xFF80);
+    }
+    else if (width == 4)
+    {
+        return _mm_set1_epi32((int)0xFFFFFF80);
+    }
+
+    return _mm_set_epi32(-1, (int)0xFFFFFF80, -1, (int)0xFFFFFF80);
+}
+#endif
+
+#if defined(EASL_KERNEL_AVX2)
+/**
+*   \brief                  AVX2 kernel for containsonlyascii(). Checks whole 128 byte blocks.
+*   \param  str   [in, out] The string to check. This is moved past the checked blocks.
+*   \param  end   [in]      Pointer to the end of the string.
+*   \param  mask  [in]      The mask from _ascii_mask().
+*   \return                 False if a block has a code unit outside of ASCII; true otherwise.
+*/
+EASL_TARGET("avx2") inline bool _containsonlyascii_avx2(const char *&str, const char *end, __m128i mask)
+{
+    const __m256i mask256 = _mm256_broadcastsi128_si256(mask);
+
+    while (end - str >= 128)
+    {
+        __m256i input = _mm256_or_si256(
+            _mm256_or_si256(_mm256_loadu_si256((const __m256i *)str),        _mm256_loadu_si256((const __m256i *)(str + 32))),
+            _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(str + 64)), _mm256_loadu_si256((const __m256i *)(str + 96))));
+
+        if (!_mm256_testz_si256(input, mask256))
+        {
+            return false;
+        }
+
+        str += 128;
+    }
+
+    return true;
+}
+#endif
+
+/**
+*   \brief                  Checks whole 16 byte blocks for code units outside of ASCII.
+*   \param  str   [in, out] The string to check. This is moved past the checked blocks.
+*   \param  end   [in]      Pointer to the end of the string.
+*   \param  width [in]      The size of a code unit in bytes.
+*   \return                 False if a block has a code unit outside of ASCII; true otherwise.
+*
+*   \remarks
+*       The remaining bytes, if any, are left for the caller to check one code unit at a time.
+*/
+inline bool _containsonlyascii_blocks(const char *&str, const char *end, size_t width)
+{
+#if defined(EASL_SIMD_SSE2)
+    const __m128i mask = _ascii_mask(width);
+
+    // Short strings aren't worth checking the CPU for.
+    if (end - str >= 128)
+    {
+#if defined(EASL_KERNEL_AVX2)
+        if (cpu_supports(EASL_CPU_AVX2) && !_containsonlyascii_avx2(str, end, mask))
+        {
+            return false;
+        }
+#endif
+    }
+
+    // The blocks are ORed together so that there's only one branch for every 64 bytes.
+    const __m128i zero = _mm_setzero_si128();
+    while (end - str >= 64)
+    {
+        __m128i input = _mm_or_si128(
+            _mm_or_si128(_mm_loadu_si128((const __m128i *)str),        _mm_loadu_si128((const __m128i *)(str + 16))),
+            _mm_or_si128(_mm_loadu_si128((const __m128i *)(str + 32)), _mm_loadu_si128((const __m128i *)(str + 48))));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(input, mask), zero)) != 0xFFFF)
+        {
+            return false;
+        }
+
+        str += 64;
+    }
+
+    while (end - str >= 16)
+    {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(_mm_loadu_si128((const __m128i *)str), mask), zero)) != 0xFFFF)
+        {
+            return false;
+        }
+
+        str += 16;
+    }
+#else
+    (void)end;
+    (void)width;
+#endif
+
+    return true;
+}
+
+
+/**
+*   \brief                 Determines if a string contains only ASCII characters.
+*   \param  str       [in] The string to check.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*   \return                True if every code unit in the string is below 0x80; false otherwise.
+*
+*   \remarks
+*       An ASCII string has one T per character in every encoding, so algorithms can work on
+*       the T's directly instead of decoding them. fast_string uses this to keep track of
+*       whether or not its contents are ASCII.
+*       \par
+*       If the length is -1, the string must be null terminated.
+*/
+template <typename T>
+inline bool containsonlyascii(const T *str, size_t strLength = -1)
+{
+    assert(str != NULL);
+
+    if (strLength == (size_t)-1)
+    {
+        strLength = length(str);
+    }
+
+    // Every block is a whole number of T's, so whatever is left over starts on a T.
+    const char *bytes = reinterpret_cast<const char *>(str);
+    if (!_containsonlyascii_blocks(bytes, reinterpret_cast<const char *>(str + strLength), sizeof(T)))
+    {
+        return false;
+    }
+
+    // A negative T is never ASCII either, so the conversion to unsigned is fine for signed types.
+    for (const T *temp = reinterpret_cast<const T *>(bytes); temp < str + strLength; ++temp)
+    {
+        if ((static_cast<uchar32_t>(*temp) & ~static_cast<uchar32_t>(0x7F)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+inline bool containsonlyascii(const reference_string<T> &str)
+{
+    return containsonlyascii(str.start, length(str));
+}
+
+
+}
+
+#endif // __EASL_CONTAINSONLYASCII_H_
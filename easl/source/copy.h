@@ -8,12 +8,12 @@
 
 #include "setup.h"
 #include "nextchar.h"
+#include "encoding.h"
 #include "writechar.h"
 #include "length.h"
+#include "transcode.h"
 
-#if ((COMPILER & COMPILER_VC) && COMPILER >= COMPILER_VC80)
 #include <string.h>
-#endif
 
 namespace easl
 {
@@ -54,52 +54,34 @@ namespace easl
 template <typename T>
 inline size_t copy(T *dest, const T *source, size_t destSize = -1, size_t sourceLength = -1)
 {
-    if (source == NULL || (dest == NULL && destSize == 0))
+    if (source == NULL || destSize == 0)
     {
         return 0;
     }
 
-    // We need to copy the original count so can return a good value.
-    size_t temp_count = sourceLength;
-
-    // Now we loop through and copy character by character.
-    while (destSize > 1 && sourceLength > 0 && *source != '\0')
+    if (sourceLength == (size_t)-1)
     {
-        *dest = *source;
-
-        ++dest;
-        ++source;
-        --destSize;
-        --sourceLength;
+        sourceLength = length(source);
     }
-
-    // Ensure that we have a null terminator.
-    *dest = '\0';
-
-    return temp_count + 1;
-}
-
-// Visual Studio 2005+ specific. Makes the final binary a little smaller in size.
-#if ((COMPILER & COMPILER_VC) && COMPILER >= COMPILER_VC80)
-template <> inline size_t copy(char *dest, const char *source, size_t destSize, size_t sourceLength)
-{
-    if (dest != NULL)
+    else
     {
-        ::strncpy_s(dest, destSize, source, sourceLength);
+        sourceLength = length(source, sourceLength);
     }
 
-    return sourceLength + 1;
-}
-template <> inline size_t copy(wchar_t *dest, const wchar_t *source, size_t destSize, size_t sourceLength)
-{
+    // There's no conversion to do, so we can copy everything that fits in one go.
     if (dest != NULL)
     {
-        ::wcsncpy_s(dest, destSize, source, sourceLength);
+        if (sourceLength > destSize - 1)
+        {
+            sourceLength = destSize - 1;
+        }
+
+        ::memcpy(dest, source, sourceLength * sizeof(T));
+        dest[sourceLength] = '\0';
     }
 
     return sourceLength + 1;
 }
-#endif
 
 /**
 *   \brief                     Copies a string over to another string.
@@ -118,16 +100,21 @@ template <> inline size_t copy(wchar_t *dest, const wchar_t *source, size_t dest
 *       converted from a UTF-16 char16_t string to a UTF-8 char string.
 *       \par
 *       The \c destSize parameter specifies the size in T's of the destination buffer.
-*       If this is equal to -1, the function will do an unsafe copy and should in theory
-*       be slightly quicker. If \c destSize is a value larger than the actual size of
-*       the destination buffer, the results are undefined. This parameter can not be NULL.
+*       If this is equal to -1, the function will do an unsafe copy and the buffer must be at
+*       least copysize() T's. The conversion is then done one character at a time, since the
+*       vector paths need to know how much room there is. If \c destSize is a value larger
+*       than the actual size of the destination buffer, the results are undefined. This
+*       parameter can not be NULL.
 *       \par
 *       The \c sourceLength parameter specifies the length of the source string. Note that
-*       this is _not_ the number of characters to copy over, but rather the number of T's.
+*       this is _not_ the number of characters to copy over, but rather the number of U's.
 *       This parameter can be used to copy only a subset of the source string. If
-*       \c sourceCount is larger or equal to the number of T's in the source string,
+*       \c sourceLength is larger or equal to the number of U's in the source string,
 *       the entire source string is copied over. This parameter should not include the NULL
-*       terminator.
+*       terminator. A character that is split by the end of the source string is not copied.
+*       \par
+*       The conversion itself is done by transcode(). Invalid sequences in the source string
+*       end the copy.
 *       \par
 *       The resulting string is always null terminated.
 *       \par
@@ -142,54 +129,238 @@ inline size_t copy(T *dest, const U *source, size_t destSize = -1, size_t source
         return 0;
     }
 
-    // Variable to store the return value. We initialse to 1 for the null terminator.
-    size_t copy_size = 1;
+    // The transcoders need to know where the source ends. They will still stop at a null
+    // terminator if one comes first, but they may read ahead up to the end that we give them,
+    // so it can't be past the null terminator.
+    if (sourceLength == (size_t)-1)
+    {
+        sourceLength = length(source);
+    }
+    else
+    {
+        sourceLength = length(source, sourceLength);
+    }
 
-    // Now we need to loop through each character in the source and copy over the character.
-    uchar32_t ch;
-    while (destSize > 1 && sourceLength > 0 && (ch = nextchar(source)) != '\0')
+    // The conversion is done by the block transcoders. We need to leave room for the null terminator,
+    // unless the size is unknown, which the transcoders need to see as -1.
+    size_t copy_size = transcode(dest, (destSize != (size_t)-1) ? destSize - 1 : destSize, source, source + sourceLength);
+
+    // NULL terminate the destination.
+    if (dest != NULL)
     {
-        // Variable that stores the width of the current character.
-        size_t char_width;
+        dest[copy_size] = '\0';
+    }
 
-        if (dest != NULL)
+    return copy_size + 1;
+}
+
+
+/**
+*   \brief                       Copies a string over to another string, decoding the source as described by an encoding tag.
+*   \param  dest           [out] The destination buffer.
+*   \param  source         [in]  The source string.
+*   \param  destSize       [in]  The size of the destination buffer in T's.
+*   \param  sourceLength   [in]  The maximum number of U's to copy from the source.
+*   \param  sourceEncoding [in]  The encoding tag of the source string. See encoding.h.
+*   \return                      The number of T's that are copied to the destination.
+*
+*   \remarks
+*       This works like copy(T *, const U *, size_t, size_t), except that each character of the source is
+*       decoded by the tag instead of by U. The destination is always written in the encoding of T. An
+*       invalid character in the source ends the copy, as does a character that doesn't fit in the
+*       destination.
+*       \par
+*       The resulting string is always null terminated.
+*/
+template <typename T, typename U, int Encoding, bool Strict>
+inline size_t copy(T *dest, const U *source, size_t destSize, size_t sourceLength, encoding_tag<Encoding, Strict> sourceEncoding)
+{
+    if (source == NULL || destSize == 0)
+    {
+        return 0;
+    }
+
+    if (sourceLength == (size_t)-1)
+    {
+        sourceLength = length(source);
+    }
+    else
+    {
+        sourceLength = length(source, sourceLength);
+    }
+
+    const U *source_end = source + sourceLength;
+
+    // We need to leave room for the null terminator.
+    size_t copy_size = 0;
+    while (source < source_end)
+    {
+        const U *next = source;
+        uchar32_t ch = nextchar(next, source_end, sourceEncoding);
+
+        if (next == source)
         {
-            // Write the character.
-            char_width = writechar(dest, ch);
+            break;
         }
-        else
+
+        // writechar() only measures the character when it's given a NULL destination.
+        T *temp = NULL;
+        size_t char_width = writechar(temp, ch);
+
+        if (dest != NULL)
         {
-            // Our destination is NULL, so all we need to do is grab the width of the character.
-            // If this returns 0, we can safely assume that writechar() will write the replacement
-            // character.
-            char_width = charwidth<T>(ch);
-            if (char_width == 0)
+            if (char_width > destSize - 1 - copy_size)
             {
-                char_width = charwidth<T>(UNI_REPLACEMENT_CHAR);
+                break;
             }
+
+            temp = dest + copy_size;
+            writechar(temp, ch);
         }
 
-        // Now increment our copy size.
         copy_size += char_width;
+        source     = next;
+    }
 
-        destSize -= char_width;
-        sourceLength -= char_width;
+    if (dest != NULL)
+    {
+        dest[copy_size] = '\0';
     }
 
-    // NULL terminate the destination.
+    return copy_size + 1;
+}
+
+/**
+*   \brief  Copies an ASCII string. Every code unit is a character, so nothing needs to be decoded or encoded.
+*
+*   \remarks
+*       A code unit of 0x80 or above isn't ASCII. It ends the copy, the same way an invalid character
+*       does with the other tags.
+*/
+template <typename T, typename U>
+inline size_t copy(T *dest, const U *source, size_t destSize, size_t sourceLength, ascii_t)
+{
+    if (source == NULL || destSize == 0)
+    {
+        return 0;
+    }
+
+    // The null terminator is below 0x80, so this finds the length of the string at the same time.
+    size_t ascii_length = 0;
+    while (ascii_length < sourceLength)
+    {
+        uchar32_t ch = _encoding_unit(source[ascii_length]);
+        if (ch == '\0' || ch >= 0x80)
+        {
+            break;
+        }
+
+        ++ascii_length;
+    }
+
+    sourceLength = ascii_length;
+
     if (dest != NULL)
     {
-        *dest = '\0';
+        if (sourceLength > destSize - 1)
+        {
+            sourceLength = destSize - 1;
+        }
+
+        for (size_t i = 0; i < sourceLength; ++i)
+        {
+            dest[i] = static_cast<T>(_encoding_unit(source[i]));
+        }
+
+        dest[sourceLength] = '\0';
+    }
+
+    return sourceLength + 1;
+}
+
+
+/**
+*   \brief  Copies the string between two pointers when no conversion is needed.
+*/
+template <typename T>
+inline size_t _copy_span(T *dest, const T *source, const T *sourceEnd, size_t destSize)
+{
+    size_t copy_size = sourceEnd - source;
+
+    if (dest != NULL)
+    {
+        if (copy_size > destSize)
+        {
+            copy_size = destSize;
+        }
+
+        ::memcpy(dest, source, copy_size * sizeof(T));
     }
 
     return copy_size;
 }
 
+/**
+*   \brief  Converts the string between two pointers, including any null characters inside it.
+*/
+template <typename T, typename U>
+inline size_t _copy_span(T *dest, const U *source, const U *sourceEnd, size_t destSize)
+{
+    size_t copy_size = 0;
+    for (;;)
+    {
+        copy_size += transcode((dest != NULL) ? dest + copy_size : NULL, (destSize != (size_t)-1) ? destSize - copy_size : destSize, source, sourceEnd);
+
+        // The transcoders stop at null characters, but here they are part of the string. A null
+        // character is a single T in every encoding, so we can write it ourselves and keep going.
+        if (source >= sourceEnd || *source != '\0' || (dest != NULL && copy_size == destSize))
+        {
+            break;
+        }
+
+        if (dest != NULL)
+        {
+            dest[copy_size] = '\0';
+        }
+
+        ++copy_size;
+        ++source;
+    }
+
+    return copy_size;
+}
 
+/**
+*   \brief                  Copies a reference string over to another string.
+*   \param  dest      [out] The destination buffer.
+*   \param  source    [in]  The source string.
+*   \param  destSize  [in]  The size of the destination buffer in T's.
+*   \return                 The number of T's that are copied to the destination.
+*
+*   \remarks
+*       This works like copy(T *, const U *, size_t, size_t), except that the referenced string does
+*       not need to be null terminated. Nothing at or past the end of the reference string is read, and
+*       null characters inside the reference string are copied like any other character.
+*       \par
+*       The resulting string is always null terminated.
+*/
 template <typename T, typename U>
 inline size_t copy(T *dest, const reference_string<U> &source, size_t destSize = -1)
 {
-    return copy(dest, source.start, destSize, length(source));
+    if (source.start == NULL || destSize == 0)
+    {
+        return 0;
+    }
+
+    // We need to leave room for the null terminator, unless the size is unknown.
+    size_t copy_size = _copy_span(dest, (const U *)source.start, (const U *)source.end, (destSize != (size_t)-1) ? destSize - 1 : destSize);
+
+    if (dest != NULL)
+    {
+        dest[copy_size] = '\0';
+    }
+
+    return copy_size + 1;
 }
 
 }
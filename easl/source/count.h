@@ -0,0 +1,182 @@
+/**
+*   \file   count.h
+*   \author Dave Reid
+*   \brief  Header file for count() implementations.
+*/
+#ifndef __EASL_COUNT_H_
+#define __EASL_COUNT_H_
+
+#include <assert.h>
+#include "_simd.h"
+#include "searcher.h"
+#include "length.h"
+#include "reference_string.h"
+
+namespace easl
+{
+
+/**
+*   \brief               Counts the occurances of a code unit between two pointers.
+*   \param  str    [in]  Pointer to the start of the string to search.
+*   \param  strEnd [in]  Pointer to the end of the string to search.
+*   \param  unit   [in]  The code unit to count.
+*   \return              The number of times the code unit occurs.
+*
+*   \remarks
+*       With SSE2, a whole register of code units is compared at once and the matches are counted from
+*       the mask, so the string is never branched on per occurance.
+*/
+template <typename T>
+inline size_t _count_unit(const T *str, const T *strEnd, T unit)
+{
+    size_t result = 0;
+
+#if defined(EASL_SIMD_SSE2)
+    if (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)
+    {
+        const size_t  width  = sizeof(T);
+        const size_t  block  = 16 / width;
+        const __m128i needle = _searcher_broadcast(static_cast<uchar32_t>(unit), width);
+
+        while (static_cast<size_t>(strEnd - str) >= block)
+        {
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+                _searcher_cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i *>(str)), needle, width)));
+
+            // Each matching code unit sets one bit per byte.
+            result += _popcount(mask) / width;
+            str    += block;
+        }
+    }
+#endif
+
+    for ( ; str < strEnd; ++str)
+    {
+        if (*str == unit)
+        {
+            ++result;
+        }
+    }
+
+    return result;
+}
+
+/**
+*   \brief                 Counts the occurances of a prepared pattern between two pointers.
+*   \param  str       [in] Pointer to the start of the string to search.
+*   \param  strEnd    [in] Pointer to the end of the string to search.
+*   \param  pattern   [in] The pattern to count.
+*   \return                The number of non-overlapping occurances of the pattern.
+*
+*   \remarks
+*       A single code unit pattern, such as an ASCII character or a line feed, is counted with
+*       _count_unit(). Anything longer is found one occurance at a time with the searcher.
+*/
+template <typename T>
+inline size_t _count_span(const T *str, const T *strEnd, const searcher<T> &pattern)
+{
+    size_t pattern_length = pattern.length();
+    if (pattern_length == 0)
+    {
+        return 0;
+    }
+
+    if (pattern_length == 1)
+    {
+        return _count_unit(str, strEnd, *pattern.pattern());
+    }
+
+    size_t result = 0;
+
+    const T *found;
+    while ((found = pattern.find(str, strEnd)) != NULL)
+    {
+        ++result;
+        str = found + pattern_length;
+    }
+
+    return result;
+}
+
+
+/**
+*   \brief                 Counts the occurances of a prepared pattern inside a string.
+*   \param  str       [in] The string to be scanned.
+*   \param  pattern   [in] The pattern to count.
+*   \param  strLength [in] The length in T's of the string to be scanned, not including the null terminator.
+*   \return                The number of non-overlapping occurances of the pattern.
+*
+*   \remarks
+*       The string ends at its first null character. Occurances don't overlap, so "aa" occurs twice in
+*       "aaaaa", the same as iterating over findall(). An empty pattern occurs zero times.
+*       \par
+*       Nothing is allocated.
+*/
+template <typename T, typename U>
+inline size_t count(const T *str, const searcher<U> &pattern, size_t strLength = -1)
+{
+    assert(str != NULL);
+
+    const U *str_start = (const U *)str;
+    const U *str_end   = str_start + ((strLength == (size_t)-1) ? length(str_start) : length(str_start, strLength));
+
+    return _count_span(str_start, str_end, pattern);
+}
+
+/**
+*   \brief                 Counts the occurances of a prepared pattern inside a reference string.
+*   \param  str       [in] The string to be scanned.
+*   \param  pattern   [in] The pattern to count.
+*   \return                The number of non-overlapping occurances of the pattern.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read.
+*/
+template <typename T, typename U>
+inline size_t count(const reference_string<T> &str, const searcher<U> &pattern)
+{
+    return _count_span((const U *)str.start, (const U *)str.end, pattern);
+}
+
+/**
+*   \brief                  Counts the occurances of a string inside another string.
+*   \param  str1       [in] The string to be scanned.
+*   \param  str2       [in] The string to count.
+*   \param  str1Length [in] The length in T's of the first string, not including the null terminator.
+*   \param  str2Length [in] The length in T's of the second string, not including the null terminator.
+*   \return                 The number of non-overlapping occurances of \c str2.
+*
+*   \remarks
+*       This builds a searcher for \c str2 once and uses it for every occurance. When the same string is
+*       counted in many strings, construct a searcher once and use count(const T *, const searcher<U> &, size_t)
+*       instead.
+*/
+template <typename T>
+inline size_t count(const T *str1, const T *str2, size_t str1Length = -1, size_t str2Length = -1)
+{
+    assert(str1 != NULL);
+    assert(str2 != NULL);
+
+    return count(str1, searcher<T>(str2, str2Length), str1Length);
+}
+
+/**
+*   \brief                  Counts the occurances of a reference string inside another reference string.
+*   \param  str1       [in] The string to be scanned.
+*   \param  str2       [in] The string to count.
+*   \return                 The number of non-overlapping occurances of \c str2.
+*
+*   \remarks
+*       Neither string needs to be null terminated. Nothing at or past the end of either string is read.
+*/
+template <typename T>
+inline size_t count(const reference_string<T> &str1, const reference_string<T> &str2)
+{
+    return count(str1, searcher<T>(str2.start, str2.end - str2.start));
+}
+
+
+}
+
+#endif // __EASL_COUNT_H_
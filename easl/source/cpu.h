@@ -0,0 +1,206 @@
+/**
+*   \file   cpu.h
+*   \author Dave Reid
+*   \brief  Header file for runtime CPU feature detection.
+*
+*   The vectorised kernels are picked at runtime based on what the CPU supports. This lets a
+*   single build use AVX2 on the machines that have it while still running on plain x86-64.
+*   See EASL_SIMD_DISPATCH in setup.h.
+*/
+#ifndef __EASL_CPU_H_
+#define __EASL_CPU_H_
+
+#include "setup.h"
+
+#if defined(EASL_SIMD_DISPATCH)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__)
+#include <cpuid.h>
+#endif
+#endif
+
+namespace easl
+{
+
+// The instruction sets that cpu_features() can report.
+#define EASL_CPU_SSE2           0x00000001
+#define EASL_CPU_SSSE3          0x00000002
+#define EASL_CPU_SSE42          0x00000004
+#define EASL_CPU_AVX2           0x00000008
+#define EASL_CPU_AVX512BW       0x00000010
+
+
+// The instruction sets that the compiler has been told it may use everywhere. These are never
+// checked at runtime.
+#if defined(EASL_SIMD_SSE2)
+#define EASL_CPU_STATIC_SSE2        EASL_CPU_SSE2
+#else
+#define EASL_CPU_STATIC_SSE2        0
+#endif
+
+#if defined(EASL_SIMD_SSSE3)
+#define EASL_CPU_STATIC_SSSE3       EASL_CPU_SSSE3
+#else
+#define EASL_CPU_STATIC_SSSE3       0
+#endif
+
+#if defined(EASL_SIMD_SSE42)
+#define EASL_CPU_STATIC_SSE42       EASL_CPU_SSE42
+#else
+#define EASL_CPU_STATIC_SSE42       0
+#endif
+
+#if defined(EASL_SIMD_AVX2)
+#define EASL_CPU_STATIC_AVX2        EASL_CPU_AVX2
+#else
+#define EASL_CPU_STATIC_AVX2        0
+#endif
+
+#if defined(EASL_SIMD_AVX512BW)
+#define EASL_CPU_STATIC_AVX512BW    EASL_CPU_AVX512BW
+#else
+#define EASL_CPU_STATIC_AVX512BW    0
+#endif
+
+#define EASL_CPU_STATIC     (EASL_CPU_STATIC_SSE2 | EASL_CPU_STATIC_SSSE3 | EASL_CPU_STATIC_SSE42 | EASL_CPU_STATIC_AVX2 | EASL_CPU_STATIC_AVX512BW)
+
+
+#if defined(EASL_SIMD_DISPATCH)
+/**
+*   \brief                 Executes the cpuid instruction.
+*   \param  leaf      [in]  The leaf to query.
+*   \param  subleaf   [in]  The sub-leaf to query.
+*   \param  registers [out] Receives eax, ebx, ecx and edx, in that order.
+*/
+inline void _cpuid(unsigned int leaf, unsigned int subleaf, unsigned int registers[4])
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+
+    registers[0] = static_cast<unsigned int>(info[0]);
+    registers[1] = static_cast<unsigned int>(info[1]);
+    registers[2] = static_cast<unsigned int>(info[2]);
+    registers[3] = static_cast<unsigned int>(info[3]);
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+/**
+*   \brief  Retrieves the state components that the operating system saves on a context switch.
+*
+*   \remarks
+*       This can only be called when cpuid reports OSXSAVE.
+*/
+inline unsigned int _xgetbv0()
+{
+#if defined(_MSC_VER)
+    return static_cast<unsigned int>(_xgetbv(0));
+#else
+    unsigned int eax;
+    unsigned int edx;
+    __asm__ __volatile__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+
+    return eax;
+#endif
+}
+
+/**
+*   \brief  Checks the CPU and the operating system for the instruction sets we can use.
+*   \return The EASL_CPU_* flags of every supported instruction set.
+*/
+inline unsigned int _detect_cpu_features()
+{
+    unsigned int features = 0;
+    unsigned int registers[4];
+
+    _cpuid(0, 0, registers);
+    unsigned int max_leaf = registers[0];
+
+    if (max_leaf < 1)
+    {
+        return features;
+    }
+
+    _cpuid(1, 0, registers);
+    if (registers[3] & (1 << 26))
+    {
+        features |= EASL_CPU_SSE2;
+    }
+
+    if (registers[2] & (1 << 9))
+    {
+        features |= EASL_CPU_SSSE3;
+    }
+
+    if (registers[2] & (1 << 20))
+    {
+        features |= EASL_CPU_SSE42;
+    }
+
+    // The AVX registers can only be used when the operating system saves them, which it tells us
+    // through XCR0. AVX-512 needs the opmask and upper ZMM registers as well.
+    if ((registers[2] & (1 << 27)) == 0 || (registers[2] & (1 << 28)) == 0 || max_leaf < 7)
+    {
+        return features;
+    }
+
+    unsigned int xcr0 = _xgetbv0();
+    if ((xcr0 & 0x06) != 0x06)
+    {
+        return features;
+    }
+
+    _cpuid(7, 0, registers);
+    if (registers[1] & (1 << 5))
+    {
+        features |= EASL_CPU_AVX2;
+    }
+
+    if ((xcr0 & 0xE0) == 0xE0 && (registers[1] & (1 << 16)) && (registers[1] & (1 << 30)))
+    {
+        features |= EASL_CPU_AVX512BW;
+    }
+
+    return features;
+}
+#endif
+
+/**
+*   \brief  Retrieves the instruction sets that the vectorised kernels can use.
+*   \return The EASL_CPU_* flags of every supported instruction set.
+*
+*   \remarks
+*       The CPU is only checked the first time this function is called. After that, the result is
+*       reused. The instruction sets that are enabled at compile time are always included.
+*/
+inline unsigned int cpu_features()
+{
+#if defined(EASL_SIMD_DISPATCH)
+    static const unsigned int features = _detect_cpu_features() | EASL_CPU_STATIC;
+    return features;
+#else
+    return EASL_CPU_STATIC;
+#endif
+}
+
+/**
+*   \brief                Determines if the CPU supports a set of instruction sets.
+*   \param  features [in] The EASL_CPU_* flags to check.
+*   \return               True if every instruction set in \c features is supported; false otherwise.
+*
+*   \remarks
+*       Instruction sets that are enabled at compile time are resolved without calling cpu_features(),
+*       so the check is free when the program is built for the target CPU.
+*/
+inline bool cpu_supports(unsigned int features)
+{
+    return (EASL_CPU_STATIC & features) == features || (cpu_features() & features) == features;
+}
+
+
+}
+
+#endif // __EASL_CPU_H_
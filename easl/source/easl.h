@@ -17,14 +17,25 @@
 #include "append.h"
 #include "appendsize.h"
 #include "findfirst.h"
+#include "searcher.h"
 #include "findfirstof.h"
+#include "findfirstnocase.h"
+#include "findlast.h"
+#include "findlastof.h"
+#include "findall.h"
+#include "count.h"
+#include "charset.h"
 #include "charcount.h"
 #include "compare.h"
+#include "comparenocase.h"
+#include "casefold.h"
 #include "getbom.h"
 #include "getchar.h"
 #include "charwidth.h"
 #include "length.h"
 #include "nextchar.h"
+#include "prevchar.h"
+#include "encoding.h"
 #include "removebom.h"
 #include "skipbom.h"
 #include "tostring.h"
@@ -38,5 +49,13 @@
 #include "istype.h"
 #include "replace.h"
 #include "split.h"
+#include "validate.h"
+#include "transcode.h"
+#include "allocator.h"
+#include "charindex.h"
+#include "cpu.h"
+#include "literal.h"
+#include "containsonlyascii.h"
+#include "parallel.h"
 
 #endif // __EASL_H_
@@ -0,0 +1,421 @@
+/**
+*   \file   encoding.h
+*   \author Dave Reid
+*   \brief  Header file for the encoding tags.
+*
+*   Normally, the encoding of a string is picked by the type of its code units and the way it is
+*   decoded is picked for the whole build by EASL_ONLY_ASCII and EASL_OPTION_TRUSTED_UTF8. An
+*   encoding tag lets a single call site say what it knows about its string instead:
+*
+*   \code
+*   // The keys were checked when the file was loaded, so there's no need to check them again.
+*   easl::findfirst(key, '=', keyLength, easl::utf8_trusted_t());
+*   \endcode
+*
+*   nextchar(), copy(), findfirst(), compare(), split() and tokens::nexttoken() all have overloads
+*   that take a tag as their last parameter.
+*/
+#ifndef __EASL_ENCODING_H_
+#define __EASL_ENCODING_H_
+
+#include "nextchar.h"
+
+namespace easl
+{
+
+// The encodings that a tag can describe.
+#define EASL_ENCODING_NATIVE    0
+#define EASL_ENCODING_ASCII     1
+#define EASL_ENCODING_UTF8      2
+#define EASL_ENCODING_UTF16     3
+#define EASL_ENCODING_UTF32     4
+
+
+/**
+*   \brief  Tag describing the encoding of a string and whether or not it needs to be checked for errors.
+*
+*   A strict tag checks every character. An invalid character is returned as 0 and the string is not
+*   moved past it, the same way the plain nextchar() handles errors. A trusted tag skips the checks,
+*   so the results are undefined if the string is not valid. The string still ends at a null
+*   terminator, or at the end pointer for bounded strings, either way.
+*/
+template <int Encoding, bool Strict>
+struct encoding_tag
+{
+    static const int  encoding = Encoding;
+    static const bool strict   = Strict;
+};
+
+/// The encoding picked by the type of the code units, decoded the same way as the plain nextchar().
+typedef encoding_tag<EASL_ENCODING_NATIVE, false> native_t;
+
+/// Every code unit is a character below 0x80. This can be used with any type of code unit.
+typedef encoding_tag<EASL_ENCODING_ASCII, false> ascii_t;
+
+/// UTF-8 that has already been checked, with validate_utf8() for example.
+typedef encoding_tag<EASL_ENCODING_UTF8, false> utf8_trusted_t;
+
+/// UTF-8 from an unknown source.
+typedef encoding_tag<EASL_ENCODING_UTF8, true> utf8_strict_t;
+
+/// UTF-16 that has already been checked.
+typedef encoding_tag<EASL_ENCODING_UTF16, false> utf16_trusted_t;
+
+/// UTF-16 from an unknown source. Unpaired surrogates are errors.
+typedef encoding_tag<EASL_ENCODING_UTF16, true> utf16_strict_t;
+
+/// UTF-32 that has already been checked.
+typedef encoding_tag<EASL_ENCODING_UTF32, false> utf32_trusted_t;
+
+/// UTF-32 from an unknown source. Surrogates and characters above U+10FFFF are errors.
+typedef encoding_tag<EASL_ENCODING_UTF32, true> utf32_strict_t;
+
+
+/**
+*   \brief  Only defined for true. Used to make sure a tag is used with code units of the right size.
+*/
+template <bool Condition>
+struct _encoding_check;
+
+template <>
+struct _encoding_check<true>
+{
+};
+
+/**
+*   \brief           Retrieves a code unit as an unsigned value.
+*   \param  ch [in]  The code unit.
+*
+*   \remarks
+*       Only the low 32 bits of the code unit are kept, since char32_t is wider than that on some
+*       platforms when it's a typedef.
+*/
+template <typename T>
+inline uchar32_t _encoding_unit(T ch)
+{
+    switch (sizeof(T))
+    {
+    case 1:  return static_cast<unsigned char>(ch);
+    case 2:  return static_cast<uchar16_t>(ch);
+    default: return static_cast<uchar32_t>(static_cast<unsigned int>(ch));
+    }
+}
+
+
+/**
+*   \brief  The decoders behind each tag. Only the tags above are defined.
+*
+*   Each specialisation has a decode() for null terminated strings and one for strings that end at a
+*   pointer. These work the same way as nextchar(const T *&) and nextchar(const T *&, const T *).
+*/
+template <typename Tag>
+struct _encoding;
+
+template <>
+struct _encoding<native_t>
+{
+    template <typename T>
+    static uchar32_t decode(const T *&str)
+    {
+        return nextchar(str);
+    }
+
+    template <typename T>
+    static uchar32_t decode(const T *&str, const T *strEnd)
+    {
+        return nextchar(str, strEnd);
+    }
+};
+
+template <>
+struct _encoding<ascii_t>
+{
+    template <typename T>
+    static uchar32_t decode(const T *&str)
+    {
+        assert(str != NULL);
+
+        uchar32_t ch = _encoding_unit(*str);
+        if (ch != 0)
+        {
+            ++str;
+        }
+
+        return ch;
+    }
+
+    template <typename T>
+    static uchar32_t decode(const T *&str, const T *strEnd)
+    {
+        assert(str != NULL);
+
+        if (str >= strEnd)
+        {
+            return 0;
+        }
+
+        return _encoding_unit(*str++);
+    }
+};
+
+template <>
+struct _encoding<utf8_trusted_t>
+{
+    template <typename T>
+    static uchar32_t decode(const T *&str)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) == 1>);
+        return nextchar_utf8_trusted((const char *&)str);
+    }
+
+    template <typename T>
+    static uchar32_t decode(const T *&str, const T *strEnd)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) == 1>);
+        return nextchar_utf8_trusted((const char *&)str, (const char *)strEnd);
+    }
+};
+
+template <>
+struct _encoding<utf8_strict_t>
+{
+    template <typename T>
+    static uchar32_t decode(const T *&str)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) == 1>);
+        return nextchar_utf8_strict((const char *&)str);
+    }
+
+    template <typename T>
+    static uchar32_t decode(const T *&str, const T *strEnd)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) == 1>);
+        return nextchar_utf8_strict((const char *&)str, (const char *)strEnd);
+    }
+};
+
+template <>
+struct _encoding<utf16_trusted_t>
+{
+    template <typename T>
+    static uchar32_t decode(const T *&str)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) == 2>);
+        assert(str != NULL);
+
+        uchar32_t ch = _encoding_unit(*str);
+        if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_HIGH_END)
+        {
+            ch = ((ch - UNI_SUR_HIGH_START) << UNI_HALF_SHIFT) + (_encoding_unit(str[1]) - UNI_SUR_LOW_START) + UNI_HALF_BASE;
+            str += 2;
+        }
+        else if (ch != 0)
+        {
+            ++str;
+        }
+
+        return ch;
+    }
+
+    template <typename T>
+    static uchar32_t decode(const T *&str, const T *strEnd)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) == 2>);
+        assert(str != NULL);
+
+        if (str >= strEnd)
+        {
+            return 0;
+        }
+
+        uchar32_t ch = _encoding_unit(*str);
+        if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_HIGH_END)
+        {
+            // The pair still needs to fit before the end of the string.
+            if (strEnd - str < 2)
+            {
+                return 0;
+            }
+
+            ch = ((ch - UNI_SUR_HIGH_START) << UNI_HALF_SHIFT) + (_encoding_unit(str[1]) - UNI_SUR_LOW_START) + UNI_HALF_BASE;
+            str += 2;
+        }
+        else
+        {
+            ++str;
+        }
+
+        return ch;
+    }
+};
+
+template <>
+struct _encoding<utf16_strict_t>
+{
+    template <typename T>
+    static uchar32_t decode(const T *&str)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) == 2>);
+        assert(str != NULL);
+
+        uchar32_t ch = _encoding_unit(*str);
+        if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_LOW_END)
+        {
+            // A null terminator is not a low surrogate, so this never reads past it.
+            uchar32_t ch2 = _encoding_unit(str[1]);
+            if (ch > UNI_SUR_HIGH_END || ch2 < UNI_SUR_LOW_START || ch2 > UNI_SUR_LOW_END)
+            {
+                return 0;
+            }
+
+            str += 2;
+            return ((ch - UNI_SUR_HIGH_START) << UNI_HALF_SHIFT) + (ch2 - UNI_SUR_LOW_START) + UNI_HALF_BASE;
+        }
+
+        if (ch != 0)
+        {
+            ++str;
+        }
+
+        return ch;
+    }
+
+    template <typename T>
+    static uchar32_t decode(const T *&str, const T *strEnd)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) == 2>);
+        assert(str != NULL);
+
+        if (str >= strEnd)
+        {
+            return 0;
+        }
+
+        uchar32_t ch = _encoding_unit(*str);
+        if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_LOW_END)
+        {
+            if (ch > UNI_SUR_HIGH_END || strEnd - str < 2)
+            {
+                return 0;
+            }
+
+            uchar32_t ch2 = _encoding_unit(str[1]);
+            if (ch2 < UNI_SUR_LOW_START || ch2 > UNI_SUR_LOW_END)
+            {
+                return 0;
+            }
+
+            str += 2;
+            return ((ch - UNI_SUR_HIGH_START) << UNI_HALF_SHIFT) + (ch2 - UNI_SUR_LOW_START) + UNI_HALF_BASE;
+        }
+
+        ++str;
+        return ch;
+    }
+};
+
+template <>
+struct _encoding<utf32_trusted_t>
+{
+    template <typename T>
+    static uchar32_t decode(const T *&str)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) >= 4>);
+        return _encoding<ascii_t>::decode(str);
+    }
+
+    template <typename T>
+    static uchar32_t decode(const T *&str, const T *strEnd)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) >= 4>);
+        return _encoding<ascii_t>::decode(str, strEnd);
+    }
+};
+
+template <>
+struct _encoding<utf32_strict_t>
+{
+    template <typename T>
+    static uchar32_t decode(const T *&str)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) >= 4>);
+        assert(str != NULL);
+
+        uchar32_t ch = _encoding_unit(*str);
+        if (ch > UNI_MAX_LEGAL_UTF32 || (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_LOW_END))
+        {
+            return 0;
+        }
+
+        if (ch != 0)
+        {
+            ++str;
+        }
+
+        return ch;
+    }
+
+    template <typename T>
+    static uchar32_t decode(const T *&str, const T *strEnd)
+    {
+        (void)sizeof(_encoding_check<sizeof(T) >= 4>);
+        assert(str != NULL);
+
+        if (str >= strEnd)
+        {
+            return 0;
+        }
+
+        uchar32_t ch = _encoding_unit(*str);
+        if (ch > UNI_MAX_LEGAL_UTF32 || (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_LOW_END))
+        {
+            return 0;
+        }
+
+        ++str;
+        return ch;
+    }
+};
+
+
+/**
+*   \brief                  Retrieves the next character in a string using the decoder picked by a tag.
+*   \param  str   [in, out] Pointer to the string to retrieve the character from.
+*   \param  tag   [in]      The encoding tag. Only its type is used.
+*   \return                 The character that was being pointed to by \c str.
+*
+*   \remarks
+*       This works like nextchar(T *&), except that the decoder is picked by the tag instead of by T.
+*       The UTF tags need code units of the right size: 1 byte for UTF-8, 2 for UTF-16 and at least
+*       4 for UTF-32. Anything else is a compile error.
+*/
+template <typename T, int Encoding, bool Strict>
+inline uchar32_t nextchar(T *&str, encoding_tag<Encoding, Strict> tag)
+{
+    (void)tag;
+    return _encoding<encoding_tag<Encoding, Strict> >::decode((const T *&)str);
+}
+
+/**
+*   \brief                   Retrieves the next character in a string without reading past the end of the string, using the decoder picked by a tag.
+*   \param  str    [in, out] Pointer to the string to retrieve the character from.
+*   \param  strEnd [in]      Pointer to the end of the string.
+*   \param  tag    [in]      The encoding tag. Only its type is used.
+*   \return                  The character that was being pointed to by \c str.
+*
+*   \remarks
+*       This works like nextchar(T *&, const T *), except that the decoder is picked by the tag instead of by T.
+*       \c strEnd is given its own type so that a const end pointer can be used with a non-const string, and
+*       the other way around. It must point into the same string.
+*/
+template <typename T, typename U, int Encoding, bool Strict>
+inline uchar32_t nextchar(T *&str, U *strEnd, encoding_tag<Encoding, Strict> tag)
+{
+    (void)tag;
+    return _encoding<encoding_tag<Encoding, Strict> >::decode((const T *&)str, (const T *)strEnd);
+}
+
+
+}
+
+#endif // __EASL_ENCODING_H_
@@ -6,13 +6,185 @@
 #ifndef __EASL_EQUAL_H_
 #define __EASL_EQUAL_H_
 
+#include <string.h>
+#include <wchar.h>
 #include "types.h"
-#include "charcount.h"
-#include <cctype>
+#include "length.h"
+#include "nextchar.h"
+#include "transcode.h"
+#include "literal.h"
+#include "comparenocase.h"
 
 namespace easl
 {
 
+/**
+*   \brief                  Determines if two strings with the same encoding are equal, where the length of the first is known.
+*   \param  str1       [in] The first string to compare.
+*   \param  str2       [in] The second string to compare. This must be null terminated.
+*   \param  str1Length [in] The length in T's of the first string.
+*
+*   \remarks
+*       The second string is checked for a null terminator one block at a time and each block is compared
+*       straight away, so \c str2 is never read past its null terminator and a difference near the start
+*       is found without looking at the rest of the string.
+*/
+template <typename T, typename U>
+inline bool _equal_units(const T *str1, const U *str2, size_t str1Length)
+{
+    const size_t block = 256;
+
+    for (;;)
+    {
+        size_t count = (str1Length < block) ? str1Length : block;
+        if (length(str2, count) != count || ::memcmp(str1, str2, count * sizeof(T)) != 0)
+        {
+            return false;
+        }
+
+        str1       += count;
+        str2       += count;
+        str1Length -= count;
+
+        if (str1Length == 0)
+        {
+            return *str2 == '\0';
+        }
+    }
+}
+
+/**
+*   \brief                  Determines if two strings with the same encoding are equal.
+*   \param  str1       [in] The first string to compare.
+*   \param  str2       [in] The second string to compare.
+*   \param  str1Length [in] The length in T's of the first string, or -1 if it is null terminated.
+*   \param  str2Length [in] The length in U's of the second string, or -1 if it is null terminated.
+*
+*   \remarks
+*       T and U must be the same size. The code units are compared directly, so neither string is decoded.
+*/
+template <typename T, typename U>
+inline bool _equal_same_encoding(const T *str1, const U *str2, size_t str1Length, size_t str2Length)
+{
+    if (str1Length != (size_t)-1 && str2Length != (size_t)-1)
+    {
+        return str1Length == str2Length && ::memcmp(str1, str2, str1Length * sizeof(T)) == 0;
+    }
+
+    if (str1Length != (size_t)-1)
+    {
+        return _equal_units(str1, str2, str1Length);
+    }
+
+    if (str2Length != (size_t)-1)
+    {
+        return _equal_units(str2, str1, str2Length);
+    }
+
+    // Optimized cases.
+    if (sizeof(T) == sizeof(char))
+    {
+        return ::strcmp(reinterpret_cast<const char *>(str1), reinterpret_cast<const char *>(str2)) == 0;
+    }
+
+    if (sizeof(T) == sizeof(wchar_t))
+    {
+        return ::wcscmp(reinterpret_cast<const wchar_t *>(str1), reinterpret_cast<const wchar_t *>(str2)) == 0;
+    }
+
+    for ( ; static_cast<T>(*str2) == *str1; ++str1, ++str2)
+    {
+        if (*str1 == '\0')
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+*   \brief                  Determines if two strings are equal by decoding them one character at a time.
+*   \param  str1       [in] Pointer to the start of the first string.
+*   \param  str1End    [in] Pointer to the end of the first string.
+*   \param  str2       [in] Pointer to the start of the second string.
+*   \param  str2End    [in] Pointer to the end of the second string.
+*
+*   \remarks
+*       A character that can't be decoded in either string makes the strings unequal.
+*/
+template <typename T, typename U>
+inline bool _equal_decoded(const T *str1, const T *str1End, const U *str2, const U *str2End)
+{
+    while (str1 < str1End && str2 < str2End)
+    {
+        const T *start1 = str1;
+        const U *start2 = str2;
+
+        uchar32_t ch1 = nextchar(str1, str1End);
+        uchar32_t ch2 = nextchar(str2, str2End);
+
+        if (str1 == start1 || str2 == start2 || ch1 != ch2)
+        {
+            return false;
+        }
+    }
+
+    return str1 == str1End && str2 == str2End;
+}
+
+/**
+*   \brief                  Determines if a UTF-8 string is equal to a UTF-16 or UTF-32 string.
+*   \param  str1       [in] Pointer to the start of the UTF-8 string.
+*   \param  str1End    [in] Pointer to the end of the UTF-8 string.
+*   \param  str2       [in] Pointer to the start of the other string.
+*   \param  str2End    [in] Pointer to the end of the other string.
+*
+*   \remarks
+*       The UTF-8 string is converted to the encoding of the other string a block at a time with transcode(),
+*       and each block is compared to the other string with memcmp(). Wherever transcode() stops without
+*       converting anything, such as at a null character or an invalid sequence, one character is compared
+*       at a time instead.
+*/
+template <typename T>
+inline bool _equal_transcoded(const char *str1, const char *str1End, const T *str2, const T *str2End)
+{
+    const size_t block = 64;
+    T buffer[block];
+
+    while (str1 < str1End)
+    {
+        size_t remaining = str2End - str2;
+        size_t count     = transcode(buffer, (remaining < block) ? remaining : block, str1, str1End);
+
+        if (count == 0)
+        {
+            const char *start1 = str1;
+            const T    *start2 = str2;
+
+            uchar32_t ch1 = nextchar(str1, str1End);
+            uchar32_t ch2 = nextchar(str2, str2End);
+
+            if (str1 == start1 || str2 == start2 || ch1 != ch2)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (::memcmp(buffer, str2, count * sizeof(T)) != 0)
+            {
+                return false;
+            }
+
+            str2 += count;
+        }
+    }
+
+    return str2 == str2End;
+}
+
+
 /**
 *   \brief                     Determines if two strings are equal.
 *   \param  str1          [in] The first string to compare.
@@ -23,9 +195,17 @@ namespace easl
 *   \return                    True if the two strings are equal; false otherwise.
 *
 *   \remarks
-*       Both strings must be NULL terminated. By default, the comparison is case sensitive.
+*       A string without a length must be null terminated. A string with a length is that many T's long,
+*       so a null character inside it is compared like any other character. By default, the comparison
+*       is case sensitive. A case insensitive comparison compares the simple case folding of each
+*       character (see casefold()), the same as comparenocase(), but with the same rule for lengths as
+*       a case sensitive comparison rather than stopping at the first null character.
+*       \par
+*       Strings with the same encoding are compared code unit by code unit without being decoded, with
+*       memcmp() when both lengths are known. A UTF-8 string is compared to a UTF-16 or UTF-32 string by
+*       converting it a block at a time. Either way, each string is only looked at once, apart from finding
+*       the end of a null terminated string when the encodings are different.
 */
-// TODO: Should implement a T-only optimization. We can remove the charcount() checks at the very least.
 template <typename T, typename U>
 inline bool equal(const T *str1, const U *str2, bool caseSensitive = true, size_t str1Length = -1, size_t str2Length = -1)
 {
@@ -34,51 +214,30 @@ inline bool equal(const T *str1, const U *str2, bool caseSensitive = true, size_
         return false;
     }
 
-    // If the number of characters in the strings are different, they are not equal.
-    // NOTE: This should probably be optimised out.
-    if (charcount(str1, str1Length) != charcount(str2, str2Length))
+    if (caseSensitive && sizeof(T) == sizeof(U))
     {
-        return false;
+        return _equal_same_encoding(str1, str2, str1Length, str2Length);
     }
 
-    // We need to grab the first characters first.
-    uchar32_t ch1 = nextchar(str1);
-    uchar32_t ch2 = nextchar(str2);
+    const T *str1_end = str1 + ((str1Length == (size_t)-1) ? length(str1) : str1Length);
+    const U *str2_end = str2 + ((str2Length == (size_t)-1) ? length(str2) : str2Length);
 
-    if (caseSensitive)
+    if (!caseSensitive)
     {
-        while ((str1Length > 0 && ch1 != '\0') && (str2Length > 0 && ch2 != '\0'))
-        {
-            if (ch1 != ch2)
-            {
-                return false;
-            }
-
-            ch1 = nextchar(str1);
-            ch2 = nextchar(str2);
-
-            str1Length -= charwidth<T>(ch1);
-            str2Length -= charwidth<U>(ch2);
-        }
+        return _compare_nocase(str1, str1_end, str2, str2_end) == 0;
     }
-    else
-    {
-        while ((str1Length > 0 && ch1 != '\0') && (str2Length > 0 && ch2 != '\0'))
-        {
-            if (tolower(ch1) != tolower(ch2))
-		    {
-			    return false;
-		    }
 
-            ch1 = nextchar(str1);
-            ch2 = nextchar(str2);
+    if (sizeof(T) == sizeof(char))
+    {
+        return _equal_transcoded(reinterpret_cast<const char *>(str1), reinterpret_cast<const char *>(str1_end), str2, str2_end);
+    }
 
-            str1Length -= charwidth<T>(ch1);
-            str2Length -= charwidth<U>(ch2);
-        }
+    if (sizeof(U) == sizeof(char))
+    {
+        return _equal_transcoded(reinterpret_cast<const char *>(str2), reinterpret_cast<const char *>(str2_end), str1, str1_end);
     }
 
-	return true;
+    return _equal_decoded(str1, str1_end, str2, str2_end);
 }
 
 
@@ -87,43 +246,29 @@ inline bool equal(const T *str1, const U *str2, bool caseSensitive = true, size_
 template <typename T>
 inline bool equal(const reference_string<T> &str1, const reference_string<T> &str2, bool caseSensitive = true)
 {
-    // If the lengths are different, it's impossible for the strings to be the same. Calculating
-    // the lengths for reference strings is a fast operation, so this check is worth while. It
-    // also simplifies the next part.
-    size_t len = length(str1);
-    if (len != length(str2))
-    {
-        return false;
-    }
-
     // If the internal pointers are the same, the strings are also the same.
     if (str1.start == str2.start && str1.end == str2.end)
     {
         return true;
     }
 
-    if (caseSensitive)
+    // Characters with different widths can fold to the same character, so the lengths are only
+    // checked when the comparison is case sensitive.
+    if (!caseSensitive)
     {
-        while (--len >= 0)
-        {
-            if (str1.start[len] != str2.start[len])
-            {
-                return false;
-            }
-        }
+        return _compare_nocase(str1.start, str1.end, str2.start, str2.end) == 0;
     }
-    else
+
+    // If the lengths are different, it's impossible for the strings to be the same. Calculating
+    // the lengths for reference strings is a fast operation, so this check is worth while. It
+    // also simplifies the next part.
+    size_t len = length(str1);
+    if (len != length(str2))
     {
-        while (--len >= 0)
-        {
-            if (tolower(str1.start[len]) != tolower(str2.start[len]))
-            {
-                return false;
-            }
-        }
+        return false;
     }
 
-    return true;
+    return ::memcmp(str1.start, str2.start, len * sizeof(T)) == 0;
 }
 
 
@@ -146,6 +291,59 @@ inline bool equal(const reference_string<T> str1, const U *str2, bool caseSensit
 }
 
 
+/**
+*   \brief                     Determines if a string is equal to a literal.
+*   \param  str           [in] The string to compare.
+*   \param  lit           [in] The literal to compare the string with.
+*   \param  caseSensitive [in] Specifies whether or not the comparison is case sensitive.
+*   \param  strLength     [in] The length in T's of the string, not including the null terminator.
+*   \return                    True if the string is equal to the literal; false otherwise.
+*
+*   \remarks
+*       The string is compared against the version of the literal with the same encoding, so a case
+*       sensitive comparison doesn't need to decode either string.
+*/
+template <typename T, typename U, size_t N>
+inline bool equal(const T *str, const literal<U, N> &lit, bool caseSensitive = true, size_t strLength = -1)
+{
+    if (str == NULL)
+    {
+        return false;
+    }
+
+    reference_string<const T> other = _literal_string(lit, static_cast<const T *>(NULL));
+    size_t other_length = length(other);
+
+    if (!caseSensitive)
+    {
+        return equal(str, other.start, false, strLength, other_length);
+    }
+
+    if (strLength != (size_t)-1)
+    {
+        return strLength == other_length && ::memcmp(str, other.start, other_length * sizeof(T)) == 0;
+    }
+
+    // The null terminator is compared as well. The literal never has a null terminator before its end,
+    // so we stop at the end of the string before reading past it.
+    for (size_t i = 0; i <= other_length; ++i)
+    {
+        if (str[i] != other.start[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename T, typename U, size_t N>
+inline bool equal(const reference_string<T> &str, const literal<U, N> &lit, bool caseSensitive = true)
+{
+    return equal(str.start, lit, caseSensitive, length(str));
+}
+
+
 }
 
 #endif // __EASL_EQUAL_H_
@@ -8,6 +8,7 @@
 
 #include "nextchar.h"
 #include "length.h"
+#include "charindex.h"
 
 namespace easl
 {
@@ -65,6 +66,44 @@ inline void erase(reference_string<T> &str, size_t start, size_t count)
     return erase(str.start, start, count, length(str));
 }
 
+/**
+*   \brief                      Removes a section of a given string using an index of the string.
+*   \param  str       [in, out] The string whose section is to be removed.
+*   \param  start     [in]      The index of the first character to remove from the string.
+*   \param  count     [in]      The number of characters to remove from the string.
+*   \param  index     [in]      The index that was built for \c str.
+*
+*   \remarks
+*       The index is used to find both ends of the section in one pass, and the rest of the
+*       string is then moved down without being decoded. The index is no longer valid after this
+*       and needs to be rebuilt before it is used again.
+*/
+template <typename T>
+inline void erase(T *str, size_t start, size_t count, const charindex<T> &index)
+{
+    assert(index.c_str() == str);
+    assert(start + count <= index.charcount());
+
+    size_t bounds[2] = {start, start + count};
+    size_t offsets[2];
+    index.offsets(bounds, 2, offsets);
+
+    if (offsets[1] == (size_t)-1)
+    {
+        offsets[1] = index.length();
+    }
+
+    if (offsets[0] == (size_t)-1)
+    {
+        return;
+    }
+
+    size_t tail = index.length() - offsets[1];
+    memmove(str + offsets[0], str + offsets[1], tail * sizeof(T));
+
+    str[offsets[0] + tail] = '\0';
+}
+
 }
 
 #endif // __EASL_ERASE_H_
@@ -8,6 +8,7 @@
 
 #include <vector>
 #include "../tokens.h"
+#include "../../literal.h"
 
 namespace easl
 {
@@ -101,31 +102,42 @@ void extractlist(T *str, std::vector<reference_string<T> > &list, const LIST_OPT
         easl::tokens::extracttokens(str, tokens, NULL, strLength);
     }
 
+    // The tokens are compared against literals so that they don't need to be transcoded each time.
+    static EASL_CONSTEXPR const literal<char, 2> open_curly("{");
+    static EASL_CONSTEXPR const literal<char, 2> close_curly("}");
+    static EASL_CONSTEXPR const literal<char, 2> open_round("(");
+    static EASL_CONSTEXPR const literal<char, 2> close_round(")");
+    static EASL_CONSTEXPR const literal<char, 2> open_square("[");
+    static EASL_CONSTEXPR const literal<char, 2> close_square("]");
+    static EASL_CONSTEXPR const literal<char, 2> open_angle("<");
+    static EASL_CONSTEXPR const literal<char, 2> close_angle(">");
+    static EASL_CONSTEXPR const literal<char, 2> comma(",");
+
     // The first and last tokens must be matching and valid brackets.
-    if (equal(tokens.front(), "{"))
+    if (equal(tokens.front(), open_curly))
     {
-        if (!equal(tokens.back(), "}"))
+        if (!equal(tokens.back(), close_curly))
         {
             return;
         }
     }
-    else if (equal(tokens.front(), "("))
+    else if (equal(tokens.front(), open_round))
     {
-        if (!equal(tokens.back(), ")"))
+        if (!equal(tokens.back(), close_round))
         {
             return;
         }
     }
-    else if (equal(tokens.front(), "["))
+    else if (equal(tokens.front(), open_square))
     {
-        if (!equal(tokens.back(), "]"))
+        if (!equal(tokens.back(), close_square))
         {
             return;
         }
     }
-    else if (equal(tokens.front(), "<"))
+    else if (equal(tokens.front(), open_angle))
     {
-        if (!equal(tokens.back(), ">"))
+        if (!equal(tokens.back(), close_angle))
         {
             return;
         }
@@ -138,7 +150,7 @@ void extractlist(T *str, std::vector<reference_string<T> > &list, const LIST_OPT
     // Look at each token.
     for (size_t i = 1; i < tokens.size() - 1; ++i)
     {
-        if (!equal(tokens[i], ","))
+        if (!equal(tokens[i], comma))
         {
             list.push_back(tokens[i]);
         }
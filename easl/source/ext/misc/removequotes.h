@@ -7,6 +7,7 @@
 #define __EASL_MISC_REMOVEQUOTES_H_
 
 #include "../../findfirstof.h"
+#include "../../charset.h"
 #include "../../_private.h"
 
 namespace easl
@@ -15,38 +16,37 @@ namespace misc
 {
 
 /**
-*   \brief                      Removes quotation marks from the string.
-*   \param  str       [in, out] The string whose quotation marks should be removed.
-*   \param  quotes    [in]      The string containing the different quote characters to consider quotes.
-*   \param  escape    [in]      The escape character.
-*   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
-*   \param
-*
-*   \remarks
-*       If the first character of the specified string must be a character inside the 'quotes'
-*       string. If it isn't, the function returns immediately.
-*       \par
-*       The quotes that removed must mach. For example, if the 'quotes' parameter is equal to "\"'"
-*       and the first character is a "'", then the function will remove the next "'" that is not
-*       prefixed with the escape character. By default, the escape character is a backslash.
-*       \par
-*       This function is useful for things like string parsers where values inside quotation marks
-*       will be used.
-*       \par
-*       The \c quotes string must be null terminated.
+*   \brief  Determines if a character is one of the characters in a quotes string.
 */
 template <typename T>
-void removequotes(T *str, const T *quotes, uchar32_t escape = '\\', size_t strLength = -1)
+inline bool _is_quote(const T *quotes, uchar32_t character)
+{
+    return findfirstof(quotes, character) != NULL;
+}
+
+/**
+*   \brief  Determines if a character is in a prepared set of quote characters.
+*/
+template <typename T>
+inline bool _is_quote(const charset<T> &quotes, uchar32_t character)
+{
+    return quotes.contains(character);
+}
+
+/**
+*   \brief  Implementation of removequotes(). \c quotes is anything that _is_quote() accepts.
+*/
+template <typename T, typename U>
+void _removequotes(T *str, const U &quotes, uchar32_t escape, size_t strLength)
 {
     assert(str != NULL);
-    assert(quotes != NULL);
     assert(strLength > 0);
 
     T *temp = str;
 
     // Check the first character. If must be contained in quotes string.
     uchar32_t quote_ch = nextchar(temp);
-    if (findfirstof(quotes, quote_ch) != NULL)
+    if (_is_quote(quotes, quote_ch))
     {
         // Grab the width of our quote character.
         size_t quote_width = charwidth<T>(quote_ch);
@@ -80,6 +80,53 @@ void removequotes(T *str, const T *quotes, uchar32_t escape = '\\', size_t strLe
     }
 }
 
+
+/**
+*   \brief                      Removes quotation marks from the string.
+*   \param  str       [in, out] The string whose quotation marks should be removed.
+*   \param  quotes    [in]      The string containing the different quote characters to consider quotes.
+*   \param  escape    [in]      The escape character.
+*   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
+*   \param
+*
+*   \remarks
+*       If the first character of the specified string must be a character inside the 'quotes'
+*       string. If it isn't, the function returns immediately.
+*       \par
+*       The quotes that removed must mach. For example, if the 'quotes' parameter is equal to "\"'"
+*       and the first character is a "'", then the function will remove the next "'" that is not
+*       prefixed with the escape character. By default, the escape character is a backslash.
+*       \par
+*       This function is useful for things like string parsers where values inside quotation marks
+*       will be used.
+*       \par
+*       The \c quotes string must be null terminated.
+*/
+template <typename T>
+void removequotes(T *str, const T *quotes, uchar32_t escape = '\\', size_t strLength = -1)
+{
+    assert(quotes != NULL);
+
+    _removequotes(str, quotes, escape, strLength);
+}
+
+/**
+*   \brief                      Removes quotation marks from the string.
+*   \param  str       [in, out] The string whose quotation marks should be removed.
+*   \param  quotes    [in]      The prepared set of characters to consider quotes.
+*   \param  escape    [in]      The escape character.
+*   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
+*
+*   \remarks
+*       This is the same as removequotes(T *, const T *, uchar32_t, size_t), except the quote
+*       characters come from a charset that has already been built.
+*/
+template <typename T, typename U>
+void removequotes(T *str, const charset<U> &quotes, uchar32_t escape = '\\', size_t strLength = -1)
+{
+    _removequotes(str, quotes, escape, strLength);
+}
+
 }
 }
 
@@ -132,12 +132,24 @@ inline size_t absolute(T *dest, const T *path, const T *base, size_t pathLength
 template <typename T>
 inline void absolute(slow_string<T> &dest, const T *path, const T *base)
 {
-    T *&temp = dest.c_str();
+    // We write straight into the strings buffer after making room for the path.
+    dest.reserve(absolute((T *)NULL, path, base) - 1);
+    absolute(dest.c_str(), path, base);
+}
 
-    temp = new T[absolute((T *)NULL, path, base)];
+template <typename T>
+inline void absolute(fast_string<T> &dest, const T *path, const T *base)
+{
+    // fast_string doesn't give out its internal buffer, so we need to build the path in a
+    // temporary buffer first.
+    size_t size = absolute((T *)NULL, path, base);
+
+    T *temp = new T[size];
     absolute(temp, path, base);
 
-    // NOTE: Don't delete the temp pointer. It will be deleted by the strings destructor.
+    dest.assign(temp, size - 1);
+
+    delete [] temp;
 }
 
 
@@ -7,15 +7,38 @@
 #define __EASL_PATHS_GETFILEEXT_H_
 
 #include <assert.h>
-#include "../../nextchar.h"
+#include "../../findlast.h"
 #include "../../string.h"
 #include "../../reference_string.h"
+#include "../../length.h"
+#include "_private.h"               // easl/ext/paths/_private.h
 
 namespace easl
 {
 namespace paths
 {
 
+/**
+*   \brief               Finds the position just past the last full stop in a string.
+*   \param  str    [in]  Pointer to the start of the string.
+*   \param  strEnd [in]  Pointer to the end of the string.
+*   \return              A pointer to just past the last full stop; or NULL if there isn't one.
+*
+*   \remarks
+*       The string is searched from the end with findlast(), so only the part of the string after the
+*       last full stop is looked at.
+*/
+template <typename T>
+inline T * _find_past_last_dot(T *str, T *strEnd)
+{
+    reference_string<T> whole = {str, strEnd};
+
+    // A full stop is always a single T.
+    T *last_dot = findlast(whole, '.');
+
+    return (last_dot != NULL) ? last_dot + 1 : NULL;
+}
+
 /**
 *   \brief                 Retrieves the extension of a file.
 *   \param  str       [in] The string that contains the file name whose extension is to be retrieved.
@@ -43,38 +66,24 @@ inline size_t getfileext(T *dest, const T *src, size_t srcLength = -1)
 
     // Need to account for localisation here.
 
-    // Stores the start of the next character.
-    T *start_of_ch = src;
-
-    // We need to find the last occurance of a full stop characters. We'll do this
-    // by storing each occurance of a full stop that we find. The one that stored when
-    // we reach the end of the file will be the last one.
-    const T *last_pos = NULL;
-    uchar32_t ch;
-    while (srcLength > 0 && (ch = nextchar(src)) != '\0')
-    {
-        if (ch == '.')
-        {
-            last_pos = src;
-        }
-
-        srcLength -= src - start_of_ch;
-        start_of_ch = src;
-    }
+    // The extension starts just past the last full stop, which is looked for from the
+    // end of the string.
+    const T *src_end = src + ((srcLength == (size_t)-1) ? length(src) : length(src, srcLength));
+    const T *last_pos = _find_past_last_dot(src, src_end);
 
     // If we didn't find a decimal point, there is no extension.
     if (last_pos == NULL)
     {
         if (dest != NULL)
         {
-            dest[0] = NULL;
+            dest[0] = '\0';
         }
 
         return 1;
     }
 
     // Now calculate the number of T's that are required to store the extension.
-    size_t ext_size = (src - last_pos) + 1;
+    size_t ext_size = (src_end - last_pos) + 1;
 
     if (dest != NULL)
     {
@@ -85,31 +94,30 @@ inline size_t getfileext(T *dest, const T *src, size_t srcLength = -1)
     return ext_size;
 }
 
+/**
+*   \brief                 Finds the start of the extension of a file.
+*   \param  src       [in] The file path to look at.
+*   \param  srcLength [in] The length in T's of the source string, not including the null terminator.
+*   \return                Pointer to the character just past the last full stop; or NULL if there is no extension.
+*/
 template <typename T>
-inline void getfileext(slow_string<T> &dest, const T *src, size_t srcLength = -1)
+inline const T * _findfileext(const T *src, size_t srcLength)
 {
     assert(src != NULL);
 
     // Need to account for localisation here.
 
-    // Stores the start of the next character.
-    const T *start_of_ch = src;
+    // The extension starts just past the last full stop, which is looked for from the
+    // end of the string.
+    const T *src_end = src + ((srcLength == (size_t)-1) ? length(src) : length(src, srcLength));
 
-    // We need to find the last occurance of a full stop characters. We'll do this
-    // by storing each occurance of a full stop that we find. The one that stored when
-    // we reach the end of the file will be the last one.
-    const T *last_pos = NULL;
-    uchar32_t ch;
-    while (srcLength > 0 && (ch = easl::nextchar(src)) != '\0')
-    {
-        if (ch == '.')
-        {
-            last_pos = src;
-        }
+    return _find_past_last_dot(src, src_end);
+}
 
-        srcLength -= src - start_of_ch;
-        start_of_ch = src;
-    }
+template <typename T>
+inline void getfileext(slow_string<T> &dest, const T *src, size_t srcLength = -1)
+{
+    const T *last_pos = _findfileext(src, srcLength);
 
     // If we didn't find a decimal point, there is no extension.
     if (last_pos == NULL)
@@ -122,6 +130,22 @@ inline void getfileext(slow_string<T> &dest, const T *src, size_t srcLength = -1
     }
 }
 
+template <typename T>
+inline void getfileext(fast_string<T> &dest, const T *src, size_t srcLength = -1)
+{
+    const T *last_pos = _findfileext(src, srcLength);
+
+    // If we didn't find a decimal point, there is no extension.
+    if (last_pos == NULL)
+    {
+        dest = (const T *)NULL;
+    }
+    else
+    {
+        dest = last_pos;
+    }
+}
+
 
 inline string8 getfileext(const char *src, size_t srcLength = -1)
 {
@@ -160,30 +184,16 @@ void getfileext(reference_string<T> &dest, T *src, size_t srcLength = -1)
 
     // Need to account for localisation here.
 
-    // Stores the start of the next character.
-    T *start_of_ch = src;
-
-    // We need to find the last occurance of a full stop characters. We'll do this
-    // by storing each occurance of a full stop that we find. The one that stored when
-    // we reach the end of the file will be the last one.
-    T *last_pos = NULL;
-    uchar32_t ch;
-    while (srcLength > 0 && (ch = nextchar(src)) != '\0')
-    {
-        if (ch == '.')
-        {
-            last_pos = src;
-        }
-
-        srcLength -= src - start_of_ch;
-        start_of_ch = src;
-    }
+    // The extension starts just past the last full stop, which is looked for from the
+    // end of the string.
+    T *src_end = src + ((srcLength == (size_t)-1) ? length(src) : length(src, srcLength));
+    T *last_pos = _find_past_last_dot(src, src_end);
 
-    dest.end = src;
+    dest.end = src_end;
 
     if (last_pos == NULL)
     {
-        dest.start = src;
+        dest.start = src_end;
     }
     else
     {
@@ -131,12 +131,24 @@ inline size_t relative(T *dest, const T *path, const T *base, size_t pathLength
 template <typename T>
 inline void relative(slow_string<T> &dest, const T *path, const T *base)
 {
-    T *&temp = dest.c_str();
+    // We write straight into the strings buffer after making room for the path.
+    dest.reserve(relative((T *)NULL, path, base) - 1);
+    relative(dest.c_str(), path, base);
+}
 
-    temp = new T[relative((T *)NULL, path, base)];
+template <typename T>
+inline void relative(fast_string<T> &dest, const T *path, const T *base)
+{
+    // fast_string doesn't give out its internal buffer, so we need to build the path in a
+    // temporary buffer first.
+    size_t size = relative((T *)NULL, path, base);
+
+    T *temp = new T[size];
     relative(temp, path, base);
 
-    // NOTE: Don't delete the temp pointer. It will be deleted by the strings destructor.
+    dest.assign(temp, size - 1);
+
+    delete [] temp;
 }
 
 
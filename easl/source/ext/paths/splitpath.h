@@ -6,7 +6,11 @@
 #ifndef __EASL_PATHS_SPLITPATH_H_
 #define __EASL_PATHS_SPLITPATH_H_
 
-#include "../../nextchar.h"
+#include <assert.h>
+#include "../../length.h"
+#include "../../reference_string.h"
+#include "../../findlastof.h"
+#include "_private.h"               // easl/ext/paths/_private.h
 
 namespace easl
 {
@@ -24,30 +28,26 @@ void splitpath(T *path, reference_string<T> &folder, reference_string<T> &file,
 {
     assert(path != NULL);
 
-    // We first need to find the last slash in the path. Once we have that we can output
-    // our results.
-
-    // Stores the start of the next character. This is used so that we can modify pathLength easily.
-    const T *start_of_ch = path;
+    T *path_end = path + ((pathLength == (size_t)-1) ? length(path) : length(path, pathLength));
 
     // The start of the folder is always at the start of the string.
     folder.start = folder.end = path;
 
-    uchar32_t ch;
-    while (pathLength > 0 && (ch = easl::nextchar(path)) != '\0')
-    {
-        if (ch == '/' || ch == '\\')
-        {
-            folder.end = path;
-        }
+    // The folder ends just past the last slash of either kind. Slashes are ASCII, so they're
+    // always a single T.
+    const T slashes[] = {'/', '\\', '\0'};
 
-        pathLength -= path - start_of_ch;
-        start_of_ch = path;
+    reference_string<T> whole = {path, path_end};
+    T *last_slash = findlastof(whole, slashes);
+
+    if (last_slash != NULL)
+    {
+        folder.end = last_slash + 1;
     }
 
     // Now we can output our results. The file starts where the folder ends.
     file.start = folder.end;
-    file.end = path;
+    file.end = path_end;
 }
 
 }
@@ -8,7 +8,10 @@
 #ifndef __EASL_SEARCH_H_
 #define __EASL_SEARCH_H_
 
+#include "search/findprintablechar.h"
+#include "search/findnonprintablechar.h"
 #include "search/containsprintablechar.h"
 #include "search/containsnonprintablechar.h"
+#include "search/multi_searcher.h"
 
 #endif // __EASL_SEARCH_H_
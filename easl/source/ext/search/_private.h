@@ -0,0 +1,191 @@
+/**
+*   \file   _private.h
+*   \author Dave Reid
+*   \brief  Header file for non-public functions for the search extension.
+*/
+#ifndef __EASL_SEARCH_PRIVATE_H_
+#define __EASL_SEARCH_PRIVATE_H_
+
+#include "../../types.h"
+#include "../../_simd.h"
+#include "../../searcher.h"
+
+namespace easl
+{
+namespace search
+{
+
+#if defined(EASL_SIMD_SSE2)
+/**
+*   \brief              Retrieves a register with only the sign bit of each code unit set.
+*   \param  width [in]  The size of a code unit in bytes. This must be 1, 2 or 4.
+*
+*   \remarks
+*       SSE2 only compares signed integers, so code units are XORed with this first to compare
+*       them as unsigned integers.
+*/
+inline __m128i _printable_bias(size_t width)
+{
+    return _searcher_broadcast(static_cast<uchar32_t>(1) << (width * 8 - 1), width);
+}
+
+/**
+*   \brief                  Finds the first code unit in a register that decides a printable character search.
+*   \param  input     [in]  The code units to check.
+*   \param  bias      [in]  The register from _printable_bias().
+*   \param  limit     [in]  The biased code unit just past the space character.
+*   \param  width     [in]  The size of a code unit in bytes. This must be 1, 2 or 4.
+*   \param  printable [in]  True when looking for printable characters; false when looking for non-printable ones.
+*   \return                 A mask with a bit set for every byte of a code unit that decides the search.
+*
+*   \remarks
+*       Code units up to and including ' ' are non-printable characters. Everything above it is either a
+*       printable character or part of one, since every code unit of a multi-unit character in UTF-8
+*       and UTF-16 is above 0x7F. A null character ends the string, so it decides both searches.
+*/
+inline unsigned int _printable_mask(__m128i input, __m128i bias, __m128i limit, size_t width, bool printable)
+{
+    __m128i blank = _searcher_cmpgt(limit, _mm_xor_si128(input, bias), width);
+    if (printable)
+    {
+        blank = _mm_andnot_si128(_searcher_cmpeq(input, _mm_setzero_si128(), width), blank);
+
+        return ~static_cast<unsigned int>(_mm_movemask_epi8(blank)) & 0xFFFF;
+    }
+
+    return static_cast<unsigned int>(_mm_movemask_epi8(blank));
+}
+#endif
+
+#if defined(EASL_KERNEL_AVX2)
+/**
+*   \brief                      AVX2 kernel for _find_printable_unit(). Checks whole 32 byte blocks.
+*   \param  str       [in, out] The string to check. This is moved to the code unit that was found, or past the checked blocks.
+*   \param  end       [in]      Pointer to the end of the string.
+*   \param  width     [in]      The size of a code unit in bytes. This must be 1, 2 or 4.
+*   \param  printable [in]      True when looking for printable characters; false when looking for non-printable ones.
+*   \return                     True if a code unit was found; false otherwise.
+*
+*   \remarks
+*       See _printable_mask() for the code units that are looked for.
+*/
+EASL_TARGET("avx2") inline bool _find_printable_avx2(const char *&str, const char *end, size_t width, bool printable)
+{
+    const __m256i bias  = _mm256_broadcastsi128_si256(_printable_bias(width));
+    const __m256i limit = _mm256_xor_si256(bias, _mm256_broadcastsi128_si256(_searcher_broadcast(' ' + 1, width)));
+    const __m256i zero  = _mm256_setzero_si256();
+
+    while (end - str >= 32)
+    {
+        __m256i input  = _mm256_loadu_si256((const __m256i *)str);
+        __m256i biased = _mm256_xor_si256(input, bias);
+
+        __m256i blank;
+        __m256i null;
+        if (width == 1)
+        {
+            blank = _mm256_cmpgt_epi8(limit, biased);
+            null  = _mm256_cmpeq_epi8(input, zero);
+        }
+        else if (width == 2)
+        {
+            blank = _mm256_cmpgt_epi16(limit, biased);
+            null  = _mm256_cmpeq_epi16(input, zero);
+        }
+        else
+        {
+            blank = _mm256_cmpgt_epi32(limit, biased);
+            null  = _mm256_cmpeq_epi32(input, zero);
+        }
+
+        unsigned int mask;
+        if (printable)
+        {
+            mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_andnot_si256(null, blank)));
+        }
+        else
+        {
+            mask = static_cast<unsigned int>(_mm256_movemask_epi8(blank));
+        }
+
+        if (mask != 0)
+        {
+            str += _bitscan_forward(mask);
+            return true;
+        }
+
+        str += 32;
+    }
+
+    return false;
+}
+#endif
+
+
+/**
+*   \brief                  Finds the first code unit that decides whether or not a string has a printable or non-printable character.
+*   \param  str       [in]  Pointer to the start of the string.
+*   \param  strEnd    [in]  Pointer to the end of the string.
+*   \param  printable [in]  True to look for the first code unit above ' '; false to look for the first code unit up to and including ' '.
+*   \return                 A pointer to the code unit that was found, which may be a null character; or \c strEnd if there isn't one.
+*
+*   \remarks
+*       The string is not decoded. An ASCII code unit is always a whole character, and every other code unit
+*       belongs to a character above ' ', so checking code units is the same as checking characters. The
+*       search stops at a null character, which the caller has to check for.
+*       \par
+*       With SSE2, 16 bytes are checked at a time, or 32 bytes when the CPU supports AVX2.
+*/
+template <typename T>
+inline const T * _find_printable_unit(const T *str, const T *strEnd, bool printable)
+{
+#if defined(EASL_SIMD_SSE2)
+    if (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)
+    {
+        const size_t width = sizeof(T);
+        const char  *bytes = reinterpret_cast<const char *>(str);
+        const char  *end   = reinterpret_cast<const char *>(strEnd);
+
+#if defined(EASL_KERNEL_AVX2)
+        // Short strings aren't worth checking the CPU for.
+        if (end - bytes >= 64 && cpu_supports(EASL_CPU_AVX2) && _find_printable_avx2(bytes, end, width, printable))
+        {
+            return reinterpret_cast<const T *>(bytes);
+        }
+#endif
+
+        const __m128i bias  = _printable_bias(width);
+        const __m128i limit = _mm_xor_si128(bias, _searcher_broadcast(' ' + 1, width));
+
+        while (end - bytes >= 16)
+        {
+            unsigned int mask = _printable_mask(_mm_loadu_si128((const __m128i *)bytes), bias, limit, width, printable);
+            if (mask != 0)
+            {
+                return reinterpret_cast<const T *>(bytes + _bitscan_forward(mask));
+            }
+
+            bytes += 16;
+        }
+
+        str = reinterpret_cast<const T *>(bytes);
+    }
+#endif
+
+    // Negative T's become large unsigned values, the same as the biased comparison above.
+    for ( ; str < strEnd; ++str)
+    {
+        uchar32_t unit = static_cast<uchar32_t>(*str);
+        if (unit == '\0' || (unit > ' ') == printable)
+        {
+            return str;
+        }
+    }
+
+    return strEnd;
+}
+
+}
+}
+
+#endif // __EASL_SEARCH_PRIVATE_H_
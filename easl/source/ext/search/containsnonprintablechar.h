@@ -6,7 +6,7 @@
 #ifndef __EASL_SEARCH_CONTAINSNONPRINTABLECHAR
 #define __EASL_SEARCH_CONTAINSNONPRINTABLECHAR
 
-#include "../../nextchar.h"
+#include "findnonprintablechar.h"
 #include "../../length.h"
 
 namespace easl
@@ -24,26 +24,18 @@ namespace search
 *       A printable character is a character that has some sort of visual appearance. A printable
 *       character is _not_ a tab, space, line-feed, etc. The first 32 ASCII values are not
 *       considered printable characters.
+*       \par
+*       The string ends at its first null character, even when the length is given. See
+*       findnonprintablechar() for how the string is checked.
 */
 template <typename T>
-bool containsnonprintablechar(const T *str, size_t strLength = -1)
+inline bool containsnonprintablechar(const T *str, size_t strLength = -1)
 {
-    uchar32_t ch;
-    while (strLength > 0 && (ch = nextchar(str)) != '\0')
-    {
-        if (ch <= ' ')
-        {
-            return true;
-        }
-
-        strLength -= charwidth<T>(ch);
-    }
-
-    return false;
+    return findnonprintablechar(str, strLength) != NULL;
 }
 
 template <typename T>
-bool containsnonprintablechar(const reference_string<T> &str)
+inline bool containsnonprintablechar(const reference_string<T> &str)
 {
     return containsnonprintablechar(str.start, length(str));
 }
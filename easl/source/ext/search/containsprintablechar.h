@@ -6,7 +6,7 @@
 #ifndef __EASL_SEARCH_CONTAINSPRINTABLECHAR
 #define __EASL_SEARCH_CONTAINSPRINTABLECHAR
 
-#include "../../nextchar.h"
+#include "findprintablechar.h"
 #include "../../length.h"
 
 namespace easl
@@ -24,20 +24,14 @@ namespace search
 *       A printable character is a character that has some sort of visual appearance. A printable
 *       character is _not_ a tab, space, line-feed, etc. The first 32 ASCII values are not
 *       considered printable characters.
+*       \par
+*       The string ends at its first null character, even when the length is given. See
+*       findprintablechar() for how the string is checked.
 */
 template <typename T>
-bool containsprintablechar(const T *str, size_t strLength = -1)
+inline bool containsprintablechar(const T *str, size_t strLength = -1)
 {
-    uchar32_t ch;
-    while (strLength > 0 && (ch = nextchar(str)) != '\0')
-    {
-        if (ch > ' ')
-        {
-            return true;
-        }
-    }
-
-    return false;
+    return findprintablechar(str, strLength) != NULL;
 }
 
 template <typename T>
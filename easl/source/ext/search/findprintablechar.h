@@ -0,0 +1,62 @@
+/**
+*   \file   findprintablechar.h
+*   \author Dave Reid
+*   \brief  Header file for the findprintablechar() implementation.
+*/
+#ifndef __EASL_SEARCH_FINDPRINTABLECHAR
+#define __EASL_SEARCH_FINDPRINTABLECHAR
+
+#include <assert.h>
+#include "_private.h"
+#include "../../length.h"
+#include "../../reference_string.h"
+
+namespace easl
+{
+namespace search
+{
+
+/**
+*   \brief                 Finds the first printable character in a string.
+*   \param  str       [in] The string to search.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*   \return                A pointer to the first printable character; or NULL if the string only has non-printable characters.
+*
+*   \remarks
+*       A printable character is a character that has some sort of visual appearance. A printable
+*       character is _not_ a tab, space, line-feed, etc. The first 32 ASCII values are not
+*       considered printable characters.
+*       \par
+*       The string ends at its first null character, even when the length is given. Code units are
+*       checked many at a time without decoding the string, so code units that aren't valid in the
+*       encoding count as printable characters.
+*/
+template <typename T>
+inline T * findprintablechar(T *str, size_t strLength = -1)
+{
+    assert(str != NULL);
+
+    if (strLength == (size_t)-1)
+    {
+        strLength = length(str);
+    }
+
+    const T *found = _find_printable_unit((const T *)str, (const T *)str + strLength, true);
+    if (found == str + strLength || *found == '\0')
+    {
+        return NULL;
+    }
+
+    return (T *)found;
+}
+
+template <typename T>
+inline T * findprintablechar(const reference_string<T> &str)
+{
+    return findprintablechar(str.start, length(str));
+}
+
+}
+}
+
+#endif // __EASL_SEARCH_FINDPRINTABLECHAR
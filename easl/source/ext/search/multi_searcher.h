@@ -0,0 +1,573 @@
+/**
+*   \file   multi_searcher.h
+*   \author Dave Reid
+*   \brief  Header file for the multi_searcher class.
+*/
+#ifndef __EASL_SEARCH_MULTI_SEARCHER
+#define __EASL_SEARCH_MULTI_SEARCHER
+
+#include <assert.h>
+#include <vector>
+#include <map>
+#include <utility>
+#include <algorithm>
+#include "../../types.h"
+#include "../../_simd.h"
+#include "../../charset.h"
+#include "../../length.h"
+#include "../../reference_string.h"
+
+namespace easl
+{
+namespace search
+{
+
+/**
+*   \brief  A match that was found by a multi_searcher.
+*/
+struct multi_match
+{
+    /// The index of the pattern that was found, in the order the patterns were given to the searcher.
+    size_t pattern;
+
+    /// The offset in T's from the start of the string to the start of the match.
+    size_t offset;
+
+    /// The length in T's of the match.
+    size_t length;
+};
+
+
+/**
+*   \brief  Searches for many patterns at once.
+*
+*   The patterns are compiled into an Aho-Corasick automaton when the searcher is constructed,
+*   after which every occurance of every pattern can be found with a single pass over a string:
+*
+*   \code
+*   const char *keywords[] = {"error", "timeout", "refused"};
+*   easl::search::multi_searcher<char> searcher(keywords, 3, true);
+*
+*   std::vector<easl::search::multi_match> matches;
+*   searcher.findall(line, lineLength, matches);
+*   \endcode
+*
+*   Patterns are matched code unit by code unit without being decoded, so a valid pattern can only
+*   be found at the start of a character in a valid string. When case is ignored, only the ASCII
+*   letters are folded. Empty patterns are never found.
+*
+*   The automaton is stored as a table with a row for every prefix of every pattern and a column
+*   for every distinct code unit used by the patterns. Code units that aren't used by any pattern
+*   share a single column. A few thousand keywords take a few megabytes.
+*
+*   When the automaton is at the start state, none of the patterns have been partly matched, so
+*   any code unit that can't start a pattern can be skipped. For char strings this is done 16
+*   bytes at a time with SSSE3 when the CPU supports it, which is where most of the time goes when
+*   the patterns are sparse in the text.
+*/
+template <typename T>
+class multi_searcher
+{
+public:
+
+    /**
+    *   \brief                    Constructor.
+    *   \param  patterns     [in] The null terminated patterns to search for.
+    *   \param  patternCount [in] The number of patterns.
+    *   \param  ignoreCase   [in] Whether or not ASCII letters should be matched regardless of case.
+    */
+    multi_searcher(const T * const *patterns, size_t patternCount, bool ignoreCase = false)
+        : m_ignore_case(ignoreCase), m_class_count(1), m_output_start(0), m_prefilter(false)
+    {
+        assert(patterns != NULL || patternCount == 0);
+
+        std::vector<reference_string<const T> > pattern_list(patternCount);
+        for (size_t i = 0; i < patternCount; ++i)
+        {
+            pattern_list[i].start = patterns[i];
+            pattern_list[i].end   = patterns[i] + easl::length(patterns[i]);
+        }
+
+        _build(pattern_list);
+    }
+
+    /**
+    *   \brief                    Constructor.
+    *   \param  patterns     [in] The patterns to search for. These do not need to be null terminated.
+    *   \param  patternCount [in] The number of patterns.
+    *   \param  ignoreCase   [in] Whether or not ASCII letters should be matched regardless of case.
+    */
+    multi_searcher(const reference_string<const T> *patterns, size_t patternCount, bool ignoreCase = false)
+        : m_ignore_case(ignoreCase), m_class_count(1), m_output_start(0), m_prefilter(false)
+    {
+        assert(patterns != NULL || patternCount == 0);
+
+        _build(std::vector<reference_string<const T> >(patterns, patterns + patternCount));
+    }
+
+
+    /**
+    *   \brief                  Finds every occurance of every pattern between two pointers.
+    *   \param  str      [in]   Pointer to the start of the string to search.
+    *   \param  strEnd   [in]   Pointer to the end of the string to search.
+    *   \param  callback [in]   The function object that is called with each match.
+    *   \return                 The number of matches that were passed to the callback.
+    *
+    *   \remarks
+    *       The callback is called as <tt>bool callback(const multi_match &)</tt>. Returning false stops
+    *       the search.
+    *       \par
+    *       Matches are reported in the order that they end. Matches that end at the same place are
+    *       reported longest first. Overlapping matches are all reported.
+    *       \par
+    *       The string does not need to be null terminated and nothing at or past \c strEnd is read.
+    */
+    template <typename Callback>
+    size_t findall(const T *str, const T *strEnd, Callback &callback) const
+    {
+        assert(str <= strEnd);
+
+        size_t count = 0;
+        if (m_output_start == 0)
+        {
+            // There are no patterns to find.
+            return count;
+        }
+
+        const T *temp  = str;
+        size_t   state = 0;
+
+        while (temp < strEnd)
+        {
+            if (state == 0 && m_prefilter && !m_start[_unit(*temp) & 0xFF])
+            {
+                temp = _skip(temp, strEnd);
+                if (temp == strEnd)
+                {
+                    break;
+                }
+            }
+
+            state = m_next[state + _class(*temp)];
+            ++temp;
+
+            if (state >= m_output_start)
+            {
+                if (!_report(state, static_cast<size_t>(temp - str), callback, count))
+                {
+                    break;
+                }
+            }
+        }
+
+        return count;
+    }
+
+    /**
+    *   \brief                   Finds every occurance of every pattern inside a string.
+    *   \param  str       [in]   The string to search.
+    *   \param  strLength [in]   The length in T's of the string, not including the null terminator.
+    *   \param  matches   [out]  The list that the matches are appended to.
+    *   \return                  The number of matches that were appended to the list.
+    *
+    *   \remarks
+    *       If the length is -1, the string must be null terminated. Otherwise, null characters are
+    *       treated like any other character.
+    */
+    size_t findall(const T *str, size_t strLength, std::vector<multi_match> &matches) const
+    {
+        assert(str != NULL);
+
+        if (strLength == (size_t)-1)
+        {
+            strLength = easl::length(str);
+        }
+
+        _append_match append(matches);
+        return findall(str, str + strLength, append);
+    }
+
+    /**
+    *   \brief                   Determines if a string contains any of the patterns.
+    *   \param  str       [in]   The string to search.
+    *   \param  strLength [in]   The length in T's of the string, not including the null terminator.
+    *   \return                  True if any pattern is found; false otherwise.
+    */
+    bool contains(const T *str, size_t strLength = -1) const
+    {
+        assert(str != NULL);
+
+        if (strLength == (size_t)-1)
+        {
+            strLength = easl::length(str);
+        }
+
+        _stop_at_first stop;
+        return findall(str, str + strLength, stop) != 0;
+    }
+
+    template <typename U>
+    size_t findall(const reference_string<U> &str, std::vector<multi_match> &matches) const
+    {
+        return findall(str.start, length(str), matches);
+    }
+
+    template <typename U>
+    bool contains(const reference_string<U> &str) const
+    {
+        return contains(str.start, length(str));
+    }
+
+
+    /// Retrieves the number of patterns, including empty ones.
+    size_t pattern_count() const { return m_lengths.size(); }
+
+    /// Retrieves the number of states in the automaton.
+    size_t state_count() const { return m_next.size() / m_class_count; }
+
+
+private:
+
+    /// Callback for findall() that appends each match to a list.
+    struct _append_match
+    {
+        _append_match(std::vector<multi_match> &matchesIn) : matches(matchesIn) {}
+        bool operator()(const multi_match &match) { matches.push_back(match); return true; }
+        std::vector<multi_match> &matches;
+    };
+
+    /// Callback for contains() that stops at the first match.
+    struct _stop_at_first
+    {
+        bool operator()(const multi_match &) { return false; }
+    };
+
+
+    /// Retrieves a code unit as an unsigned value.
+    static uchar32_t _unit(T unit)
+    {
+        if (sizeof(T) == 1)
+        {
+            return static_cast<unsigned char>(unit);
+        }
+        else if (sizeof(T) == 2)
+        {
+            return static_cast<uchar16_t>(unit);
+        }
+
+        return static_cast<uchar32_t>(unit);
+    }
+
+    /// Retrieves the column of the table for a code unit.
+    size_t _class(T unit) const
+    {
+        uchar32_t value = _unit(unit);
+        if (value < 256)
+        {
+            return m_byte_class[value];
+        }
+
+        typename std::vector<std::pair<uchar32_t, size_t> >::const_iterator i =
+            std::lower_bound(m_wide_class.begin(), m_wide_class.end(), std::make_pair(value, (size_t)0));
+
+        if (i != m_wide_class.end() && i->first == value)
+        {
+            return i->second;
+        }
+
+        return 0;
+    }
+
+    /// Skips code units that can't start a pattern.
+    const T * _skip(const T *str, const T *strEnd) const
+    {
+#if defined(EASL_KERNEL_SSSE3)
+        if (sizeof(T) == 1 && cpu_supports(EASL_CPU_SSSE3))
+        {
+            str = reinterpret_cast<const T *>(_charset_skip_ssse3(reinterpret_cast<const char *>(str), reinterpret_cast<const char *>(strEnd), 1, m_low_table, m_high_table));
+        }
+#endif
+
+        while (str < strEnd && !m_start[_unit(*str) & 0xFF])
+        {
+            ++str;
+        }
+
+        return str;
+    }
+
+    /**
+    *   \brief                      Passes every pattern that ends at a state to a callback.
+    *   \param  state    [in]       The state, premultiplied by the number of columns.
+    *   \param  end      [in]       The offset in T's just past the end of the matches.
+    *   \param  callback [in]       The callback.
+    *   \param  count    [in, out]  The number of matches so far.
+    *   \return                     False if the callback asked to stop; true otherwise.
+    */
+    template <typename Callback>
+    bool _report(size_t state, size_t end, Callback &callback, size_t &count) const
+    {
+        size_t index = state / m_class_count;
+        while (index != (size_t)-1)
+        {
+            for (size_t i = m_own_begin[index]; i < m_own_begin[index + 1]; ++i)
+            {
+                multi_match match;
+                match.pattern = m_own[i];
+                match.length  = m_lengths[match.pattern];
+                match.offset  = end - match.length;
+
+                ++count;
+                if (!callback(match))
+                {
+                    return false;
+                }
+            }
+
+            index = m_output_link[index];
+        }
+
+        return true;
+    }
+
+    /// Retrieves a code unit with ASCII letters folded to lower case if case is ignored.
+    uchar32_t _fold(T unit) const
+    {
+        uchar32_t value = _unit(unit);
+        if (m_ignore_case && value >= 'A' && value <= 'Z')
+        {
+            value += 'a' - 'A';
+        }
+
+        return value;
+    }
+
+    /**
+    *   \brief                Builds the automaton.
+    *   \param  patterns [in] The patterns.
+    */
+    void _build(const std::vector<reference_string<const T> > &patterns)
+    {
+        for (size_t i = 0; i < 256; ++i)
+        {
+            m_byte_class[i] = 0;
+            m_start[i] = false;
+        }
+
+        // Give every distinct code unit it's own column. Column 0 is for everything else.
+        std::map<uchar32_t, size_t> wide_class;
+        for (size_t i = 0; i < patterns.size(); ++i)
+        {
+            for (const T *unit = patterns[i].start; unit < patterns[i].end; ++unit)
+            {
+                uchar32_t value = _fold(*unit);
+                if (value < 256)
+                {
+                    if (m_byte_class[value] == 0)
+                    {
+                        m_byte_class[value] = m_class_count++;
+                    }
+                }
+                else if (wide_class.find(value) == wide_class.end())
+                {
+                    wide_class[value] = m_class_count++;
+                }
+            }
+        }
+
+        if (m_ignore_case)
+        {
+            for (uchar32_t ch = 'A'; ch <= 'Z'; ++ch)
+            {
+                m_byte_class[ch] = m_byte_class[ch + ('a' - 'A')];
+            }
+        }
+
+        m_wide_class.assign(wide_class.begin(), wide_class.end());
+
+        // Build the trie. A 0 in the table means there is no edge, since nothing leads back to the root.
+        const size_t columns = m_class_count;
+        std::vector<unsigned int>        next(columns, 0);
+        std::vector<std::vector<size_t> > own(1);
+
+        m_lengths.resize(patterns.size());
+        for (size_t i = 0; i < patterns.size(); ++i)
+        {
+            m_lengths[i] = patterns[i].end - patterns[i].start;
+            if (m_lengths[i] == 0)
+            {
+                continue;
+            }
+
+            size_t state = 0;
+            for (const T *unit = patterns[i].start; unit < patterns[i].end; ++unit)
+            {
+                size_t column = _class(*unit);
+                if (next[state * columns + column] == 0)
+                {
+                    next[state * columns + column] = static_cast<unsigned int>(own.size());
+                    next.resize(next.size() + columns, 0);
+                    own.resize(own.size() + 1);
+                }
+
+                state = next[state * columns + column];
+            }
+
+            own[state].push_back(i);
+        }
+
+        // Fill in the missing edges and the output links in breadth first order, so that the failure
+        // state of every state is finished before the state itself.
+        const size_t state_count = own.size();
+        std::vector<unsigned int> fail(state_count, 0);
+        std::vector<size_t>       output_link(state_count, (size_t)-1);
+        std::vector<unsigned int> queue;
+        queue.reserve(state_count);
+
+        for (size_t column = 0; column < columns; ++column)
+        {
+            if (next[column] != 0)
+            {
+                queue.push_back(next[column]);
+            }
+        }
+
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            size_t state = queue[head];
+            for (size_t column = 0; column < columns; ++column)
+            {
+                unsigned int &edge = next[state * columns + column];
+                unsigned int  other = next[fail[state] * columns + column];
+
+                if (edge != 0)
+                {
+                    fail[edge] = other;
+                    output_link[edge] = !own[other].empty() ? other : output_link[other];
+                    queue.push_back(edge);
+                }
+                else
+                {
+                    edge = other;
+                }
+            }
+        }
+
+        // Renumber the states so that every state with an output comes after the ones without. A
+        // single comparison then tells the search loop if there's anything to report.
+        std::vector<size_t> renumber(state_count);
+        size_t new_state = 0;
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (size_t state = 0; state < state_count; ++state)
+            {
+                bool has_output = !own[state].empty() || output_link[state] != (size_t)-1;
+                if (has_output == (pass == 1))
+                {
+                    if (pass == 1 && m_output_start == 0)
+                    {
+                        m_output_start = new_state * columns;
+                    }
+
+                    renumber[state] = new_state++;
+                }
+            }
+        }
+
+        m_next.resize(next.size());
+        m_own_begin.resize(state_count + 1);
+        m_output_link.resize(state_count);
+
+        std::vector<size_t> old_state(state_count);
+        for (size_t state = 0; state < state_count; ++state)
+        {
+            old_state[renumber[state]] = state;
+        }
+
+        for (size_t state = 0; state < state_count; ++state)
+        {
+            size_t old = old_state[state];
+            for (size_t column = 0; column < columns; ++column)
+            {
+                m_next[state * columns + column] = static_cast<unsigned int>(renumber[next[old * columns + column]] * columns);
+            }
+
+            m_own_begin[state] = m_own.size();
+            m_own.insert(m_own.end(), own[old].begin(), own[old].end());
+            m_output_link[state] = (output_link[old] != (size_t)-1) ? renumber[output_link[old]] : (size_t)-1;
+        }
+
+        m_own_begin[state_count] = m_own.size();
+
+        _build_prefilter();
+    }
+
+    /**
+    *   \brief  Finds the bytes that can start a pattern and builds the tables for _charset_skip_ssse3().
+    *
+    *   \remarks
+    *       The tables can let through some bytes that can't start a pattern, but the automaton sorts
+    *       those out.
+    */
+    void _build_prefilter()
+    {
+        size_t start_count = 0;
+        for (size_t value = 0; value < 256; ++value)
+        {
+            m_start[value] = (sizeof(T) == 1) ? (m_next[m_byte_class[value]] != 0) : true;
+            start_count += m_start[value] ? 1 : 0;
+        }
+
+        // Skipping is only done on bytes, and only helps when some of them can be skipped.
+        m_prefilter = (sizeof(T) == 1 && start_count < 256);
+
+        _charset_tables(m_start, m_low_table, m_high_table);
+    }
+
+
+    /// Whether or not ASCII letters are matched regardless of case.
+    bool m_ignore_case;
+
+    /// The column of the table for each code unit below 256.
+    size_t m_byte_class[256];
+
+    /// The column of the table for each code unit above 255 that is used by a pattern, sorted by code unit.
+    std::vector<std::pair<uchar32_t, size_t> > m_wide_class;
+
+    /// The number of columns in the table.
+    size_t m_class_count;
+
+    /// The transition table. Every entry is the next state premultiplied by the number of columns.
+    std::vector<unsigned int> m_next;
+
+    /// The premultiplied number of the first state that has something to report.
+    size_t m_output_start;
+
+    /// The index in m_own of the patterns that end at each state.
+    std::vector<size_t> m_own_begin;
+
+    /// The patterns that end at each state.
+    std::vector<size_t> m_own;
+
+    /// The nearest state on the failure path of each state that has a pattern ending at it, or -1.
+    std::vector<size_t> m_output_link;
+
+    /// The length of each pattern.
+    std::vector<size_t> m_lengths;
+
+    /// Whether or not each byte can start a pattern.
+    bool m_start[256];
+
+    /// Whether or not code units that can't start a pattern are skipped.
+    bool m_prefilter;
+
+    /// The bucket masks for the low and high nibbles of the bytes that can start a pattern.
+    unsigned char m_low_table[16];
+    unsigned char m_high_table[16];
+};
+
+
+}
+}
+
+#endif // __EASL_SEARCH_MULTI_SEARCHER
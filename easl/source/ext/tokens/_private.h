@@ -8,13 +8,70 @@
 
 #include "../../findfirst.h"
 #include "../../equal.h"
+#include "../../encoding.h"
 
 namespace easl
 {
 
+/**
+*   \brief                    Retrieves the next character in a string that ends either at a pointer or at a null terminator.
+*   \param  str      [in, out]  The string to retrieve the character from.
+*   \param  strEnd   [in]       Pointer to the end of the string; or NULL if the string is null terminated.
+*   \param  encoding [in]       The encoding tag of the string. See encoding.h.
+*   \return                     The next character; or 0 if the end of the string has been reached.
+*
+*   \remarks
+*       When \c strEnd is not NULL, nothing at or past it is read. The string is then not moved when
+*       0 is returned for the end of the string or for an invalid character.
+*/
+template <typename T, int Encoding, bool Strict>
+inline uchar32_t _nextchar(T *&str, const T *strEnd, encoding_tag<Encoding, Strict> encoding)
+{
+    if (strEnd == NULL)
+    {
+        return nextchar(str, encoding);
+    }
+
+    return nextchar(str, strEnd, encoding);
+}
+
+/**
+*   \brief                    Determines if a string starts with the specified prefix.
+*   \param  str          [in] The string to check.
+*   \param  strEnd       [in] Pointer to the end of the string; or NULL if the string is null terminated.
+*   \param  prefix       [in] The prefix to look for.
+*   \param  prefixLength [in] The length in T's of the prefix.
+*   \return                   True if \c str starts with \c prefix; false otherwise.
+*
+*   \remarks
+*       The strings are compared T by T. Nothing past \c strEnd, or past the null terminator of \c str,
+*       is read.
+*/
+template <typename T>
+inline bool _starts_with(const T *str, const T *strEnd, const T *prefix, size_t prefixLength)
+{
+    if (strEnd != NULL && static_cast<size_t>(strEnd - str) < prefixLength)
+    {
+        return false;
+    }
+
+    // If the string is null terminated and shorter than the prefix, the null terminator won't match.
+    for (size_t i = 0; i < prefixLength; ++i)
+    {
+        if (str[i] != prefix[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
 /**
 *   \brief                   Checks if a string starts with a token in the specified token group.
 *   \param  str    [in, out] The string to check.
+*   \param  strEnd [in]      Pointer to the end of the string; or NULL if the string is null terminated.
 *   \param  groups [in]      The space seperated list of token groups.
 *   \return                  True if a token group is found; false otherwise.
 *
@@ -23,15 +80,13 @@ namespace easl
 *       character after the last character in the token group.
 */
 template <typename T>
-inline bool _check_token_group(T *&str, T *groups)
+inline bool _check_token_group(T *&str, const T *strEnd, T *groups)
 {
     if (groups == NULL)
     {
         return false;
     }
 
-    // TODO: This can be made more efficient. We should make it more specific and remove the easl::findfirst() calls.
-
     T *temp = groups;
 
     uchar32_t ch;
@@ -42,7 +97,7 @@ inline bool _check_token_group(T *&str, T *groups)
         {
             size_t char_size = temp - groups - 1;
 
-            if (easl::findfirst(str, groups, char_size, char_size) == str)
+            if (char_size > 0 && _starts_with(str, strEnd, groups, char_size))
             {
                 str += char_size;
                 return true;
@@ -54,7 +109,7 @@ inline bool _check_token_group(T *&str, T *groups)
 
     // We need to do one final check.
     size_t char_size = temp - groups;
-    if (easl::findfirst(str, groups, char_size, char_size) == str)
+    if (char_size > 0 && _starts_with(str, strEnd, groups, char_size))
     {
         str += char_size;
         return true;
@@ -67,6 +122,7 @@ inline bool _check_token_group(T *&str, T *groups)
 /**
 *   \brief                        Checks to see if a string starts with one of the strings in the specified starting ignore block string.
 *   \param  str         [in, out] The string to check.
+*   \param  strEnd      [in]      Pointer to the end of the string; or NULL if the string is null terminated.
 *   \param  blockStarts [in]      The string containing the ignore block starting strings.
 *   \param  start       [in]      Reference to the reference string that will recieve the starting ignore block string.
 *   \return                       True if a starting ignore block string is found; false otherwise.
@@ -75,7 +131,7 @@ inline bool _check_token_group(T *&str, T *groups)
 *       When this function returns true, the input string is moved to the end of the starting ignore block.
 */
 template <typename T>
-inline bool _check_ignore_block_start(T *&str, T *blockStarts, reference_string<T> &start)
+inline bool _check_ignore_block_start(T *&str, const T *strEnd, T *blockStarts, reference_string<T> &start)
 {
     assert(str != NULL);
 
@@ -86,7 +142,7 @@ inline bool _check_ignore_block_start(T *&str, T *blockStarts, reference_string<
 
     // The original input value.
     T *temp = str;
-    if (_check_token_group(temp, blockStarts))
+    if (_check_token_group(temp, strEnd, blockStarts))
     {
         // We found a starting block.
         start.start = str;
@@ -146,6 +202,7 @@ inline void _get_block(reference_string<T> &block, size_t index, T *blocks)
 /**
 *   \brief                        Checks to see if a matching ending block string is at the start of the specified string.
 *   \param  str         [in, out] The string to check.
+*   \param  strEnd      [in]      Pointer to the end of the string; or NULL if the string is null terminated.
 *   \param  start       [in]      The starting block string.
 *   \param  blockStarts [in]      The list of starting block strings.
 *   \param  blockEnds   [in]      The list of ending block strings.
@@ -155,7 +212,7 @@ inline void _get_block(reference_string<T> &block, size_t index, T *blocks)
 *       When this function returns true, the input string is moved to the end of the ending ignore block.
 */
 template <typename T>
-inline bool _check_ignore_block_end(T *&str, const reference_string<T> &start, T *blockStarts, T *blockEnds)
+inline bool _check_ignore_block_end(T *&str, const T *strEnd, const reference_string<T> &start, T *blockStarts, T *blockEnds)
 {
     assert(str != NULL);
 
@@ -179,7 +236,7 @@ inline bool _check_ignore_block_end(T *&str, const reference_string<T> &start, T
                 // Now we need to check the corresponding closing block.
                 reference_string<T> end = {NULL, NULL};
                 _get_block(end, index, blockEnds);
-                if (equal(str, end.start, true, length(end), length(end)))
+                if (end.start != NULL && _starts_with(str, strEnd, end.start, length(end)))
                 {
                     str += length(end);
                     return true;
@@ -31,9 +31,12 @@ template <typename T>
 void extracttokens(T *str, std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines,
                    const TOKEN_OPTIONS<T> *options, size_t strLength = -1)
 {
+    // The end of the string stays the same for each token, so we can't pass the length on to nexttoken().
+    const T *str_end = (strLength == (size_t)-1) ? NULL : str + strLength;
+
     reference_string<T> cur_token;
     size_t cur_line;
-    while (nexttoken(str, cur_token, &cur_line, options, strLength))
+    while (_nexttoken(str, str_end, cur_token, &cur_line, options, native_t()))
     {
         tokens.push_back(cur_token);
 
@@ -51,6 +54,24 @@ void extracttokens(T *str, std::vector<reference_string<T> > &tokens, std::vecto
     extracttokens(str, tokens, lines, (const TOKEN_OPTIONS<T> *)NULL, strLength);
 }
 
+/**
+*   \brief                 Extracts a list of tokens from the specified reference string.
+*   \param  str       [in] The string to tokenise.
+*   \param  tokens    [in] A reference to the list that will recieve the tokens.
+*   \param  lines     [in] A reference to the list that will recieve the lines of each token.
+*   \param  options   [in] The various options to use when extracting the tokens.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read.
+*/
+template <typename T>
+void extracttokens(const reference_string<T> &str, std::vector<reference_string<T> > &tokens, std::vector<size_t> *lines,
+                   const TOKEN_OPTIONS<T> *options = NULL)
+{
+    extracttokens(str.start, tokens, lines, options, length(str));
+}
+
 
 }
 }
@@ -8,6 +8,7 @@
 
 #include "../../reference_string.h"
 #include "../../findfirst.h"
+#include "../../charset.h"
 #include "_private.h"
 
 namespace easl
@@ -25,7 +26,7 @@ struct TOKEN_OPTIONS
     *   \brief  Constructor.
     */
     TOKEN_OPTIONS()
-        : symbolGroups(NULL), quotes(NULL), escapeCharacter('\0'), ignoreBlockStart(NULL), ignoreBlockEnd(NULL)
+        : symbolGroups(NULL), quotes(NULL), quoteSet(NULL), escapeCharacter('\0'), ignoreBlockStart(NULL), ignoreBlockEnd(NULL)
     {
     }
 
@@ -51,6 +52,15 @@ struct TOKEN_OPTIONS
     */
     T *quotes;
 
+    /**
+    *   \brief The prepared set of symbols that should be used for quotes.
+    *
+    *   When this is not NULL, it is used instead of \c quotes. Building the set once saves going
+    *   back over the \c quotes string for every symbol in the string being tokenised, which adds up
+    *   when the same options are used for many tokens.
+    */
+    const charset<T> *quoteSet;
+
     /**
     *   \brief The escape character.
     *
@@ -74,55 +84,42 @@ struct TOKEN_OPTIONS
     T *ignoreBlockEnd;
 };
 
+/**
+*   \brief                 Determines if a character is one of the quote characters of a set of token options.
+*   \param  options   [in] The token options.
+*   \param  character [in] The character to check.
+*   \return                True if the character starts a quote; false otherwise.
+*/
+template <typename T>
+inline bool _is_quote(const TOKEN_OPTIONS<T> &options, uchar32_t character)
+{
+    if (options.quoteSet != NULL)
+    {
+        return options.quoteSet->contains(character);
+    }
+
+    return options.quotes != NULL && findfirst(options.quotes, character) != NULL;
+}
+
 
 /**
-*   \brief                      Retrieves the next token and moves the pointer to the end of that token.
+*   \brief                      Retrieves the next token of a string and moves the pointer to the end of that token.
 *   \param  str       [in, out] The string to retrieve the next token from.
+*   \param  strEnd    [in]      Pointer to the end of the string; or NULL if the string is null terminated.
 *   \param  token     [out]     The reference string that will recieve the next token.
 *   \param  line      [out]     The integer that will recieve the zero based line that the token is on.
 *   \param  options   [in]      The various options to use when retrieving the next token.
-*   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
+*   \param  encoding  [in]      The encoding tag of the string. See encoding.h.
 *   \return                     True if a token is retrieved; false otherwise.
 *
 *   \remarks
-*       This function does not behave like strtok().
-*       \par
-*       The source string must be null terminated. When the null terminator is reached, the
-*       function will return false and the pointer will not be modified.
-*       \par
-*       When the token is retrieved, the input pointer is moved to the position just the
-*       end of the returned token and _not_ to the start of the next token. Therefore, when
-*       when the function returns, \c str == \c token.end.
-*       \par
-*       The line parameter is used to determine the line in the string that the token is
-*       found on. This is useful for things like source code parses so that they know the
-*       line that the token is on. This can then be used to output useful debug information
-*       or whatnot.
-*       \par
-*       A token is _always_ seperated by non-printable characters, spaces and tabs. If this
-*       is insufficient, use a different tokeniser. In addition, these non-printable
-*       characters, spaces and tabs will never be part of any tokens except those enclosed
-*       by quotes.
-*       \par
-*       Any non-letter and non-number is considered a symbol. Each symbol is it's own token.
-*       A group of symbols can be considered to be a single token by setting the \c symbolGroups
-*       string in the \c options structure.
-*       \par
-*       A quote is considered a single token. The quote symbols are included in the token.
-*       Quotes are useful for keeping the formatting of a particular part of the string. A quote
-*       character itself can be part of a quote, but must be preceeded by the escape character.
-*       The escape character is always included in the returned string.
-*       \par
-*       Sections of the string can be ignored by setting the \c ignoreBlockStart and
-*       \c ignoreBlockEnd strings in the \c options structure. If a starting ignore block string
-*       is found, but a matching ending ignore block string is not found before the null
-*       terminator, the section from the start of the ignore block to the end of the string is
-*       ignored.
+*       This is the implementation of nexttoken(). When \c strEnd is not NULL, nothing at or past it is read.
 *       \par
-*       When the function returns false, the input string is not modified.
+*       The tag is only used to decode the string itself. The strings in \c options are always decoded by T.
 */
-template <typename T>
-inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const TOKEN_OPTIONS<T> *options, size_t strLength = -1)
+template <typename T, int Encoding, bool Strict>
+inline bool _nexttoken(T *&str, const T *strEnd, reference_string<T> &token, size_t *line, const TOKEN_OPTIONS<T> *options,
+                       encoding_tag<Encoding, Strict> encoding)
 {
     assert(str != NULL);
 
@@ -160,7 +157,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
     // loop until we reach the end of the string or we break out of the loop.
     T *temp = str;
     uchar32_t ch;
-    while (strLength > 0 && (ch = nextchar(temp)) != '\0')
+    while ((ch = _nextchar(temp, strEnd, encoding)) != '\0')
     {
         // We need to check which character we've got. If it's a non-printable character,
         // we want to ignore it and continue to the next character.
@@ -186,7 +183,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
                 }
 
                 // It is valid for a new line character to be an ending ignore block.
-                if (options != NULL && _check_ignore_block_end(str, ignore_block_start, options->ignoreBlockStart, options->ignoreBlockEnd))
+                if (options != NULL && _check_ignore_block_end(str, strEnd, ignore_block_start, options->ignoreBlockStart, options->ignoreBlockEnd))
                 {
                     // We've reached the end of our ignore block, so now we can reset our type.
                     type = 0;
@@ -229,7 +226,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
                     token.start = str;
 
                     // If the character is a quote character, we are starting a quote.
-                    if (options != NULL && options->quotes != NULL && findfirst(options->quotes, ch) != NULL)
+                    if (options != NULL && _is_quote(*options, ch))
                     {
                         starting_quote_ch = ch;
                         type = 4;
@@ -245,7 +242,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
                         {
                             // Check the next character.
                             T *temp2 = temp;
-                            ch = nextchar(temp);
+                            ch = _nextchar(temp, strEnd, encoding);
                             if (ch >= '0' && ch <= '9')
                             {
                                 // We have a number, so now we just need to set the type.
@@ -269,7 +266,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
 
                             // Here we check to see if the token is part of a symbol group. If it is, we move to
                             // the end of the symbol group, set the appropriate variables and then return.
-                            if (options != NULL && _check_token_group(str, options->symbolGroups))
+                            if (options != NULL && _check_token_group(str, strEnd, options->symbolGroups))
                             {
                                 token.end = str;
                                 return true;
@@ -277,7 +274,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
 
                             // Here we need to check if we are at the start of an ignore block. We will also need
                             // to store the string that has opened the ignore block.
-                            if (options != NULL && _check_ignore_block_start(str, options->ignoreBlockStart, ignore_block_start))
+                            if (options != NULL && _check_ignore_block_start(str, strEnd, options->ignoreBlockStart, ignore_block_start))
                             {
                                 temp = str;
                                 type = 5;
@@ -314,7 +311,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
 
                         // We need to make sure that the character after the decimal point is also a number.
                         // If it isn't, the decimal point needs to be considered a seperate token.
-                        uchar32_t next_ch = nextchar(temp);
+                        uchar32_t next_ch = _nextchar(temp, strEnd, encoding);
                         if (!(next_ch >= '0' && next_ch <= '9'))
                         {
                             token.end = str;
@@ -347,7 +344,7 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
                 {
                     // We're in the ignore block, so we need to check if we've now got a matching ending
                     // ignore block string.
-                    if (options != NULL && _check_ignore_block_end(str, ignore_block_start, options->ignoreBlockStart, options->ignoreBlockEnd))
+                    if (options != NULL && _check_ignore_block_end(str, strEnd, ignore_block_start, options->ignoreBlockStart, options->ignoreBlockEnd))
                     {
                         // We've reached the end of our ignore block, so now we can reset our type.
                         temp = str;
@@ -362,7 +359,6 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
         }
 
         prev_ch = ch;
-        strLength -= charwidth<T>(ch);
     }
 
     // We now need to ensure that if we have a token, we return true.
@@ -375,16 +371,111 @@ inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const T
     return false;
 }
 
+
+/**
+*   \brief                      Retrieves the next token and moves the pointer to the end of that token.
+*   \param  str       [in, out] The string to retrieve the next token from.
+*   \param  token     [out]     The reference string that will recieve the next token.
+*   \param  line      [out]     The integer that will recieve the zero based line that the token is on.
+*   \param  options   [in]      The various options to use when retrieving the next token.
+*   \param  strLength [in]      The length in T's of the input string, not including the null terminator.
+*   \return                     True if a token is retrieved; false otherwise.
+*
+*   \remarks
+*       This function does not behave like strtok().
+*       \par
+*       The source string must be null terminated. When the null terminator is reached, the
+*       function will return false and the pointer will not be modified.
+*       \par
+*       When the token is retrieved, the input pointer is moved to the position just the
+*       end of the returned token and _not_ to the start of the next token. Therefore, when
+*       when the function returns, \c str == \c token.end.
+*       \par
+*       The line parameter is used to determine the line in the string that the token is
+*       found on. This is useful for things like source code parses so that they know the
+*       line that the token is on. This can then be used to output useful debug information
+*       or whatnot.
+*       \par
+*       A token is _always_ seperated by non-printable characters, spaces and tabs. If this
+*       is insufficient, use a different tokeniser. In addition, these non-printable
+*       characters, spaces and tabs will never be part of any tokens except those enclosed
+*       by quotes.
+*       \par
+*       Any non-letter and non-number is considered a symbol. Each symbol is it's own token.
+*       A group of symbols can be considered to be a single token by setting the \c symbolGroups
+*       string in the \c options structure.
+*       \par
+*       A quote is considered a single token. The quote symbols are included in the token.
+*       Quotes are useful for keeping the formatting of a particular part of the string. A quote
+*       character itself can be part of a quote, but must be preceeded by the escape character.
+*       The escape character is always included in the returned string.
+*       \par
+*       Sections of the string can be ignored by setting the \c ignoreBlockStart and
+*       \c ignoreBlockEnd strings in the \c options structure. If a starting ignore block string
+*       is found, but a matching ending ignore block string is not found before the null
+*       terminator, the section from the start of the ignore block to the end of the string is
+*       ignored.
+*       \par
+*       When the function returns false, the input string is not modified.
+*       \par
+*       If \c strLength is not -1, nothing past the first \c strLength T's of the string is read.
+*/
+template <typename T>
+inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const TOKEN_OPTIONS<T> *options, size_t strLength = -1)
+{
+    return _nexttoken(str, (strLength == (size_t)-1) ? NULL : str + strLength, token, line, options, native_t());
+}
+
+/**
+*   \brief                      Retrieves the next token of a string, decoding the string as described by an encoding tag.
+*   \param  str       [in, out] The string to retrieve the next token from.
+*   \param  token     [out]     The reference string that will recieve the next token.
+*   \param  line      [out]     The integer that will recieve the zero based line that the token is on.
+*   \param  options   [in]      The various options to use when retrieving the next token. Can be NULL.
+*   \param  strLength [in]      The length in T's of the string, not including the null terminator.
+*   \param  encoding  [in]      The encoding tag of the string. See encoding.h.
+*   \return                     True if a token is retrieved; false otherwise.
+*
+*   \remarks
+*       This works like the other nexttoken() overloads. With a strict tag, an invalid character ends the
+*       string the same way a null terminator does.
+*/
+template <typename T, int Encoding, bool Strict>
+inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, const TOKEN_OPTIONS<T> *options, size_t strLength,
+                      encoding_tag<Encoding, Strict> encoding)
+{
+    return _nexttoken(str, (strLength == (size_t)-1) ? NULL : str + strLength, token, line, options, encoding);
+}
+
 template <typename T>
 inline bool nexttoken(T *&str, reference_string<T> &token, size_t *line, size_t strLength = -1)
 {
     return nexttoken(str, token, line, (const TOKEN_OPTIONS<T> *)NULL, strLength);
 }
 
+/**
+*   \brief                      Retrieves the next token of a reference string and moves the start of the string to the end of that token.
+*   \param  str       [in, out] The string to retrieve the next token from.
+*   \param  token     [out]     The reference string that will recieve the next token.
+*   \param  line      [out]     The integer that will recieve the zero based line that the token is on.
+*   \param  options   [in]      The various options to use when retrieving the next token.
+*   \return                     True if a token is retrieved; false otherwise.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read, but a null character inside the string still ends it.
+*/
 template <typename T>
 inline bool nexttoken(reference_string<T> &str, reference_string<T> &token, size_t *line, const TOKEN_OPTIONS<T> *options)
 {
-    return nexttoken(str.start, token, line, options, length(str));
+    return _nexttoken(str.start, str.end, token, line, options, native_t());
+}
+
+template <typename T, int Encoding, bool Strict>
+inline bool nexttoken(reference_string<T> &str, reference_string<T> &token, size_t *line, const TOKEN_OPTIONS<T> *options,
+                      encoding_tag<Encoding, Strict> encoding)
+{
+    return _nexttoken(str.start, str.end, token, line, options, encoding);
 }
 
 template <typename T>
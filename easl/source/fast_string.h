@@ -0,0 +1,1023 @@
+/**
+*   \file   fast_string.h
+*   \author Dave Reid
+*   \brief  Fast string implementation of the string class.
+*
+*   The fast string implementation stores the length and capacity of the string alongside
+*   the pointer to its content. Retrieving the length of the string is a constant time
+*   operation, and appending to the string only reallocates when the capacity runs out.
+*   The capacity grows geometrically so that a series of appends takes linear time.
+*
+*   Short strings are stored inside the object itself rather than on the heap. By default
+*   there is room for 32 bytes worth of T's, including the null terminator. This can be
+*   changed by defining EASL_OPTION_FAST_STRING_LOCAL_BYTES.
+*
+*   Because the length is stored, the string can contain '\0' characters when assigned
+*   or appended with an explicit length. Functions that take a C-style string will still
+*   stop at the first one, however.
+*
+*   The string also keeps track of whether or not its contents are pure ASCII. This is
+*   checked with containsonlyascii() whenever the string changes, which only looks at
+*   the part that changed when appending. ASCII strings have one T per character, so
+*   getchar(), charcount() and findfirst() can skip decoding the string. slow_string
+*   can't do this because its buffer can be modified through c_str().
+*
+*   As with slow_string, defining EASL_OPTION_NON_VIRTUAL_STRING removes the virtual
+*   destructor and with it the vtable pointer.
+*
+*   Unlike slow_string, the class doesn't take an allocator. Strings that don't fit in the
+*   local buffer always go on the heap through heap_allocator, which get_allocator() returns.
+*/
+#ifndef __EASL_FAST_STRING_H_
+#define __EASL_FAST_STRING_H_
+
+#include <string.h>
+#include "allocator.h"
+#include "length.h"
+#include "copysize.h"
+#include "getchar.h"
+#include "charcount.h"
+#include "equal.h"
+#include "containsonlyascii.h"
+#include "findfirst.h"
+#include "tostring.h"
+
+#ifndef EASL_OPTION_FAST_STRING_LOCAL_BYTES
+#define EASL_OPTION_FAST_STRING_LOCAL_BYTES     32
+#endif
+
+namespace easl
+{
+
+template <typename T>
+class fast_string
+{
+public:
+
+    // Note: In the constructors, the string is initialised to the local buffer before
+    // assigning the string. assign() only ever frees memory that is not the local buffer.
+
+    /**
+    *   \brief  Default constructor.
+    */
+    fast_string() : data(local), len(0), cap(local_size - 1), ascii(true)
+    {
+        this->local[0] = '\0';
+    }
+
+    /**
+    *   \brief           Constructor.
+    *   \param  str [in] The string to initialise this string to.
+    */
+    fast_string(const T *str) : data(local), len(0), cap(local_size - 1), ascii(true)
+    {
+        this->local[0] = '\0';
+        this->assign(str);
+    }
+
+    fast_string(const reference_string<T> &str) : data(local), len(0), cap(local_size - 1), ascii(true)
+    {
+        this->local[0] = '\0';
+        this->assign(str.start, easl::length(str));
+    }
+
+#ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
+    template <typename U>
+    fast_string(const U *str) : data(local), len(0), cap(local_size - 1), ascii(true)
+    {
+        this->local[0] = '\0';
+        this->assign(str);
+    }
+
+    template <typename U>
+    fast_string(const reference_string<U> &str) : data(local), len(0), cap(local_size - 1), ascii(true)
+    {
+        this->local[0] = '\0';
+        this->assign(str.start, easl::length(str));
+    }
+#endif
+
+    /**
+    *   \brief           Constructor.
+    *   \param  str [in] The string to initialise this string to.
+    */
+    fast_string(const fast_string<T> &str) : data(local), len(0), cap(local_size - 1), ascii(true)
+    {
+        this->local[0] = '\0';
+        this->assign(str.c_str(), str.length());
+    }
+
+#ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
+    template <typename U>
+    fast_string(const fast_string<U> &str) : data(local), len(0), cap(local_size - 1), ascii(true)
+    {
+        this->local[0] = '\0';
+        this->assign(str.c_str(), str.length());
+    }
+#endif
+
+#ifdef EASL_HAS_RVALUE_REFERENCES
+    /**
+    *   \brief           Move constructor.
+    *   \param  str [in] The string to take the contents of.
+    *
+    *   \remarks
+    *       If \c str is on the heap, its buffer is taken without allocating or copying anything.
+    *       \c str is left as an empty string.
+    */
+    fast_string(fast_string<T> &&str) : data(local), len(0), cap(local_size - 1), ascii(true)
+    {
+        this->_take(str);
+    }
+#endif
+
+
+    /**
+    *   \brief  Destructor.
+    */
+#ifdef EASL_OPTION_NON_VIRTUAL_STRING
+    ~fast_string()
+#else
+    virtual ~fast_string()
+#endif
+    {
+        this->_free();
+    }
+
+
+
+    /**
+    *   \brief  Retrieves a pointer to the contents of the string.
+    *   \return A pointer to the contents of the string.
+    *
+    *   \remarks
+    *       The returned pointer is always NULL terminated. Unlike slow_string, there is no
+    *       non-constant version of this method because the string needs to keep track of
+    *       its own length.
+    */
+    const T * c_str() const
+    {
+        return this->data;
+    }
+
+    /**
+    *   \brief                 Assigns another string to this string.
+    *   \param  str       [in] The new string to assign to this string.
+    *   \param  strLength [in] The length of the input string, or -1 if the length is unknown.
+    *   \return                A reference to this string.
+    *
+    *   \remarks
+    *       If the length of the input string is known, set \c len to the length of the string.
+    *       This will prevent this string from manually retrieving the length of the string.
+    *       \par
+    *       Memory is only reallocated if the new string does not fit in the current capacity.
+    */
+    fast_string<T> & assign(const T *str, size_t strLength = -1)
+    {
+        if (this->data == str)
+        {
+            return *this;
+        }
+
+        // If the input string is NULL, we will set this string to an empty string.
+        if (str == NULL)
+        {
+            this->len   = 0;
+            this->ascii = true;
+            this->data[0] = '\0';
+
+            return *this;
+        }
+
+        if (strLength == (size_t)-1)
+        {
+            strLength = easl::length(str);
+        }
+
+        // The input string might be part of this string, in which case it will not be any longer than
+        // this string. There's no reallocation in that case, so we can just move it down.
+        if (strLength > this->cap)
+        {
+            this->_reallocate(strLength, false);
+        }
+
+        ::memmove(this->data, str, strLength * sizeof(T));
+
+        this->len   = strLength;
+        this->ascii = easl::containsonlyascii(this->data, strLength);
+        this->data[strLength] = '\0';
+
+        return *this;
+    }
+
+#ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
+    template <typename U>
+    fast_string<T> & assign(const U *str, size_t strLength = (size_t)-1)
+    {
+        if (str == NULL)
+        {
+            this->len   = 0;
+            this->ascii = true;
+            this->data[0] = '\0';
+
+            return *this;
+        }
+
+        // Note that strLength is the length of the input string in U's, whereas copy_size is
+        // the number of T's we need, including the null terminator.
+        size_t copy_size = easl::copysize<T>(str, strLength);
+        if (copy_size - 1 > this->cap)
+        {
+            this->_reallocate(copy_size - 1, false);
+        }
+
+        this->len   = easl::copy(this->data, str, copy_size, strLength) - 1;
+        this->ascii = easl::containsonlyascii(this->data, this->len);
+
+        return *this;
+    }
+#endif
+
+
+    /**
+    *   \brief                 Helper method for appending a string to this string.
+    *   \param  str       [in] The string to append to this string.
+    *   \param  strLength [in] The length in U's of \c str.
+    *   \return                A reference to this string.
+    *
+    *   \remarks
+    *       The \c len parameter should specify the number of T's in \c str and not
+    *       the number of characters.
+    */
+    fast_string<T> & append(const T *str, size_t strLength = -1)
+    {
+        if (str != NULL)
+        {
+            if (strLength == (size_t)-1)
+            {
+                strLength = easl::length(str);
+            }
+
+            // The input string might be part of this string, in which case we need to
+            // find it again after reallocating.
+            if (this->len + strLength > this->cap)
+            {
+                if (str >= this->data && str <= this->data + this->len)
+                {
+                    size_t offset = str - this->data;
+
+                    this->_grow(this->len + strLength);
+                    str = this->data + offset;
+                }
+                else
+                {
+                    this->_grow(this->len + strLength);
+                }
+            }
+
+            ::memmove(this->data + this->len, str, strLength * sizeof(T));
+
+            // Only the new part needs to be checked.
+            this->ascii = this->ascii && easl::containsonlyascii(this->data + this->len, strLength);
+
+            this->len += strLength;
+            this->data[this->len] = '\0';
+        }
+
+        return *this;
+    }
+
+#ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
+    template <typename U>
+    fast_string<T> & append(const U *str, size_t strLength = -1)
+    {
+        if (str != NULL)
+        {
+            // First we need to determine how much extra space we need to append the new string.
+            size_t copy_size = easl::copysize<T>(str, strLength);
+            if (this->len + copy_size - 1 > this->cap)
+            {
+                this->_grow(this->len + copy_size - 1);
+            }
+
+            // Now we copy our input string onto the end of our buffer. Only the new part needs to be checked.
+            size_t added_length = easl::copy(this->data + this->len, str, copy_size, strLength) - 1;
+
+            this->ascii = this->ascii && easl::containsonlyascii(this->data + this->len, added_length);
+            this->len  += added_length;
+        }
+
+        return *this;
+    }
+#endif
+
+    /**
+    *   \brief                  Appends an individual character to the string
+    *   \param  character [in]  The character to append.
+    *   \return                 A reference to this string.
+    */
+    fast_string<T> & append(uchar32_t character)
+    {
+        // writechar() will tell us how many T's it needs when we don't give it a buffer. This
+        // takes into account the replacement character for invalid characters.
+        size_t added_size = easl::writechar((T *)NULL, character);
+        if (this->len + added_size > this->cap)
+        {
+            this->_grow(this->len + added_size);
+        }
+
+        easl::writechar(this->data + this->len, character);
+
+        // Invalid characters are written as the replacement character, which isn't ASCII either.
+        this->ascii = this->ascii && character < 0x80;
+        this->len  += added_size;
+        this->data[this->len] = '\0';
+
+        return *this;
+    }
+
+    /**
+    *   \brief  Retrieves the length of this string.
+    *   \return The length of this string in T's.
+    *
+    *   \remarks
+    *       This function will return the number of T's in the string, and not necessarily the
+    *       number of characters. This is a constant time operation.
+    */
+    size_t length() const
+    {
+        return this->len;
+    }
+
+    /**
+    *   \brief  Retrieves the number of characters in this string.
+    *   \return The number of characters in this string.
+    *
+    *   \remarks
+    *       This is a constant time operation when the string is ASCII.
+    */
+    size_t charcount() const
+    {
+        if (this->ascii)
+        {
+            return this->len;
+        }
+
+        return easl::charcount(this->data, this->len);
+    }
+
+    /**
+    *   \brief  Determines if this string contains only ASCII characters.
+    *   \return True if every T in the string is below 0x80; false otherwise.
+    *
+    *   \remarks
+    *       This is a constant time operation. The result is kept up to date whenever the string changes.
+    */
+    bool containsonlyascii() const
+    {
+        return this->ascii;
+    }
+
+    /**
+    *   \brief  Retrieves the number of T's the string can hold without reallocating.
+    *   \return The capacity of the string in T's, not including the null terminator.
+    */
+    size_t capacity() const
+    {
+        return this->cap;
+    }
+
+    /**
+    *   \brief                Makes sure the string can hold a number of T's without reallocating.
+    *   \param  newCapacity [in] The number of T's to reserve room for, not including the null terminator.
+    *
+    *   \remarks
+    *       This will never shrink the string.
+    */
+    void reserve(size_t newCapacity)
+    {
+        if (newCapacity > this->cap)
+        {
+            this->_reallocate(newCapacity, true);
+        }
+    }
+
+    /**
+    *   \brief  Frees any memory that is not needed to store the string.
+    *
+    *   \remarks
+    *       A string that fits in the local buffer is moved back into it, and the heap buffer is freed.
+    */
+    void shrink_to_fit()
+    {
+        if (this->data == this->local || this->cap == this->len)
+        {
+            return;
+        }
+
+        if (this->len < local_size)
+        {
+            ::memcpy(this->local, this->data, (this->len + 1) * sizeof(T));
+            this->_free();
+
+            this->data = this->local;
+            this->cap  = local_size - 1;
+        }
+        else
+        {
+            this->_reallocate(this->len, true);
+        }
+    }
+
+
+    /**
+    *   \brief           Swaps the contents of this string with another string.
+    *   \param  str [in] The string to swap with.
+    *
+    *   \remarks
+    *       Strings on the heap just swap their pointers. Strings stored in the local buffer
+    *       need to be copied, but they are short.
+    */
+    void swap(fast_string<T> &str)
+    {
+        if (this != &str)
+        {
+            fast_string<T> temp;
+            temp._take(*this);
+            this->_take(str);
+            str._take(temp);
+        }
+    }
+
+    /**
+    *   \brief  Retrieves the allocator used for the string's memory.
+    *
+    *   \remarks
+    *       This is always heap_allocator. It's here so that code written for slow_string still builds.
+    */
+    heap_allocator get_allocator() const
+    {
+        return heap_allocator();
+    }
+
+
+    /**
+    *   \brief  Determines if the strings contains any characters.
+    *   \return True if the string does not contain any characters; false otherwise.
+    */
+    bool empty() const
+    {
+        return this->len == 0;
+    }
+
+
+    /**
+    *   \brief             Retrieves a character from the string.
+    *   \param  index [in] The index of the character to retrieve.
+    *   \return            The character if the index is valid, zero otherwise.
+    *
+    *   \remarks
+    *       For strings with variable length characters, this method can be quite slow
+    *       as it must iterate through each character. ASCII strings are indexed directly.
+    */
+    uchar32_t getchar(size_t index)
+    {
+        assert(this->len > index);
+
+        if (this->ascii)
+        {
+            return static_cast<uchar32_t>(this->data[index]);
+        }
+
+        return easl::getchar(this->data, index, this->len);
+    }
+
+
+    /**
+    *   \brief           Assignment operator.
+    *   \param  str [in] The string to assign to this string.
+    *   \return          A reference to this string.
+    *
+    *   \remarks
+    *       The C-style string must be null terminated.
+    */
+    fast_string<T> & operator =(const T *str)
+    {
+        return this->assign(str);
+    }
+    fast_string<T> & operator =(const fast_string<T> &str)
+    {
+        return this->assign(str.c_str(), str.length());
+    }
+    fast_string<T> & operator =(const reference_string<T> &str)
+    {
+        return this->assign(str.start, easl::length(str));
+    }
+
+#ifdef EASL_HAS_RVALUE_REFERENCES
+    /**
+    *   \brief           Move assignment operator.
+    *   \param  str [in] The string to take the contents of.
+    *   \return          A reference to this string.
+    *
+    *   \remarks
+    *       \c str is left as an empty string.
+    */
+    fast_string<T> & operator =(fast_string<T> &&str)
+    {
+        if (this != &str)
+        {
+            this->_release();
+            this->_take(str);
+        }
+
+        return *this;
+    }
+#endif
+
+#ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
+    template <typename U>
+    fast_string<T> & operator =(const U *str)
+    {
+        return this->assign(str);
+    }
+
+    /// \copydoc    fast_string::operator =(const T *)
+    template <typename U>
+    fast_string<T> & operator =(const fast_string<U> &str)
+    {
+        return this->assign(str.c_str(), str.length());
+    }
+
+    template <typename U>
+    fast_string<T> & operator =(const reference_string<U> &str)
+    {
+        return this->assign(str.start, easl::length(str));
+    }
+#endif
+
+
+    /**
+    *   \brief           Comparison operator.
+    *   \param  str [in] The string to compare this string siwth.
+    *   \return          True if the two strings are equal; false otherwise.
+    *
+    *   \remarks
+    *       The comparison is case sensitive. "Some String" does not equal "some string".
+    */
+    bool operator ==(const T *str) const
+    {
+        return easl::equal(this->data, str, true, this->len);
+    }
+    bool operator ==(const fast_string<T> &str) const
+    {
+        // Two strings of the same type can only be equal if they are the same length, and then only if
+        // they have the same T's.
+        return this->len == str.len && ::memcmp(this->data, str.data, this->len * sizeof(T)) == 0;
+    }
+    bool operator ==(const reference_string<T> &str) const
+    {
+        return this->len == easl::length(str) && easl::equal(this->data, str, true, this->len);
+    }
+    template <typename U, size_t N>
+    bool operator ==(const literal<U, N> &lit) const
+    {
+        return easl::equal(this->data, lit, true, this->len);
+    }
+
+#ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
+    template <typename U>
+    bool operator ==(const U *str) const
+    {
+        return easl::equal(this->data, str, true, this->len);
+    }
+
+    /// \copydoc    fast_string::operator ==(const U *) const
+    template <typename U>
+    bool operator ==(const fast_string<U> &str) const
+    {
+        // ASCII strings have the same code units in every encoding, so they can be compared directly.
+        if (this->ascii && str.containsonlyascii())
+        {
+            if (this->len != str.length())
+            {
+                return false;
+            }
+
+            const U *other = str.c_str();
+            for (size_t i = 0; i < this->len; ++i)
+            {
+                if (static_cast<uchar32_t>(this->data[i]) != static_cast<uchar32_t>(other[i]))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        return easl::equal(this->data, str.c_str(), true, this->len, str.length());
+    }
+
+    template <typename U>
+    bool operator ==(const reference_string<U> &str) const
+    {
+        return easl::equal(this->data, str, true, this->len);
+    }
+#endif
+
+    /**
+    *   \brief           Comparison operator.
+    *   \param  str [in] The string to compare this string siwth.
+    *   \return          True if the two strings are different; false otherwise.
+    *
+    *   \remarks
+    *       The comparison is case sensitive. "Some String" does not equal "some string".
+    */
+    bool operator !=(const T *str) const
+    {
+        return !(*this == str);
+    }
+    bool operator !=(const fast_string<T> &str) const
+    {
+        return !(*this == str);
+    }
+    bool operator !=(const reference_string<T> &str) const
+    {
+        return !(*this == str);
+    }
+    template <typename U, size_t N>
+    bool operator !=(const literal<U, N> &lit) const
+    {
+        return !(*this == lit);
+    }
+
+#ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
+    template <typename U>
+    bool operator !=(const U *str) const
+    {
+        return !(*this == str);
+    }
+
+    /// \copydoc    fast_string::operator ==(const U *) const
+    template <typename U>
+    bool operator !=(const fast_string<U> &str) const
+    {
+        return !(*this == str);
+    }
+
+    template <typename U>
+    bool operator !=(const reference_string<U> &str) const
+    {
+        return !(*this == str);
+    }
+#endif
+
+
+    /**
+    *   \brief           Appends a string to this string.
+    *   \param  str [in] The string to append to this string.
+    *   \return          A reference to this string.
+    *
+    *   \remarks
+    *       The C-style string must be null terminated.
+    */
+    fast_string<T> & operator +=(const T *str)
+    {
+        return this->append(str);
+    }
+    fast_string<T> & operator +=(const fast_string<T> &str)
+    {
+        return this->append(str.c_str(), str.length());
+    }
+    fast_string<T> & operator +=(const reference_string<T> &str)
+    {
+        return this->append(str.start, easl::length(str));
+    }
+
+#ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
+    template <typename U>
+    fast_string<T> & operator +=(const U *str)
+    {
+        return this->append(str);
+    }
+
+    /// \copydoc    fast_string::operator +=(const U *)
+    template <typename U>
+    fast_string<T> & operator +=(const fast_string<U> &str)
+    {
+        return this->append(str.c_str(), str.length());
+    }
+
+    template <typename U>
+    fast_string<T> & operator +=(const reference_string<U> &str)
+    {
+        return this->append(str.start, easl::length(str));
+    }
+#endif
+
+    /**
+    *   \brief                 Appends a character to this string.
+    *   \param  character [in] The character to append.
+    *   \return                A reference to this string.
+    */
+    fast_string<T> & operator +=(uchar32_t character)
+    {
+        return this->append(character);
+    }
+
+
+    /**
+    *   \brief           Creates a new string equal to another string appended to this string.
+    *   \param  str [in] The string to be appended to the end of the new string.
+    *   \return          A new string equal to this string with the input string appeneded to the end.
+    *
+    *   \remarks
+    *       The C-style string must be null terminated.
+    */
+    fast_string<T> operator +(const T *str) const
+    {
+        fast_string<T> new_str(*this);
+        return new_str += str;
+    }
+    fast_string<T> operator +(const fast_string<T> &str) const
+    {
+        fast_string<T> new_str(*this);
+        return new_str += str;
+    }
+    fast_string<T> operator +(const reference_string<T> &str) const
+    {
+        fast_string<T> new_str(*this);
+        return new_str += str;
+    }
+
+#ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
+    template <typename U>
+    fast_string<T> operator +(const U *str) const
+    {
+        fast_string<T> new_str(*this);
+        return new_str += str;
+    }
+
+    /// \copydoc    fast_string::operator +(const U *)
+    template <typename U>
+    fast_string<T> operator +(const fast_string<U> &str) const
+    {
+        fast_string<T> new_str(*this);
+        return new_str += str;
+    }
+
+    template <typename U>
+    fast_string<T> operator +(const reference_string<U> &str) const
+    {
+        fast_string<T> new_str(*this);
+        return new_str += str;
+    }
+#endif
+
+    /**
+    *   \brief                  Creates a new string equal to a character appended to this string.
+    *   \param  character [in]  The character to be appended to the end of the new string.
+    *   \return                 A new string equal to this string with the input character appeneded to the end.
+    */
+    fast_string<T> operator +(uchar32_t character) const
+    {
+        fast_string<T> new_str(*this);
+        return new_str += character;
+    }
+
+
+
+    /**
+    *   \brief             Inserts a value into the string.
+    *   \param  value [in] The value to insert into the string.
+    *   \return            A reference to this.
+    *
+    *   \remarks
+    *       This function uses the easl::tostring() function to convert the value to a string
+    *       before adding it to this. This converted string can not exceed 256 T's.
+    *       \par
+    *       This operator does not work reliably for individual characters. Use append() instead.
+    */
+    template <typename U>
+    fast_string<T> & operator << (const U &value)
+    {
+        T temp[256];
+        easl::tostring(value, temp);
+        return this->append(temp);
+    }
+
+    template <typename U>
+    fast_string<T> & operator << (U *value)
+    {
+        return this->append(value);
+    }
+
+    template <typename U>
+    fast_string<T> & operator << (const fast_string<U> &value)
+    {
+        return this->append(value.c_str(), value.length());
+    }
+
+    template <typename U>
+    fast_string<T> & operator << (const reference_string<U> &value)
+    {
+        return this->append(value.start, easl::length(value));
+    }
+
+
+private:
+
+    /**
+    *   \brief  Frees the heap buffer, if any, and makes the string an empty string in the local buffer.
+    */
+    void _release()
+    {
+        this->_free();
+
+        this->data     = this->local;
+        this->len      = 0;
+        this->cap      = local_size - 1;
+        this->ascii    = true;
+        this->local[0] = '\0';
+    }
+
+    /**
+    *   \brief           Takes the contents of another string, leaving it empty.
+    *   \param  str [in] The string to take the contents of.
+    *
+    *   \remarks
+    *       This string must be empty and using its local buffer.
+    */
+    void _take(fast_string<T> &str)
+    {
+        if (str.data == str.local)
+        {
+            ::memcpy(this->local, str.local, (str.len + 1) * sizeof(T));
+        }
+        else
+        {
+            this->data = str.data;
+            this->cap  = str.cap;
+        }
+
+        this->len   = str.len;
+        this->ascii = str.ascii;
+
+        str.data     = str.local;
+        str.len      = 0;
+        str.cap      = local_size - 1;
+        str.ascii    = true;
+        str.local[0] = '\0';
+    }
+
+    /**
+    *   \brief                    Grows the capacity of the string geometrically.
+    *   \param  minCapacity [in]  The minimum capacity that is required.
+    */
+    void _grow(size_t minCapacity)
+    {
+        // Doubling the capacity means that each T is moved a constant number of times on average
+        // over a series of appends.
+        size_t new_capacity = this->cap * 2 + 1;
+        if (new_capacity < minCapacity)
+        {
+            new_capacity = minCapacity;
+        }
+
+        this->_reallocate(new_capacity, true);
+    }
+
+    /**
+    *   \brief                    Moves the string to a new heap buffer.
+    *   \param  newCapacity [in]  The capacity of the new buffer, not including the null terminator.
+    *   \param  keepData    [in]  Whether or not the current contents need to be moved to the new buffer.
+    */
+    void _reallocate(size_t newCapacity, bool keepData)
+    {
+        T *new_data = static_cast<T *>(heap_allocator().allocate((newCapacity + 1) * sizeof(T)));
+
+        if (keepData)
+        {
+            ::memcpy(new_data, this->data, (this->len + 1) * sizeof(T));
+        }
+        else
+        {
+            new_data[0] = '\0';
+            this->len   = 0;
+            this->ascii = true;
+        }
+
+        this->_free();
+
+        this->data = new_data;
+        this->cap  = newCapacity;
+    }
+
+    /**
+    *   \brief  Frees the heap buffer, if any. The caller must point the string at another buffer afterwards.
+    */
+    void _free()
+    {
+        if (this->data != this->local)
+        {
+            heap_allocator().deallocate(this->data);
+        }
+    }
+
+
+    /// The number of T's that can be stored inside the object, including the null terminator.
+    enum { local_size = (EASL_OPTION_FAST_STRING_LOCAL_BYTES / sizeof(T) > 0) ? EASL_OPTION_FAST_STRING_LOCAL_BYTES / sizeof(T) : 1 };
+
+    /// Pointer to the content of the string. This points to local for short strings.
+    T *data;
+
+    /// The length of the string in T's, not including the null terminator.
+    size_t len;
+
+    /// The number of T's that can be stored in data, not including the null terminator.
+    size_t cap;
+
+    /// Whether or not every T in the string is below 0x80.
+    bool ascii;
+
+    /// The buffer for short strings.
+    T local[local_size];
+
+};
+
+/**
+*   \brief          Swaps the contents of two strings.
+*   \param  a [in]  The first string.
+*   \param  b [in]  The second string.
+*/
+template <typename T>
+inline void swap(fast_string<T> &a, fast_string<T> &b)
+{
+    a.swap(b);
+}
+
+/**
+*   \brief           Retrieves the number of characters in a string.
+*   \param  str [in] The string to check.
+*   \return          The number of characters in the string.
+*/
+template <typename T>
+inline size_t charcount(const fast_string<T> &str)
+{
+    return str.charcount();
+}
+
+/**
+*   \brief                 Finds the first occurance of a character inside a string.
+*   \param  str       [in] The string to be scanned.
+*   \param  character [in] The character to look for.
+*   \return                A pointer to the first occurance of the character; or NULL if it is not found.
+*
+*   \remarks
+*       When the string is ASCII, a character outside of ASCII is never found and anything else is a
+*       search for a single T.
+*/
+template <typename T>
+inline const T * findfirst(const fast_string<T> &str, uchar32_t character)
+{
+    if (str.containsonlyascii())
+    {
+        if (character >= 0x80)
+        {
+            return NULL;
+        }
+
+        const T *end = str.c_str() + str.length();
+        for (const T *temp = str.c_str(); temp < end; ++temp)
+        {
+            if (static_cast<uchar32_t>(*temp) == character)
+            {
+                return temp;
+            }
+        }
+
+        return NULL;
+    }
+
+    return findfirst(str.c_str(), character, str.length());
+}
+
+inline const char * findfirst(const fast_string<char> &str, uchar32_t character)
+{
+    if (str.containsonlyascii())
+    {
+        if (character >= 0x80)
+        {
+            return NULL;
+        }
+
+        return static_cast<const char *>(::memchr(str.c_str(), static_cast<int>(character), str.length()));
+    }
+
+    return findfirst(str.c_str(), character, str.length());
+}
+
+}
+
+#endif // __EASL_FAST_STRING_H_
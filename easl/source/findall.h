@@ -0,0 +1,267 @@
+/**
+*   \file   findall.h
+*   \author Dave Reid
+*   \brief  Header file for findall() and the match_range class.
+*/
+#ifndef __EASL_FINDALL_H_
+#define __EASL_FINDALL_H_
+
+#include <assert.h>
+#include <stddef.h>
+#include <iterator>
+#include "searcher.h"
+#include "length.h"
+#include "reference_string.h"
+
+namespace easl
+{
+
+/**
+*   \brief  A lazy range over every occurance of a searcher's pattern inside a string.
+*
+*   Occurances are found one at a time with searcher::find() as the range is iterated, and each
+*   one is returned as a reference_string pointing into the searched string. Nothing is allocated,
+*   so unlike split(), a range can be used to walk over or count occurances as they're needed:
+*
+*   \code
+*   easl::searcher<char> comma(",");
+*   easl::match_range<char, char> commas = easl::findall(line, comma);
+*   for (easl::match_range<char, char>::iterator i = commas.begin(); i != commas.end(); ++i)
+*   {
+*       ...
+*   }
+*   \endcode
+*
+*   Occurances don't overlap; the search for the next one starts at the end of the previous one.
+*   An empty pattern has no occurances.
+*
+*   T is the type of the searched string and U is the type of the searcher. They only differ in
+*   whether or not T is const.
+*
+*   The range only points to the string and the searcher, so both must stay valid for as long as
+*   the range or any of its iterators are used.
+*/
+template <typename T, typename U>
+class match_range
+{
+public:
+
+    /**
+    *   \brief  A forward iterator over the occurances in a match_range.
+    *
+    *   \remarks
+    *       The end iterator is the one that was default constructed. An iterator that moves past the last
+    *       occurance becomes equal to it.
+    */
+    class iterator
+    {
+    public:
+
+        typedef std::forward_iterator_tag iterator_category;
+        typedef reference_string<T>       value_type;
+        typedef ptrdiff_t                 difference_type;
+        typedef const reference_string<T> *pointer;
+        typedef const reference_string<T> &reference;
+
+
+        /**
+        *   \brief  Default constructor. This makes the end iterator.
+        */
+        iterator()
+            : m_pattern(NULL), m_strEnd(NULL)
+        {
+            m_match.start = NULL;
+            m_match.end   = NULL;
+        }
+
+        /**
+        *   \brief               Constructor. This finds the first occurance at or after \c str.
+        *   \param  pattern [in] The searcher to find the occurances with.
+        *   \param  str     [in] Pointer to the start of the string to search.
+        *   \param  strEnd  [in] Pointer to the end of the string to search.
+        */
+        iterator(const searcher<U> *pattern, T *str, T *strEnd)
+            : m_pattern(pattern), m_strEnd(strEnd)
+        {
+            assert(pattern != NULL);
+
+            _find(str);
+        }
+
+
+        /// Retrieves the current occurance.
+        reference operator*() const
+        {
+            return m_match;
+        }
+
+        /// Retrieves the current occurance.
+        pointer operator->() const
+        {
+            return &m_match;
+        }
+
+        /// Moves to the next occurance.
+        iterator & operator++()
+        {
+            assert(m_match.start != NULL);
+
+            _find(m_match.end);
+            return *this;
+        }
+
+        /// Moves to the next occurance.
+        iterator operator++(int)
+        {
+            iterator temp(*this);
+            ++(*this);
+
+            return temp;
+        }
+
+        /// Two iterators are equal if they are at the same occurance, or if they are both at the end.
+        bool operator==(const iterator &other) const
+        {
+            return m_match.start == other.m_match.start;
+        }
+
+        bool operator!=(const iterator &other) const
+        {
+            return m_match.start != other.m_match.start;
+        }
+
+
+    private:
+
+        /**
+        *   \brief            Finds the first occurance at or after \c str, or moves to the end if there isn't one.
+        *   \param  str [in]  Pointer to where the search should start.
+        */
+        void _find(T *str)
+        {
+            const U *found = NULL;
+            if (m_pattern->length() > 0)
+            {
+                found = m_pattern->find((const U *)str, (const U *)m_strEnd);
+            }
+
+            if (found != NULL)
+            {
+                m_match.start = (T *)found;
+                m_match.end   = m_match.start + m_pattern->length();
+            }
+            else
+            {
+                m_match.start = NULL;
+                m_match.end   = NULL;
+            }
+        }
+
+
+        /// The searcher that finds the occurances.
+        const searcher<U> *m_pattern;
+
+        /// Pointer to the end of the string being searched.
+        T *m_strEnd;
+
+        /// The current occurance. The start pointer is NULL at the end.
+        reference_string<T> m_match;
+    };
+
+    typedef iterator const_iterator;
+
+
+    /**
+    *   \brief               Constructor.
+    *   \param  pattern [in] The searcher to find the occurances with.
+    *   \param  str     [in] Pointer to the start of the string to search.
+    *   \param  strEnd  [in] Pointer to the end of the string to search.
+    */
+    match_range(const searcher<U> &pattern, T *str, T *strEnd)
+        : m_pattern(&pattern), m_str(str), m_strEnd(strEnd)
+    {
+        assert(str != NULL);
+        assert(str <= strEnd);
+    }
+
+
+    /**
+    *   \brief  Retrieves an iterator at the first occurance.
+    *
+    *   \remarks
+    *       The first occurance is searched for every time this is called.
+    */
+    iterator begin() const
+    {
+        return iterator(m_pattern, m_str, m_strEnd);
+    }
+
+    /**
+    *   \brief  Retrieves the end iterator.
+    */
+    iterator end() const
+    {
+        return iterator();
+    }
+
+    /**
+    *   \brief  Determines whether or not the pattern occurs in the string at all.
+    */
+    bool empty() const
+    {
+        return begin() == end();
+    }
+
+
+private:
+
+    /// The searcher that finds the occurances.
+    const searcher<U> *m_pattern;
+
+    /// Pointer to the start of the string being searched.
+    T *m_str;
+
+    /// Pointer to the end of the string being searched.
+    T *m_strEnd;
+};
+
+
+/**
+*   \brief                 Retrieves a range over every occurance of a prepared pattern inside a string.
+*   \param  str       [in] The string to be scanned.
+*   \param  pattern   [in] The pattern to look for.
+*   \param  strLength [in] The length in T's of the string to be scanned, not including the null terminator.
+*   \return                A match_range over the occurances.
+*
+*   \remarks
+*       The string ends at its first null character. The end is found here, but the occurances are only
+*       searched for as the range is iterated.
+*/
+template <typename T, typename U>
+inline match_range<T, U> findall(T *str, const searcher<U> &pattern, size_t strLength = -1)
+{
+    assert(str != NULL);
+
+    return match_range<T, U>(pattern, str, str + ((strLength == (size_t)-1) ? length(str) : length(str, strLength)));
+}
+
+/**
+*   \brief                 Retrieves a range over every occurance of a prepared pattern inside a reference string.
+*   \param  str       [in] The string to be scanned.
+*   \param  pattern   [in] The pattern to look for.
+*   \return                A match_range over the occurances.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read.
+*/
+template <typename T, typename U>
+inline match_range<T, U> findall(const reference_string<T> &str, const searcher<U> &pattern)
+{
+    return match_range<T, U>(pattern, str.start, str.end);
+}
+
+
+}
+
+#endif // __EASL_FINDALL_H_
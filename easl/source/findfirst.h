@@ -7,36 +7,142 @@
 #define __EASL_FINDFIRST_H_
 
 #include <string.h>
+#include <wchar.h>
 #include "getchar.h"
 #include "compare.h"
 #include "charwidth.h"
 #include "nextchar.h"
+#include "writechar.h"
+#include "encoding.h"
 #include "length.h"
+#include "literal.h"
+#include "searcher.h"
 
 namespace easl
 {
 
+/**
+*   \brief                 Encodes a character the same way nextchar() decodes a string of T's.
+*   \param  character [in]  The character to encode.
+*   \param  units     [out] Receives the encoded character.
+*   \return                The number of T's in the encoded character; or 0 if the character can't be
+*                          looked for T by T.
+*
+*   \remarks
+*       Null characters, surrogates and values outside of Unicode are never encoded, since they can't
+*       be found without decoding the string.
+*/
+template <typename T>
+inline size_t _findfirst_encode(uchar32_t character, T (&units)[4])
+{
+    if (character == 0 || character > UNI_MAX_LEGAL_UTF32 || (character >= UNI_SUR_HIGH_START && character <= UNI_SUR_LOW_END))
+    {
+        return 0;
+    }
+
+#ifdef EASL_ONLY_ASCII
+    // Every T is a character by itself, but anything above ASCII is sign extended when T is signed.
+    if (sizeof(T) <= 2 && character >= 0x80)
+    {
+        return 0;
+    }
+
+    units[0] = static_cast<T>(character);
+    return 1;
+#else
+    T *dest = units;
+    return writechar(dest, character);
+#endif
+}
+
+/**
+*   \brief                 Finds the first occurance of a character inside a string by looking for its encoded form.
+*   \param  str       [in] The string to look for the character in.
+*   \param  character [in] The character to look for.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*   \return                If the character is found, returns a pointer to that character. Otherwise, a NULL pointer is returned.
+*
+*   \remarks
+*       UTF-8 and UTF-16 are self-synchronising, so the encoded character can only be found at the start
+*       of a character. This means the string never needs to be decoded: an ASCII character in a UTF-8
+*       string is a single memchr(), and anything else is a vectorised search for its first and last
+*       code unit.
+*       \par
+*       Unlike the decoding loop, an invalid sequence before the character does not end the search.
+*       Characters that can't be encoded fall back to decoding.
+*/
+template <typename T>
+inline const T * _findfirst_encoded(const T *str, uchar32_t character, size_t strLength)
+{
+    assert(str != NULL);
+
+    T units[4];
+    size_t count = _findfirst_encode(character, units);
+    if (count == 0)
+    {
+        return findfirst(str, character, strLength, native_t());
+    }
+
+    // strchr() stops at the null terminator by itself, so the length isn't needed.
+    if (sizeof(T) == 1 && count == 1 && strLength == (size_t)-1)
+    {
+        return reinterpret_cast<const T *>(::strchr(reinterpret_cast<const char *>(str), static_cast<unsigned char>(units[0])));
+    }
+
+    const T *strEnd = str + ((strLength == (size_t)-1) ? length(str) : length(str, strLength));
+
+    return _findfirst_units(str, strEnd, units, count);
+}
+
 /**
 *   \brief                 Finds the first occurance of a character inside a string.
 *   \param  str       [in] The string to look for the character in.
 *   \param  character [in] The character to look for.
 *   \param  strLength [in] The length in T's of the string, not including the null terminator.
 *   \return                If the character is found, returns a pointer to that character. Otherwise, a NULL pointer is returned.
+*
+*   \remarks
+*       The string is not decoded. Instead, the character is encoded once and its code units are
+*       searched for directly. See _findfirst_encoded().
 */
 template <typename T>
 inline T * findfirst(T *str, uchar32_t character, size_t strLength = -1)
+{
+    return (T *)_findfirst_encoded((const T *)str, character, strLength);
+}
+
+/**
+*   \brief                 Finds the first occurance of a character inside a string, decoding the string as described by an encoding tag.
+*   \param  str       [in] The string to look for the character in.
+*   \param  character [in] The character to look for.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*   \param  encoding  [in] The encoding tag of the string. See encoding.h.
+*   \return                If the character is found, returns a pointer to that character. Otherwise, a NULL pointer is returned.
+*
+*   \remarks
+*       The search stops at the first null character, and with a strict tag, at the first invalid character.
+*/
+template <typename T, int Encoding, bool Strict>
+inline T * findfirst(T *str, uchar32_t character, size_t strLength, encoding_tag<Encoding, Strict> encoding)
 {
     T *temp = str;
 
     uchar32_t ch;
-    while (strLength > 0 && (ch = nextchar(temp)) != '\0')
+    while (strLength > 0 && (ch = nextchar(temp, encoding)) != '\0')
     {
+        // A character that is cut off by the end of the string is not part of it.
+        size_t width = temp - str;
+        if (width > strLength)
+        {
+            break;
+        }
+
         if (ch == character)
         {
             return str;
         }
 
-        strLength -= temp - str;
+        strLength -= width;
         str = temp;
     }
 
@@ -63,10 +169,61 @@ inline wchar_t * findfirst(wchar_t *str, uchar32_t character)
     return ::wcschr(str, (wchar_t)character);
 }
 
+/**
+*   \brief                 Finds the first occurance of a character between two pointers.
+*   \param  str       [in] Pointer to the start of the string.
+*   \param  strEnd    [in] Pointer to the end of the string.
+*   \param  character [in] The character to look for.
+*   \return                A pointer to the character if it is found; NULL otherwise.
+*
+*   \remarks
+*       Null characters are treated like any other character and nothing at or past \c strEnd is read.
+*/
+template <typename T>
+inline const T * _findfirst_span(const T *str, const T *strEnd, uchar32_t character)
+{
+    T units[4];
+    size_t count = _findfirst_encode(character, units);
+    if (count != 0)
+    {
+        return _findfirst_units(str, strEnd, units, count);
+    }
+
+    while (str < strEnd)
+    {
+        const T *next = str;
+        uchar32_t ch = nextchar(next, strEnd);
+
+        if (next == str)
+        {
+            break;
+        }
+
+        if (ch == character)
+        {
+            return str;
+        }
+
+        str = next;
+    }
+
+    return NULL;
+}
+
+/**
+*   \brief                 Finds the first occurance of a character inside a reference string.
+*   \param  str       [in] The string to look for the character in.
+*   \param  character [in] The character to look for.
+*   \return                If the character is found, returns a pointer to that character. Otherwise, a NULL pointer is returned.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read.
+*/
 template <typename T>
 inline T * findfirst(const reference_string<T> &str, uchar32_t character)
 {
-    return findfirst(str.start, character, length(str));
+    return (T *)_findfirst_span((const T *)str.start, (const T *)str.end, character);
 }
 
 
@@ -77,6 +234,11 @@ inline T * findfirst(const reference_string<T> &str, uchar32_t character)
 *   \param  str1Length [in] The length in T's of the first string, not including the null terminator.
 *   \param  str2Length [in] The length in T's of the first string, not including the null terminator.
 *   \return                 A pointer to the first occurance of \c str2; or NULL if the string is not found.
+*
+*   \remarks
+*       The search stops at the first null character in \c str1. This builds a searcher for \c str2
+*       every time it's called; when the same string is searched for repeatedly, construct a searcher
+*       once and use findfirst(T *, const searcher<U> &, size_t) instead.
 */
 template <typename T>
 inline const T * findfirst(const T *str1, const T *str2, size_t str1Length = -1, size_t str2Length = -1)
@@ -89,24 +251,7 @@ inline const T * findfirst(const T *str1, const T *str2, size_t str1Length = -1,
         return str1;
     }
 
-    // We need to know the length of the second string.
-    if (str2Length == (size_t)-1)
-    {
-        str2Length = length(str2);
-    }
-
-    // Grab the first character of our second string.
-    uchar32_t first_char = easl::getchar(str2, 0);
-
-    for ( ; (str1 = findfirst(str1, first_char, str1Length)) != NULL; nextchar(str1))
-    {
-        if (compare(str1, str2, str2Length) == 0)
-        {
-            return str1;
-        }
-    }
-
-    return NULL;
+    return searcher<T>(str2, str2Length).find(str1, str1Length);
 }
 
 // Optimized case.
@@ -139,10 +284,96 @@ inline wchar_t * findfirst(wchar_t *str1, const wchar_t *str2)
 }
 
 
+/**
+*   \brief                   Finds a string between two pointers inside another string between two pointers.
+*   \param  str1       [in]  Pointer to the start of the string to be scanned.
+*   \param  str1End    [in]  Pointer to the end of the string to be scanned.
+*   \param  str2       [in]  Pointer to the start of the string to look for.
+*   \param  str2End    [in]  Pointer to the end of the string to look for.
+*   \return                  A pointer to the first occurance of \c str2; or NULL if the string is not found.
+*
+*   \remarks
+*       Neither string needs to be null terminated. Since both strings have the same encoding, they are
+*       compared T by T with a searcher. A valid \c str2 can only be found at the start of a character.
+*/
+template <typename T>
+inline const T * _findfirst_span(const T *str1, const T *str1End, const T *str2, const T *str2End)
+{
+    return searcher<T>(str2, str2End - str2).find(str1, str1End);
+}
+
+/**
+*   \brief                 Finds the first occurance of a prepared pattern inside a string.
+*   \param  str       [in] The string to be scanned.
+*   \param  pattern   [in] The pattern to look for.
+*   \param  strLength [in] The length in T's of the string to be scanned, not including the null terminator.
+*   \return                A pointer to the first occurance of the pattern; or NULL if it is not found.
+*
+*   \remarks
+*       The search stops at the first null character in \c str.
+*/
+template <typename T, typename U>
+inline T * findfirst(T *str, const searcher<U> &pattern, size_t strLength = -1)
+{
+    return (T *)pattern.find((const U *)str, strLength);
+}
+
+/**
+*   \brief                 Finds the first occurance of a prepared pattern inside a reference string.
+*   \param  str       [in] The string to be scanned.
+*   \param  pattern   [in] The pattern to look for.
+*   \return                A pointer to the first occurance of the pattern; or NULL if it is not found.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read.
+*/
+template <typename T, typename U>
+inline T * findfirst(const reference_string<T> &str, const searcher<U> &pattern)
+{
+    return (T *)pattern.find((const U *)str.start, (const U *)str.end);
+}
+
+/**
+*   \brief                   Finds a reference string from within another reference string.
+*   \param  str1       [in]  The string to be scanned.
+*   \param  str2       [in]  The string to look for inside \c str1.
+*   \return                  A pointer to the first occurance of \c str2; or NULL if the string is not found.
+*
+*   \remarks
+*       Neither string needs to be null terminated. Nothing at or past the end of either string is read.
+*/
 template <typename T>
 inline T * findfirst(const reference_string<T> &str1, const reference_string<T> &str2)
 {
-    return findfirst(str1.start, str2.start, length(str1), length(str2));
+    return (T *)_findfirst_span((const T *)str1.start, (const T *)str1.end, (const T *)str2.start, (const T *)str2.end);
+}
+
+/**
+*   \brief                 Finds the first occurance of a literal inside a string.
+*   \param  str       [in] The string to be scanned.
+*   \param  lit       [in] The literal to look for.
+*   \param  strLength [in] The length in T's of the string to be scanned, not including the null terminator.
+*   \return                A pointer to the first occurance of \c lit; or NULL if it is not found.
+*
+*   \remarks
+*       The version of the literal with the same encoding as \c str is searched for, so the literal never
+*       needs to be transcoded.
+*/
+template <typename T, typename U, size_t N>
+inline T * findfirst(T *str, const literal<U, N> &lit, size_t strLength = -1)
+{
+    reference_string<const T> other = _literal_string(lit, static_cast<const T *>(NULL));
+
+    return (T *)findfirst((const T *)str, other.start, strLength, length(other));
+}
+
+template <typename T, typename U, size_t N>
+inline T * findfirst(const reference_string<T> &str, const literal<U, N> &lit)
+{
+    reference_string<const T> other = _literal_string(lit, static_cast<const T *>(NULL));
+
+    return (T *)_findfirst_span((const T *)str.start, (const T *)str.end, other.start, other.end);
 }
 
 
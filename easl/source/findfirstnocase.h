@@ -0,0 +1,296 @@
+/**
+*   \file   findfirstnocase.h
+*   \author Dave Reid
+*   \brief  Header file for findfirstnocase() implementations.
+*/
+#ifndef __EASL_FINDFIRSTNOCASE_H_
+#define __EASL_FINDFIRSTNOCASE_H_
+
+#include <assert.h>
+#include "casefold.h"
+#include "length.h"
+#include "literal.h"
+#include "reference_string.h"
+
+namespace easl
+{
+
+/**
+*   \brief               Finds the first of two code units between two pointers.
+*   \param  str    [in]  Pointer to the start of the string to search.
+*   \param  strEnd [in]  Pointer to the end of the string to search.
+*   \param  unit1  [in]  The first code unit to look for.
+*   \param  unit2  [in]  The second code unit to look for.
+*   \return              A pointer to the first occurance of either code unit; or NULL if neither is found.
+*/
+template <typename T>
+inline const T * _findfirst_either_unit(const T *str, const T *strEnd, T unit1, T unit2)
+{
+#if defined(EASL_SIMD_SSE2)
+    if (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)
+    {
+        const size_t  width   = sizeof(T);
+        const size_t  block   = 16 / width;
+        const __m128i needle1 = _searcher_broadcast(static_cast<uchar32_t>(unit1), width);
+        const __m128i needle2 = _searcher_broadcast(static_cast<uchar32_t>(unit2), width);
+
+        while (static_cast<size_t>(strEnd - str) >= block)
+        {
+            __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str));
+
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+                _mm_or_si128(_searcher_cmpeq(input, needle1, width), _searcher_cmpeq(input, needle2, width))));
+
+            if (mask != 0)
+            {
+                return str + _bitscan_forward(mask) / width;
+            }
+
+            str += block;
+        }
+    }
+#endif
+
+    for ( ; str < strEnd; ++str)
+    {
+        if (*str == unit1 || *str == unit2)
+        {
+            return str;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+*   \brief               Finds the first code unit outside of ASCII between two pointers.
+*   \param  str    [in]  Pointer to the start of the string to search.
+*   \param  strEnd [in]  Pointer to the end of the string to search.
+*   \return              A pointer to the first code unit outside of ASCII; or \c strEnd if there isn't one.
+*/
+template <typename T>
+inline const T * _skip_ascii(const T *str, const T *strEnd)
+{
+#if defined(EASL_SIMD_SSE2)
+    if (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)
+    {
+        const size_t  width = sizeof(T);
+        const size_t  block = 16 / width;
+        const __m128i mask  = _ascii_mask(width);
+        const __m128i zero  = _mm_setzero_si128();
+
+        while (static_cast<size_t>(strEnd - str) >= block)
+        {
+            unsigned int ascii = static_cast<unsigned int>(_mm_movemask_epi8(
+                _mm_cmpeq_epi8(_mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(str)), mask), zero)));
+
+            if (ascii != 0xFFFF)
+            {
+                return str + _bitscan_forward(~ascii) / width;
+            }
+
+            str += block;
+        }
+    }
+#endif
+
+    while (str < strEnd && _literal_unit(*str) < 0x80)
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+/**
+*   \brief                  Determines if a string starts with another string without regard to case.
+*   \param  str        [in] Pointer to the start of the string to check.
+*   \param  strEnd     [in] Pointer to the end of the string to check.
+*   \param  pattern    [in] Pointer to the start of the string to look for.
+*   \param  patternEnd [in] Pointer to the end of the string to look for.
+*   \return                 True if \c str starts with \c pattern; false otherwise.
+*/
+template <typename T>
+inline bool _startswith_nocase(const T *str, const T *strEnd, const T *pattern, const T *patternEnd)
+{
+    for (;;)
+    {
+        size_t count1 = strEnd - str;
+        size_t count2 = patternEnd - pattern;
+
+        size_t skipped = _casefold_skip_blocks(str, pattern, (count1 < count2) ? count1 : count2);
+        str     += skipped;
+        pattern += skipped;
+
+        const T *block_end = pattern + 16 / sizeof(T);
+        if (block_end > patternEnd)
+        {
+            block_end = patternEnd;
+        }
+
+        do
+        {
+            if (pattern == patternEnd)
+            {
+                return true;
+            }
+
+            if (str == strEnd || _casefold_next(str, strEnd) != _casefold_next(pattern, patternEnd))
+            {
+                return false;
+            }
+        } while (pattern < block_end);
+    }
+}
+
+/**
+*   \brief                  Finds a string between two pointers inside another string without regard to case.
+*   \param  str        [in] Pointer to the start of the string to be scanned.
+*   \param  strEnd     [in] Pointer to the end of the string to be scanned.
+*   \param  pattern    [in] Pointer to the start of the string to look for.
+*   \param  patternEnd [in] Pointer to the end of the string to look for.
+*   \return                 A pointer to the first occurance of \c pattern; or NULL if it is not found.
+*
+*   \remarks
+*       Only the start of a character can be the start of an occurance. When the pattern starts with an
+*       ASCII character, only the two ASCII code units that fold to it are looked for, a register at a
+*       time. The exceptions are 'k' and 's', which U+212A KELVIN SIGN and U+017F LATIN SMALL LETTER LONG S
+*       also fold to. A pattern that starts with any other character can only start on a code unit
+*       outside of ASCII, so runs of ASCII are skipped.
+*       \par
+*       Every candidate is checked from the start, so the time taken can grow with the length of the
+*       string times the length of the pattern.
+*/
+template <typename T>
+inline const T * _findfirst_nocase(const T *str, const T *strEnd, const T *pattern, const T *patternEnd)
+{
+    if (pattern == patternEnd)
+    {
+        return str;
+    }
+
+    const T *temp_pattern = pattern;
+    uchar32_t first = _casefold_next(temp_pattern, patternEnd);
+
+    if (first < 0x80 && first != 'k' && first != 's')
+    {
+        T lower = static_cast<T>(first);
+        T upper = (first >= 'a' && first <= 'z') ? static_cast<T>(first - ('a' - 'A')) : lower;
+
+        while ((str = _findfirst_either_unit(str, strEnd, lower, upper)) != NULL)
+        {
+            if (_startswith_nocase(str, strEnd, pattern, patternEnd))
+            {
+                return str;
+            }
+
+            ++str;
+        }
+
+        return NULL;
+    }
+
+    while (str < strEnd)
+    {
+        if (first >= 0x80)
+        {
+            str = _skip_ascii(str, strEnd);
+            if (str == strEnd)
+            {
+                break;
+            }
+        }
+
+        if (_startswith_nocase(str, strEnd, pattern, patternEnd))
+        {
+            return str;
+        }
+
+        _casefold_next(str, strEnd);
+    }
+
+    return NULL;
+}
+
+
+/**
+*   \brief                     Finds the first occurance of a string from within another string without regard to case.
+*   \param  str           [in] The string to be scanned.
+*   \param  pattern       [in] The string to look for inside \c str.
+*   \param  strLength     [in] The length in T's of the string to be scanned, not including the null terminator.
+*   \param  patternLength [in] The length in T's of the string to look for, not including the null terminator.
+*   \return                    A pointer to the first occurance of \c pattern; or NULL if the string is not found.
+*
+*   \remarks
+*       This is the case insensitive version of findfirst(const T *, const T *, size_t, size_t). Characters are
+*       compared by their simple case folding (see casefold()), so "content-type" is found in
+*       "Content-Type: text/html". Both strings end at their first null character, and an empty
+*       pattern is found at the start of the string.
+*/
+template <typename T>
+inline const T * findfirstnocase(const T *str, const T *pattern, size_t strLength = -1, size_t patternLength = -1)
+{
+    assert(str != NULL);
+    assert(pattern != NULL);
+
+    const T *str_end     = str + ((strLength == (size_t)-1) ? length(str) : length(str, strLength));
+    const T *pattern_end = pattern + ((patternLength == (size_t)-1) ? length(pattern) : length(pattern, patternLength));
+
+    return _findfirst_nocase(str, str_end, pattern, pattern_end);
+}
+
+template <typename T>
+inline T * findfirstnocase(T *str, const T *pattern, size_t strLength = -1, size_t patternLength = -1)
+{
+    return (T *)findfirstnocase((const T *)str, pattern, strLength, patternLength);
+}
+
+/**
+*   \brief                  Finds the first occurance of a reference string from within another reference string without regard to case.
+*   \param  str        [in] The string to be scanned.
+*   \param  pattern    [in] The string to look for inside \c str.
+*   \return                 A pointer to the first occurance of \c pattern; or NULL if the string is not found.
+*
+*   \remarks
+*       Neither string needs to be null terminated. Nothing at or past the end of either string is read.
+*/
+template <typename T>
+inline T * findfirstnocase(const reference_string<T> &str, const reference_string<T> &pattern)
+{
+    return (T *)_findfirst_nocase((const T *)str.start, (const T *)str.end, (const T *)pattern.start, (const T *)pattern.end);
+}
+
+/**
+*   \brief                 Finds the first occurance of a literal inside a string without regard to case.
+*   \param  str       [in] The string to be scanned.
+*   \param  lit       [in] The literal to look for.
+*   \param  strLength [in] The length in T's of the string to be scanned, not including the null terminator.
+*   \return                A pointer to the first occurance of \c lit; or NULL if it is not found.
+*
+*   \remarks
+*       The version of the literal with the same encoding as \c str is searched for, so the literal never
+*       needs to be transcoded.
+*/
+template <typename T, typename U, size_t N>
+inline T * findfirstnocase(T *str, const literal<U, N> &lit, size_t strLength = -1)
+{
+    assert(str != NULL);
+
+    reference_string<const T> other = _literal_string(lit, static_cast<const T *>(NULL));
+    const T *str_end = str + ((strLength == (size_t)-1) ? length(str) : length(str, strLength));
+
+    return (T *)_findfirst_nocase((const T *)str, str_end, other.start, other.end);
+}
+
+template <typename T, typename U, size_t N>
+inline T * findfirstnocase(const reference_string<T> &str, const literal<U, N> &lit)
+{
+    reference_string<const T> other = _literal_string(lit, static_cast<const T *>(NULL));
+
+    return (T *)_findfirst_nocase((const T *)str.start, (const T *)str.end, other.start, other.end);
+}
+
+
+}
+
+#endif // __EASL_FINDFIRSTNOCASE_H_
@@ -7,7 +7,9 @@
 #define __EASL_FINDFIRSTOF_H_
 
 #include <string.h>
+#include <wchar.h>
 #include "findfirst.h"
+#include "charset.h"
 
 namespace easl
 {
@@ -36,40 +38,84 @@ inline T * findfirstof(T *str, uchar32_t character, size_t strLength = -1)
 *   \param  strLength [in] The length in T's of the string, not including the null terminator.
 *   \param  setLength [in] The length in T's of the character set string, not including the null terminator.
 *   \return                A pointer in \c str to the first occurance of any character in \c charSet; or NULL if no characters are found.
+*
+*   \remarks
+*       When the set has no more than four characters, each one is encoded and searched for in turn
+*       the same way as findfirst(T *, uchar32_t, size_t), with every search stopping where the best
+*       match so far starts. Larger sets are turned into a charset first; when the same set is used
+*       repeatedly, construct a charset once and use findfirstof(T *, const charset<U> &, size_t) instead.
 */
 template <typename T>
 inline const T * findfirstof(const T *str, const T *charSet, size_t strLength = -1, size_t setLength = -1)
 {
-    const T *temp = str;
+    assert(str != NULL);
+    assert(charSet != NULL);
 
-    uchar32_t ch;
-    while (strLength > 0 && (ch = nextchar(temp)) != '\0')
-    {
-        // Now we need to search through the character set and check if the character
-        // is equal to any of those.
-        const T *temp_set = charSet;
+    const T *set_end = charSet + ((setLength == (size_t)-1) ? length(charSet) : length(charSet, setLength));
 
-        // Stores the start of the next character.
-        const T *start_of_ch2 = temp_set;
+    T units[4][4];
+    size_t counts[4];
+    size_t set_count = 0;
 
-        size_t temp_length = setLength;
-        uchar32_t ch2;
-        while (temp_length > 0 && (ch2 = nextchar(temp_set)) != '\0')
+    const T *temp_set = charSet;
+    while (temp_set < set_end)
+    {
+        uchar32_t ch = nextchar(temp_set, set_end);
+        if (ch == '\0' || set_count == 4 || (counts[set_count] = _findfirst_encode(ch, units[set_count])) == 0)
         {
-            if (ch2 == ch)
-            {
-                return str;
-            }
-
-            temp_length -= temp - str;
-            start_of_ch2 = temp_set;
+            return charset<T>(charSet, set_end - charSet).find(str, strLength);
         }
 
-        strLength -= temp - str;
-        str = temp;
+        ++set_count;
+    }
+
+    // Every character starts where another one ends, so a match that starts before the best
+    // one so far also ends before it. That means the best match is where the next search stops.
+    const T *best = str + ((strLength == (size_t)-1) ? length(str) : length(str, strLength));
+    const T *found = NULL;
+    for (size_t i = 0; i < set_count; ++i)
+    {
+        const T *temp = _findfirst_units(str, best, units[i], counts[i]);
+        if (temp != NULL)
+        {
+            best  = temp;
+            found = temp;
+        }
     }
 
-    return NULL;
+    return found;
+}
+
+/**
+*   \brief                 Retrieves the first occurance in a string of any character in a prepared set.
+*   \param  str       [in] The string to search.
+*   \param  charSet   [in] The set of characters to look for in \c str.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*   \return                A pointer in \c str to the first occurance of any character in \c charSet; or NULL if no characters are found.
+*
+*   \remarks
+*       The search stops at the first null character in \c str.
+*/
+template <typename T, typename U>
+inline T * findfirstof(T *str, const charset<U> &charSet, size_t strLength = -1)
+{
+    return (T *)charSet.find((const U *)str, strLength);
+}
+
+/**
+*   \brief                 Retrieves the first occurance in a reference string of any character in a prepared set.
+*   \param  str       [in] The string to search.
+*   \param  charSet   [in] The set of characters to look for in \c str.
+*   \return                A pointer in \c str to the first occurance of any character in \c charSet; or NULL if no characters are found.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read.
+*/
+template <typename T, typename U>
+inline T * findfirstof(const reference_string<T> &str, const charset<U> &charSet)
+{
+    return (T *)charSet.find((const U *)str.start, (const U *)str.end);
 }
 
 // Optimized cases.
@@ -0,0 +1,179 @@
+/**
+*   \file   findlast.h
+*   \author Dave Reid
+*   \brief  Header file for findlast() implementations.
+*/
+#ifndef __EASL_FINDLAST_H_
+#define __EASL_FINDLAST_H_
+
+#include "findfirst.h"
+#include "prevchar.h"
+#include "searcher.h"
+#include "length.h"
+#include "reference_string.h"
+
+namespace easl
+{
+
+/**
+*   \brief                 Finds the last occurance of a character between two pointers.
+*   \param  str       [in] Pointer to the start of the string.
+*   \param  strEnd    [in] Pointer to the end of the string.
+*   \param  character [in] The character to look for.
+*   \return                A pointer to the character if it is found; NULL otherwise.
+*
+*   \remarks
+*       The character is encoded and its code units are searched for from the end of the string, so
+*       the string is never decoded. Characters that can't be encoded fall back to decoding the string
+*       backwards with prevchar(), skipping invalid sequences one T at a time.
+*/
+template <typename T>
+inline const T * _findlast_span(const T *str, const T *strEnd, uchar32_t character)
+{
+    T units[4];
+    size_t count = _findfirst_encode(character, units);
+    if (count != 0)
+    {
+        return _findlast_units(str, strEnd, units, count);
+    }
+
+    while (strEnd > str)
+    {
+        const T *prev = strEnd;
+        uchar32_t ch = prevchar(prev, str);
+
+        if (prev == strEnd)
+        {
+            --strEnd;
+            continue;
+        }
+
+        if (ch == character)
+        {
+            return prev;
+        }
+
+        strEnd = prev;
+    }
+
+    return NULL;
+}
+
+/**
+*   \brief                 Finds the last occurance of a character inside a string.
+*   \param  str       [in] The string to look for the character in.
+*   \param  character [in] The character to look for.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*   \return                If the character is found, returns a pointer to that character. Otherwise, a NULL pointer is returned.
+*
+*   \remarks
+*       The string ends at the first null character, even when the length is given. The end of a null
+*       terminated string still has to be found first, but from there on the string is searched
+*       backwards, so nothing after the last occurance is looked at twice.
+*/
+template <typename T>
+inline T * findlast(T *str, uchar32_t character, size_t strLength = -1)
+{
+    assert(str != NULL);
+
+    const T *str_end = str + ((strLength == (size_t)-1) ? length(str) : length(str, strLength));
+
+    return (T *)_findlast_span((const T *)str, str_end, character);
+}
+
+/**
+*   \brief                 Finds the last occurance of a character inside a reference string.
+*   \param  str       [in] The string to look for the character in.
+*   \param  character [in] The character to look for.
+*   \return                If the character is found, returns a pointer to that character. Otherwise, a NULL pointer is returned.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read, and the search starts at the end.
+*/
+template <typename T>
+inline T * findlast(const reference_string<T> &str, uchar32_t character)
+{
+    return (T *)_findlast_span((const T *)str.start, (const T *)str.end, character);
+}
+
+
+/**
+*   \brief                  Finds the last occurance of a string from within another string.
+*   \param  str1       [in] The string to be scanned.
+*   \param  str2       [in] The string to look for inside \c str1.
+*   \param  str1Length [in] The length in T's of the first string, not including the null terminator.
+*   \param  str2Length [in] The length in T's of the second string, not including the null terminator.
+*   \return                 A pointer to the last occurance of \c str2; or NULL if the string is not found.
+*
+*   \remarks
+*       \c str1 ends at its first null character. An empty \c str2 is found at the end of \c str1. This
+*       builds a searcher for \c str2 every time it's called; when the same string is searched for
+*       repeatedly, construct a searcher once and use findlast(T *, const searcher<U> &, size_t) instead.
+*/
+template <typename T>
+inline const T * findlast(const T *str1, const T *str2, size_t str1Length = -1, size_t str2Length = -1)
+{
+    assert(str1 != NULL);
+    assert(str2 != NULL);
+
+    return searcher<T>(str2, str2Length).find_last(str1, str1Length);
+}
+
+template <typename T>
+inline T * findlast(T *str1, const T *str2, size_t str1Length = -1, size_t str2Length = -1)
+{
+    return (T *)findlast((const T *)str1, str2, str1Length, str2Length);
+}
+
+/**
+*   \brief                 Finds the last occurance of a prepared pattern inside a string.
+*   \param  str       [in] The string to be scanned.
+*   \param  pattern   [in] The pattern to look for.
+*   \param  strLength [in] The length in T's of the string to be scanned, not including the null terminator.
+*   \return                A pointer to the last occurance of the pattern; or NULL if it is not found.
+*
+*   \remarks
+*       The string ends at its first null character.
+*/
+template <typename T, typename U>
+inline T * findlast(T *str, const searcher<U> &pattern, size_t strLength = -1)
+{
+    return (T *)pattern.find_last((const U *)str, strLength);
+}
+
+/**
+*   \brief                 Finds the last occurance of a prepared pattern inside a reference string.
+*   \param  str       [in] The string to be scanned.
+*   \param  pattern   [in] The pattern to look for.
+*   \return                A pointer to the last occurance of the pattern; or NULL if it is not found.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read.
+*/
+template <typename T, typename U>
+inline T * findlast(const reference_string<T> &str, const searcher<U> &pattern)
+{
+    return (T *)pattern.find_last((const U *)str.start, (const U *)str.end);
+}
+
+/**
+*   \brief                   Finds the last occurance of a reference string from within another reference string.
+*   \param  str1       [in]  The string to be scanned.
+*   \param  str2       [in]  The string to look for inside \c str1.
+*   \return                  A pointer to the last occurance of \c str2; or NULL if the string is not found.
+*
+*   \remarks
+*       Neither string needs to be null terminated. Nothing at or past the end of either string is read.
+*/
+template <typename T>
+inline T * findlast(const reference_string<T> &str1, const reference_string<T> &str2)
+{
+    return (T *)searcher<T>(str2.start, str2.end - str2.start).find_last(str1.start, str1.end);
+}
+
+
+}
+
+#endif // __EASL_FINDLAST_H_
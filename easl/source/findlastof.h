@@ -0,0 +1,161 @@
+/**
+*   \file   findlastof.h
+*   \author Dave Reid
+*   \brief  Header file for findlastof() implementations.
+*/
+#ifndef __EASL_FINDLASTOF_H_
+#define __EASL_FINDLASTOF_H_
+
+#include "findlast.h"
+#include "charset.h"
+
+namespace easl
+{
+
+/**
+*   \brief                 Retrieves the last occurance of the specified character in a string.
+*   \param  str       [in] The string to search.
+*   \param  character [in] The character to look for.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*   \return                A pointer in \c str to the last occurance of the character.
+*
+*   \remarks
+*       This function is functionally equivalent to findlast(T *, uchar32_t, size_t).
+*/
+template <typename T>
+inline T * findlastof(T *str, uchar32_t character, size_t strLength = -1)
+{
+    return easl::findlast(str, character, strLength);
+}
+
+
+/**
+*   \brief                 Retrieves the last occurance of any of a set of characters between two pointers.
+*   \param  str       [in] Pointer to the start of the string to search.
+*   \param  strEnd    [in] Pointer to the end of the string to search.
+*   \param  charSet   [in] Pointer to the start of the set of characters to look for.
+*   \param  setEnd    [in] Pointer to the end of the set of characters to look for.
+*   \return                A pointer to the last occurance of any character in the set; or NULL if no characters are found.
+*
+*   \remarks
+*       When the set has no more than four characters, each one is encoded and searched for from the
+*       end of the string in turn, with every search stopping where the best match so far ends. Larger
+*       sets are turned into a charset first.
+*/
+template <typename T>
+inline const T * _findlastof_span(const T *str, const T *strEnd, const T *charSet, const T *setEnd)
+{
+    T units[4][4];
+    size_t counts[4];
+    size_t set_count = 0;
+
+    const T *temp_set = charSet;
+    while (temp_set < setEnd)
+    {
+        uchar32_t ch = nextchar(temp_set, setEnd);
+        if (ch == '\0' || set_count == 4 || (counts[set_count] = _findfirst_encode(ch, units[set_count])) == 0)
+        {
+            return charset<T>(charSet, setEnd - charSet).find_last(str, strEnd);
+        }
+
+        ++set_count;
+    }
+
+    // A match that ends after the best one so far also starts after it, so the next search
+    // can start where the best match ends.
+    const T *found = NULL;
+    for (size_t i = 0; i < set_count; ++i)
+    {
+        const T *temp = _findlast_units(str, strEnd, units[i], counts[i]);
+        if (temp != NULL)
+        {
+            str   = temp + counts[i];
+            found = temp;
+        }
+    }
+
+    return found;
+}
+
+/**
+*   \brief                 Retrieves the last occurance in a string of any character contained in another string.
+*   \param  str       [in] The string to search.
+*   \param  charSet   [in] The set of characters to look for in \c str.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*   \param  setLength [in] The length in T's of the character set string, not including the null terminator.
+*   \return                A pointer in \c str to the last occurance of any character in \c charSet; or NULL if no characters are found.
+*
+*   \remarks
+*       The string ends at its first null character. See _findlastof_span() for how the search is done.
+*/
+template <typename T>
+inline const T * findlastof(const T *str, const T *charSet, size_t strLength = -1, size_t setLength = -1)
+{
+    assert(str != NULL);
+    assert(charSet != NULL);
+
+    const T *str_end = str + ((strLength == (size_t)-1) ? length(str) : length(str, strLength));
+    const T *set_end = charSet + ((setLength == (size_t)-1) ? length(charSet) : length(charSet, setLength));
+
+    return _findlastof_span(str, str_end, charSet, set_end);
+}
+
+template <typename T>
+inline T * findlastof(T *str, const T *charSet, size_t strLength = -1, size_t setLength = -1)
+{
+    return (T *)findlastof((const T *)str, charSet, strLength, setLength);
+}
+
+/**
+*   \brief                 Retrieves the last occurance in a string of any character in a prepared set.
+*   \param  str       [in] The string to search.
+*   \param  charSet   [in] The set of characters to look for in \c str.
+*   \param  strLength [in] The length in T's of the string, not including the null terminator.
+*   \return                A pointer in \c str to the last occurance of any character in \c charSet; or NULL if no characters are found.
+*
+*   \remarks
+*       The string ends at the first null character in \c str.
+*/
+template <typename T, typename U>
+inline T * findlastof(T *str, const charset<U> &charSet, size_t strLength = -1)
+{
+    return (T *)charSet.find_last((const U *)str, strLength);
+}
+
+/**
+*   \brief                 Retrieves the last occurance in a reference string of any character in a prepared set.
+*   \param  str       [in] The string to search.
+*   \param  charSet   [in] The set of characters to look for in \c str.
+*   \return                A pointer in \c str to the last occurance of any character in \c charSet; or NULL if no characters are found.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read.
+*/
+template <typename T, typename U>
+inline T * findlastof(const reference_string<T> &str, const charset<U> &charSet)
+{
+    return (T *)charSet.find_last((const U *)str.start, (const U *)str.end);
+}
+
+/**
+*   \brief                 Retrieves the last occurance in a reference string of any character contained in another string.
+*   \param  str       [in] The string to search.
+*   \param  charSet   [in] The null terminated set of characters to look for in \c str.
+*   \return                A pointer in \c str to the last occurance of any character in \c charSet; or NULL if no characters are found.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read.
+*/
+template <typename T, typename U>
+inline T * findlastof(const reference_string<T> &str, const U *charSet)
+{
+    assert(charSet != NULL);
+
+    return (T *)_findlastof_span((const U *)str.start, (const U *)str.end, charSet, charSet + length(charSet));
+}
+
+}
+
+#endif // __EASL_FINDLASTOF_H_
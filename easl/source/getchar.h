@@ -7,7 +7,9 @@
 #define __EASL_GETCHAR_H_
 
 #include "nextchar.h"
+#include "length.h"
 #include "reference_string.h"
+#include "charindex.h"
 
 namespace easl
 {
@@ -66,25 +68,15 @@ inline uchar32_t getchar(const T *str, size_t index, size_t strLength = -1)
 {
     const T *temp = str;
 
-    // Stores the start of the next character.
-    const T *start_of_ch = str;
-
     uchar32_t ch;
-    while (strLength > 0 && (ch = easl::nextchar(temp)) != '\0')
+    while (static_cast<size_t>(temp - str) < strLength && (ch = easl::nextchar(temp)) != '\0')
     {
-        size_t cur_pos = temp - str;
-
-        strLength -= temp - start_of_ch;
-        start_of_ch = temp;
-
-        if (cur_pos == index + 1)
-        {
-            return ch;
-        }
-        else if (cur_pos > index + 1)
+        if (index == 0)
         {
-            return 0;
+            return static_cast<size_t>(temp - str) <= strLength ? ch : 0;
         }
+
+        --index;
     }
 
     return 0;
@@ -110,7 +102,17 @@ inline uchar32_t getchar(const wchar_t *str, size_t index, size_t strLength = -1
     switch (sizeof(wchar_t))
     {
     case 2: return getchar((const char16_t *)str, index, strLength);
-    case 4: return getchar((const char32_t *)str, index, strLength);
+    case 4:
+        {
+            // char32_t is not necessarily 32 bits, so we can't treat the string as a char32_t string. Without
+            // a length, the string can end before index, so we look for the null terminator first.
+            if (strLength != (size_t)-1 ? index >= strLength : length(str, index + 1) <= index)
+            {
+                return '\0';
+            }
+
+            return static_cast<uchar32_t>(static_cast<unsigned int>(str[index]));
+        }
     }
 
     return getchar((const char *)str, index, strLength);
@@ -123,6 +125,22 @@ inline uchar32_t getchar(const reference_string<T> &str, size_t index)
     return getchar(str.start, index, str.end - str.start);
 }
 
+/**
+*   \brief             Retrieves a character from an indexed string.
+*   \param  str   [in] The index of the string to retrieve the character from.
+*   \param  index [in] The zero based index of the character to retrieve.
+*   \return            The character at the location specified by the index, or 0 if the index is not valid.
+*
+*   \remarks
+*       This decodes at most the number of characters between each recorded offset in the index,
+*       rather than every character before \c index.
+*/
+template <typename T>
+inline uchar32_t getchar(const charindex<T> &str, size_t index)
+{
+    return str.getchar(index);
+}
+
 
 }
 
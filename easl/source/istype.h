@@ -130,7 +130,7 @@ struct _istype
 };
 
 template <typename T>
-struct _istype<__int64, T>
+struct _istype<int64, T>
 {
     static bool call(const T *str, size_t strLength)
     {
@@ -168,7 +168,7 @@ struct _istype<__int64, T>
     }
 };
 template <typename T>
-struct _istype<unsigned __int64, T>
+struct _istype<uint64, T>
 {
     static inline bool call(const T *str, size_t strLength)
     {
@@ -204,7 +204,7 @@ struct _istype<int, T>
 {
     static inline bool call(const T *str, size_t strLength)
     {
-        return _istype<__int64, T>::call(str, strLength);
+        return _istype<int64, T>::call(str, strLength);
     }
 };
 template <typename T>
@@ -212,7 +212,7 @@ struct _istype<unsigned int, T>
 {
     static inline bool call(const T *str, size_t strLength)
     {
-        return _istype<unsigned __int64, T>::call(str, strLength);
+        return _istype<uint64, T>::call(str, strLength);
     }
 };
 
@@ -221,7 +221,7 @@ struct _istype<long, T>
 {
     static inline bool call(const T *str, size_t strLength)
     {
-        return _istype<__int64, T>::call(str, strLength);
+        return _istype<int64, T>::call(str, strLength);
     }
 };
 template <typename T>
@@ -229,7 +229,7 @@ struct _istype<unsigned long, T>
 {
     static inline bool call(const T *str, size_t strLength)
     {
-        return _istype<unsigned __int64, T>::call(str, strLength);
+        return _istype<uint64, T>::call(str, strLength);
     }
 };
 
@@ -238,7 +238,7 @@ struct _istype<short, T>
 {
     static inline bool call(const T *str, size_t strLength)
     {
-        return _istype<__int64, T>::call(str, strLength);
+        return _istype<int64, T>::call(str, strLength);
     }
 };
 template <typename T>
@@ -246,7 +246,7 @@ struct _istype<unsigned short, T>
 {
     static inline bool call(const T *str, size_t strLength)
     {
-        return _istype<unsigned __int64, T>::call(str, strLength);
+        return _istype<uint64, T>::call(str, strLength);
     }
 };
 
@@ -255,7 +255,7 @@ struct _istype<char, T>
 {
     static inline bool call(const T *str, size_t strLength)
     {
-        return _istype<__int64, T>::call(str, strLength);
+        return _istype<int64, T>::call(str, strLength);
     }
 };
 template <typename T>
@@ -263,7 +263,7 @@ struct _istype<unsigned char, T>
 {
     static inline bool call(const T *str, size_t strLength)
     {
-        return _istype<unsigned __int64, T>::call(str, strLength);
+        return _istype<uint64, T>::call(str, strLength);
     }
 };
 
@@ -7,6 +7,7 @@
 #define __EASL_LENGTH_H_
 
 #include <string.h>
+#include <wchar.h>
 #include <assert.h>
 #include "reference_string.h"
 
@@ -55,6 +56,46 @@ inline size_t length(const wchar_t *str)
     return ::wcslen(str);
 }
 
+/**
+*   \brief                 Retrieves the length of a C style string without looking past a maximum length.
+*   \param  str       [in] The string to retrieve the length of.
+*   \param  maxLength [in] The maximum number of T's to look at.
+*   \return                The length of the string, or \c maxLength if a null terminator is not found before then.
+*
+*   \remarks
+*       No T's past the null terminator or past \c maxLength are read, so this function can be used
+*       on buffers that are not null terminated.
+*/
+template <typename T>
+inline size_t length(const T *str, size_t maxLength)
+{
+    assert(str != NULL);
+
+    const T *temp = str;
+
+    while (maxLength > 0 && *temp != '\0')
+    {
+        ++temp;
+        --maxLength;
+    }
+
+    return temp - str;
+}
+
+// Optimized case.
+inline size_t length(const char *str, size_t maxLength)
+{
+    assert(str != NULL);
+
+    const void *end = ::memchr(str, '\0', maxLength);
+    if (end != NULL)
+    {
+        return static_cast<const char *>(end) - str;
+    }
+
+    return maxLength;
+}
+
 template <typename T>
 inline size_t length(const reference_string<T> &str)
 {
@@ -0,0 +1,334 @@
+/**
+*   \file   literal.h
+*   \author Dave Reid
+*   \brief  Header file for the literal class.
+*/
+#ifndef __EASL_LITERAL_H_
+#define __EASL_LITERAL_H_
+
+#include "types.h"
+#include "_private.h"
+#include "reference_string.h"
+
+namespace easl
+{
+
+/**
+*   \brief                  Decodes the character at the given index of a string literal.
+*   \param  str       [in]  The string literal. Its encoding is chosen by the size of T.
+*   \param  strLength [in]  The length in T's of the string literal, not including the null terminator.
+*   \param  index     [in]  The index of the character to decode. On return, the index of the next character.
+*   \return                 The decoded character.
+*
+*   \remarks
+*       Malformed sequences decode to UNI_REPLACEMENT_CHAR.
+*/
+template <typename T>
+EASL_CONSTEXPR uchar32_t _literal_nextchar(const T *str, size_t strLength, size_t &index)
+{
+    if (sizeof(T) == 1)
+    {
+        uchar32_t ch = static_cast<unsigned char>(str[index++]);
+        if (ch < 0x80)
+        {
+            return ch;
+        }
+
+        size_t trailing = 0;
+        if (ch >= 0xC2 && ch <= 0xDF)
+        {
+            trailing = 1;
+            ch &= 0x1F;
+        }
+        else if (ch >= 0xE0 && ch <= 0xEF)
+        {
+            trailing = 2;
+            ch &= 0x0F;
+        }
+        else if (ch >= 0xF0 && ch <= 0xF4)
+        {
+            trailing = 3;
+            ch &= 0x07;
+        }
+        else
+        {
+            return UNI_REPLACEMENT_CHAR;
+        }
+
+        for (size_t i = 0; i < trailing; ++i)
+        {
+            if (index >= strLength || (static_cast<unsigned char>(str[index]) & 0xC0) != 0x80)
+            {
+                return UNI_REPLACEMENT_CHAR;
+            }
+
+            ch = (ch << 6) | (static_cast<unsigned char>(str[index++]) & 0x3F);
+        }
+
+        // Overlong forms, surrogates and characters past the end of Unicode.
+        if ((trailing == 2 && ch < 0x800) || (trailing == 3 && (ch < 0x10000 || ch > UNI_MAX_LEGAL_UTF32)) || (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_LOW_END))
+        {
+            return UNI_REPLACEMENT_CHAR;
+        }
+
+        return ch;
+    }
+    else if (sizeof(T) == 2)
+    {
+        uchar32_t ch = static_cast<uchar16_t>(str[index++]);
+        if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_HIGH_END && index < strLength)
+        {
+            uchar32_t ch2 = static_cast<uchar16_t>(str[index]);
+            if (ch2 >= UNI_SUR_LOW_START && ch2 <= UNI_SUR_LOW_END)
+            {
+                ++index;
+                return ((ch - UNI_SUR_HIGH_START) << UNI_HALF_SHIFT) + (ch2 - UNI_SUR_LOW_START) + UNI_HALF_BASE;
+            }
+        }
+
+        if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_LOW_END)
+        {
+            return UNI_REPLACEMENT_CHAR;
+        }
+
+        return ch;
+    }
+    else
+    {
+        uchar32_t ch = static_cast<uchar32_t>(str[index++]);
+        if (ch > UNI_MAX_LEGAL_UTF32 || (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_LOW_END))
+        {
+            return UNI_REPLACEMENT_CHAR;
+        }
+
+        return ch;
+    }
+}
+
+
+/**
+*   \brief  A string literal in UTF-8, UTF-16, UTF-32 and wchar_t.
+*
+*   The literal is transcoded once when it is constructed. When the compiler supports C++14
+*   constexpr (EASL_HAS_RELAXED_CONSTEXPR), this happens at compile time:
+*
+*   \code
+*   static constexpr easl::literal<char, 6> hello("Hello");
+*   \endcode
+*
+*   Comparing a string against a literal uses the copy that has the same encoding as the
+*   string, so equal(), compare() and findfirst() can work on code units without decoding
+*   either side.
+*
+*   A char literal is read as UTF-8. Non-ASCII text in a narrow literal should use escapes or a
+*   u8 prefix, because compilers don't otherwise agree on the encoding of narrow literals.
+*/
+template <typename T, size_t N>
+class literal
+{
+public:
+
+    /// The size of each buffer, including the null terminator. These are the worst case for the source encoding.
+    /// A malformed code unit becomes UNI_REPLACEMENT_CHAR, which takes three bytes in UTF-8, so even a UTF-8
+    /// literal can need three times as many bytes.
+    static const size_t capacity8  = (sizeof(T) <= 2) ? (N - 1) * 3 + 1 : (N - 1) * 4 + 1;
+    static const size_t capacity16 = (sizeof(T) <= 2) ? N : (N - 1) * 2 + 1;
+    static const size_t capacity32 = N;
+    static const size_t capacityw  = (sizeof(wchar_t) == 2) ? capacity16 : capacity32;
+
+
+    /**
+    *   \brief           Constructor.
+    *   \param  str [in] The string literal. It must be null terminated.
+    */
+    EASL_CONSTEXPR literal(const T (&str)[N])
+        : m_utf8(), m_utf16(), m_utf32(), m_wide(), m_length8(0), m_length16(0), m_length32(0), m_lengthw(0)
+    {
+        size_t index = 0;
+        while (index < N - 1)
+        {
+            uchar32_t ch = _literal_nextchar(str, N - 1, index);
+
+            // UTF-8.
+            if (ch < 0x80)
+            {
+                m_utf8[m_length8++] = static_cast<char>(ch);
+            }
+            else if (ch < 0x800)
+            {
+                m_utf8[m_length8++] = static_cast<char>(0xC0 | (ch >> 6));
+                m_utf8[m_length8++] = static_cast<char>(0x80 | (ch & 0x3F));
+            }
+            else if (ch < 0x10000)
+            {
+                m_utf8[m_length8++] = static_cast<char>(0xE0 | (ch >> 12));
+                m_utf8[m_length8++] = static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                m_utf8[m_length8++] = static_cast<char>(0x80 | (ch & 0x3F));
+            }
+            else
+            {
+                m_utf8[m_length8++] = static_cast<char>(0xF0 | (ch >> 18));
+                m_utf8[m_length8++] = static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+                m_utf8[m_length8++] = static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+                m_utf8[m_length8++] = static_cast<char>(0x80 | (ch & 0x3F));
+            }
+
+            // UTF-16.
+            if (ch <= UNI_MAX_BMP)
+            {
+                m_utf16[m_length16++] = static_cast<char16_t>(ch);
+            }
+            else
+            {
+                m_utf16[m_length16++] = static_cast<char16_t>(((ch - UNI_HALF_BASE) >> UNI_HALF_SHIFT) + UNI_SUR_HIGH_START);
+                m_utf16[m_length16++] = static_cast<char16_t>(((ch - UNI_HALF_BASE) & UNI_HALF_MASK) + UNI_SUR_LOW_START);
+            }
+
+            // UTF-32.
+            m_utf32[m_length32++] = static_cast<char32_t>(ch);
+
+            // wchar_t. This has it's own copy because char16_t and char32_t are not always the
+            // same size as wchar_t when they're typedefs.
+            if (sizeof(wchar_t) == 2 && ch > UNI_MAX_BMP)
+            {
+                m_wide[m_lengthw++] = static_cast<wchar_t>(((ch - UNI_HALF_BASE) >> UNI_HALF_SHIFT) + UNI_SUR_HIGH_START);
+                m_wide[m_lengthw++] = static_cast<wchar_t>(((ch - UNI_HALF_BASE) & UNI_HALF_MASK) + UNI_SUR_LOW_START);
+            }
+            else
+            {
+                m_wide[m_lengthw++] = static_cast<wchar_t>(ch);
+            }
+        }
+
+        // The buffers are zero initialised, so they're already null terminated.
+    }
+
+
+    /// Retrieves the UTF-8 version of the literal.
+    EASL_CONSTEXPR const char * utf8() const { return m_utf8; }
+
+    /// Retrieves the UTF-16 version of the literal.
+    EASL_CONSTEXPR const char16_t * utf16() const { return m_utf16; }
+
+    /// Retrieves the UTF-32 version of the literal.
+    EASL_CONSTEXPR const char32_t * utf32() const { return m_utf32; }
+
+    /// Retrieves the wchar_t version of the literal. This is UTF-16 on Windows and UTF-32 everywhere else.
+    EASL_CONSTEXPR const wchar_t * wide() const { return m_wide; }
+
+    /// Retrieves the length in chars of the UTF-8 version of the literal, not including the null terminator.
+    EASL_CONSTEXPR size_t length8() const { return m_length8; }
+
+    /// Retrieves the length in char16_t's of the UTF-16 version of the literal, not including the null terminator.
+    EASL_CONSTEXPR size_t length16() const { return m_length16; }
+
+    /// Retrieves the length in char32_t's of the UTF-32 version of the literal, not including the null terminator.
+    EASL_CONSTEXPR size_t length32() const { return m_length32; }
+
+    /// Retrieves the length in wchar_t's of the wchar_t version of the literal, not including the null terminator.
+    EASL_CONSTEXPR size_t lengthw() const { return m_lengthw; }
+
+    /// Retrieves the number of characters in the literal.
+    EASL_CONSTEXPR size_t charcount() const { return m_length32; }
+
+
+private:
+
+    /// The UTF-8 version of the literal.
+    char m_utf8[capacity8];
+
+    /// The UTF-16 version of the literal.
+    char16_t m_utf16[capacity16];
+
+    /// The UTF-32 version of the literal.
+    char32_t m_utf32[capacity32];
+
+    /// The wchar_t version of the literal.
+    wchar_t m_wide[capacityw];
+
+    /// The length of each version of the literal, not including the null terminator.
+    size_t m_length8;
+    size_t m_length16;
+    size_t m_length32;
+    size_t m_lengthw;
+};
+
+
+/**
+*   \brief           Creates a literal without needing to spell out its type.
+*   \param  str [in] The string literal.
+*
+*   \remarks
+*       This is mostly useful with auto: <tt>static constexpr auto hello = easl::make_literal("Hello");</tt>
+*/
+template <typename T, size_t N>
+EASL_CONSTEXPR literal<T, N> make_literal(const T (&str)[N])
+{
+    return literal<T, N>(str);
+}
+
+
+// These retrieve the version of a literal with the same encoding as a string. The second
+// parameter is only used to pick the encoding, so it's always NULL.
+template <typename T, size_t N>
+inline reference_string<const char> _literal_string(const literal<T, N> &lit, const char *)
+{
+    reference_string<const char> str = {lit.utf8(), lit.utf8() + lit.length8()};
+    return str;
+}
+
+template <typename T, size_t N>
+inline reference_string<const char16_t> _literal_string(const literal<T, N> &lit, const char16_t *)
+{
+    reference_string<const char16_t> str = {lit.utf16(), lit.utf16() + lit.length16()};
+    return str;
+}
+
+template <typename T, size_t N>
+inline reference_string<const char32_t> _literal_string(const literal<T, N> &lit, const char32_t *)
+{
+    reference_string<const char32_t> str = {lit.utf32(), lit.utf32() + lit.length32()};
+    return str;
+}
+
+template <typename T, size_t N>
+inline reference_string<const wchar_t> _literal_string(const literal<T, N> &lit, const wchar_t *)
+{
+    reference_string<const wchar_t> str = {lit.wide(), lit.wide() + lit.lengthw()};
+    return str;
+}
+
+/**
+*   \brief  Retrieves a code unit as an unsigned value so that code units can be compared in code point order.
+*
+*   \remarks
+*       UTF-8 and UTF-32 code units are already in code point order. For UTF-16, the surrogates are
+*       moved above the rest of the BMP so that supplementary characters sort after U+E000-U+FFFF.
+*/
+template <typename T>
+inline uchar32_t _literal_unit(T ch)
+{
+    if (sizeof(T) == 1)
+    {
+        return static_cast<unsigned char>(ch);
+    }
+    else if (sizeof(T) == 2)
+    {
+        uchar32_t unit = static_cast<uchar16_t>(ch);
+        if (unit >= UNI_SUR_HIGH_START)
+        {
+            unit += (unit <= UNI_SUR_LOW_END) ? 0x2000 : -0x800;
+        }
+
+        return unit;
+    }
+    else
+    {
+        return static_cast<uchar32_t>(ch);
+    }
+}
+
+
+}
+
+#endif // __EASL_LITERAL_H_
@@ -18,79 +18,150 @@ namespace easl
 {
 
 /**
-*   \brief                Retrieves the next character in a UTF-8 string.
+*   \brief                  Feeds a single byte of UTF-8 through the decoding automaton.
+*   \param  state [in, out] The state of the decoder. This should be set to UNI_UTF8_ACCEPT before the first byte.
+*   \param  ch    [in, out] Receives the decoded character. This is only complete when UNI_UTF8_ACCEPT is returned.
+*   \param  byte  [in]      The next byte of input.
+*   \return                 The new state of the decoder.
+*
+*   \remarks
+*       This is the scalar engine behind nextchar_utf8(). Since the whole state is kept in \c state
+*       and \c ch, input can be fed in one byte at a time, with a sequence split across several
+*       buffers (reads from a socket, for example).
+*       \par
+*       The function returns UNI_UTF8_ACCEPT when a character has been decoded and UNI_UTF8_REJECT
+*       when the input is not valid UTF-8. Any other value means more bytes are needed. Once the
+*       decoder has rejected the input, the state needs to be reset to UNI_UTF8_ACCEPT before it
+*       can be used again.
+*/
+inline unsigned int decode_utf8(unsigned int &state, uchar32_t &ch, unsigned char byte)
+{
+    unsigned int type = g_utf8DFA[byte];
+
+    ch = (state != UNI_UTF8_ACCEPT) ? (byte & 0x3FU) | (ch << 6) : (0xFFU >> type) & byte;
+
+    state = g_utf8DFA[256 + state + type];
+    return state;
+}
+
+/**
+*   \brief                Retrieves the next character in a UTF-8 string that is known to be well formed.
 *   \param  str [in, out] The string whose next character should be retrieved.
 *   \return               The character that was being pointed to by \c str.
 *
 *   \remarks
-*       If this function returns NULL, the null terminator was retrieved. When this occurs, the string
-*       is _not_ moved forward to the next character (there is no characters after the null terminator).
+*       This function does not check the character for errors and does not look for a null terminator
+*       in the middle of a multi-byte sequence. It should only be used on strings that have already been
+*       checked with validate_utf8(). Results are undefined if the string is not valid UTF-8.
+*       \par
+*       If EASL_OPTION_TRUSTED_UTF8 is defined, nextchar_utf8() will use this function for every string.
 */
-inline uchar32_t nextchar_utf8(const char *&str)
+inline uchar32_t nextchar_utf8_trusted(const char *&str)
 {
     assert(str != NULL);
 
-#ifdef EASL_ONLY_ASCII
-    char32_t ch = *str;
+    const unsigned char *source = reinterpret_cast<const unsigned char *>(str);
 
-    if (ch != '\0')
+    // ASCII is by far the most common case, so we get it out of the way first.
+    if (*source < 0x80)
     {
-        ++str;
+        if (*source != '\0')
+        {
+            ++str;
+        }
+
+        return *source;
     }
 
+    uchar32_t ch = 0;
+    unsigned short extra_bytes = g_trailingBytesForUTF8[*source];
+
+    switch (extra_bytes)
+    {
+    case 3: ch += *source++; ch <<= 6;
+    case 2: ch += *source++; ch <<= 6;
+    case 1: ch += *source++; ch <<= 6;
+    case 0: ch += *source++;
+    }
+
+    ch -= g_offsetsFromUTF8[extra_bytes];
+    str = reinterpret_cast<const char *>(source);
+
     return ch;
-#else
-    const char *source = str;
+}
 
-    // The character we will eventually be returning.
-    uchar32_t ch = 0;
+/**
+*   \brief                Retrieves the next character in a UTF-8 string, checking it for errors.
+*   \param  str [in, out] The string whose next character should be retrieved.
+*   \return               The character that was being pointed to by \c str.
+*
+*   \remarks
+*       Overlong sequences, surrogates and characters above U+10FFFF are all errors. On an error, 0 is
+*       returned and \c str is not moved.
+*       \par
+*       This is what nextchar_utf8() uses by default. Unlike nextchar_utf8(), it is not affected by
+*       EASL_ONLY_ASCII or EASL_OPTION_TRUSTED_UTF8.
+*/
+inline uchar32_t nextchar_utf8_strict(const char *&str)
+{
+    assert(str != NULL);
 
-    // We need to determine the additional bytes that we need to read in order
-    // to reconstruct the final character. We can calculate the total number of
-    // bytes used for the character by adding 1 to the returned value.
-    unsigned short extra_bytes = g_trailingBytesForUTF8[(unsigned char)*source];
+    const unsigned char *source = reinterpret_cast<const unsigned char *>(str);
 
-    // We need to make sure that the null terminator is not encounted one once
-    // of these bytes. If it is, we need to return 0.
-    for (unsigned short i = 1; i <= extra_bytes; ++i)
+    // ASCII is by far the most common case, so we get it out of the way first.
+    if (*source < 0x80)
     {
-        if (*(source + i) == '\0')
+        if (*source != '\0')
         {
-            return 0;
+            ++str;
         }
-    }
 
-    // We need to make sure we have a valid UTF-8 character. If it isn't, we will
-    // return NULL.
-    if (!is_legal_utf8(source, extra_bytes + 1))
-    {
-        return 0;
+        return *source;
     }
 
-    // It is possible that the additional bytes are values of 5 and 4. This used
-    // to be valid, but is not anymore. We will use the swith fall-through method
-    // used in the sample code by Unicode, Inc.
-    switch (extra_bytes)
+    // The automaton rejects a null byte in the middle of a sequence, so we never read past
+    // the null terminator.
+    unsigned int state = UNI_UTF8_ACCEPT;
+    uchar32_t    ch    = 0;
+    do
     {
-    case 5: ch += (unsigned char)*source++; ch <<= 6;
-    case 4: ch += (unsigned char)*source++; ch <<= 6;
-    case 3: ch += (unsigned char)*source++; ch <<= 6;
-    case 2: ch += (unsigned char)*source++; ch <<= 6;
-    case 1: ch += (unsigned char)*source++; ch <<= 6;
-    case 0: ch += (unsigned char)*source++;
-    }
+        if (decode_utf8(state, ch, *source++) == UNI_UTF8_REJECT)
+        {
+            return 0;
+        }
+    } while (state != UNI_UTF8_ACCEPT);
 
-    // Now we need to subtract a value from the character depending on the number
-    // of extra bytes.
-    ch -= g_offsetsFromUTF8[extra_bytes];
+    str = reinterpret_cast<const char *>(source);
+
+    return ch;
+}
+
+/**
+*   \brief                Retrieves the next character in a UTF-8 string.
+*   \param  str [in, out] The string whose next character should be retrieved.
+*   \return               The character that was being pointed to by \c str.
+*
+*   \remarks
+*       If this function returns NULL, the null terminator was retrieved. When this occurs, the string
+*       is _not_ moved forward to the next character (there is no characters after the null terminator).
+*/
+inline uchar32_t nextchar_utf8(const char *&str)
+{
+    assert(str != NULL);
+
+#ifdef EASL_ONLY_ASCII
+    char32_t ch = *str;
 
-    // If the character is a null terminator, we don't want to modify the string.
     if (ch != '\0')
     {
-        str = source;
+        ++str;
     }
 
     return ch;
+#elif defined(EASL_OPTION_TRUSTED_UTF8)
+    return nextchar_utf8_trusted(str);
+#else
+    return nextchar_utf8_strict(str);
 #endif
 }
 
@@ -118,7 +189,7 @@ inline uchar32_t nextchar_utf16(const char16_t *&str)
     // otherwise 'source' is already pointing to an invalid memory address.
     if (ch != 0)
     {
-        if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_LOW_START)
+        if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_HIGH_END)
         {
             // Make sure the source isn't at it's null terminator. If it is, we have an
             // error, so we will return 0.
@@ -172,6 +243,194 @@ inline uchar32_t nextchar_utf32(const char32_t *&str)
 
 
 
+/**
+*   \brief                   Retrieves the next character in a trusted UTF-8 string without reading past the end of the string.
+*   \param  str    [in, out] The string whose next character should be retrieved.
+*   \param  strEnd [in]      Pointer to the end of the string.
+*   \return                  The character that was being pointed to by \c str.
+*
+*   \remarks
+*       Like nextchar_utf8_trusted(const char *&), the character is not checked for errors. The only
+*       check is that the sequence is not cut off by the end of the string. If it is, or if \c str is
+*       at the end of the string, 0 is returned and \c str is not moved.
+*/
+inline uchar32_t nextchar_utf8_trusted(const char *&str, const char *strEnd)
+{
+    assert(str != NULL);
+
+    if (str >= strEnd)
+    {
+        return 0;
+    }
+
+    const unsigned char *source = reinterpret_cast<const unsigned char *>(str);
+    if (*source < 0x80)
+    {
+        ++str;
+        return *source;
+    }
+
+    // The string is well formed, so we only need to make sure the sequence isn't cut off.
+    if (g_trailingBytesForUTF8[*source] >= strEnd - str)
+    {
+        return 0;
+    }
+
+    return nextchar_utf8_trusted(str);
+}
+
+/**
+*   \brief                   Retrieves the next character in a UTF-8 string without reading past the end of the string, checking it for errors.
+*   \param  str    [in, out] The string whose next character should be retrieved.
+*   \param  strEnd [in]      Pointer to the end of the string.
+*   \return                  The character that was being pointed to by \c str.
+*
+*   \remarks
+*       This behaves the same way as nextchar_utf8(const char *&, const char *) in the default build. It is
+*       not affected by EASL_ONLY_ASCII or EASL_OPTION_TRUSTED_UTF8.
+*/
+inline uchar32_t nextchar_utf8_strict(const char *&str, const char *strEnd)
+{
+    assert(str != NULL);
+
+    if (str >= strEnd)
+    {
+        return 0;
+    }
+
+    const unsigned char *source = reinterpret_cast<const unsigned char *>(str);
+    if (*source < 0x80)
+    {
+        ++str;
+        return *source;
+    }
+
+    const unsigned char *end = reinterpret_cast<const unsigned char *>(strEnd);
+
+    unsigned int state = UNI_UTF8_ACCEPT;
+    uchar32_t    ch    = 0;
+    do
+    {
+        if (source == end || decode_utf8(state, ch, *source++) == UNI_UTF8_REJECT)
+        {
+            return 0;
+        }
+    } while (state != UNI_UTF8_ACCEPT);
+
+    str = reinterpret_cast<const char *>(source);
+
+    return ch;
+}
+
+/**
+*   \brief                   Retrieves the next character in a UTF-8 string without reading past the end of the string.
+*   \param  str    [in, out] The string whose next character should be retrieved.
+*   \param  strEnd [in]      Pointer to the end of the string.
+*   \return                  The character that was being pointed to by \c str.
+*
+*   \remarks
+*       The string does not need to be null terminated. A null character is decoded like any other
+*       character and no byte at or past \c strEnd is ever read, so this function can be used on
+*       memory mapped files and other buffers that are not null terminated.
+*       \par
+*       If \c str is at the end of the string, or the character is invalid or is split by the end of
+*       the string, 0 is returned and \c str is not moved. A null character can be told apart from
+*       these cases by checking whether or not \c str was moved.
+*/
+inline uchar32_t nextchar_utf8(const char *&str, const char *strEnd)
+{
+    assert(str != NULL);
+
+    if (str >= strEnd)
+    {
+        return 0;
+    }
+
+    const unsigned char *source = reinterpret_cast<const unsigned char *>(str);
+
+#ifdef EASL_ONLY_ASCII
+    ++str;
+    return *source;
+#else
+    // ASCII is by far the most common case, so we get it out of the way first.
+    if (*source < 0x80)
+    {
+        ++str;
+        return *source;
+    }
+
+#if defined(EASL_OPTION_TRUSTED_UTF8)
+    return nextchar_utf8_trusted(str, strEnd);
+#else
+    return nextchar_utf8_strict(str, strEnd);
+#endif
+#endif
+}
+
+/**
+*   \brief                   Retrieves the next character in a UTF-16 string without reading past the end of the string.
+*   \param  str    [in, out] The string whose next character should be retrieved.
+*   \param  strEnd [in]      Pointer to the end of the string.
+*   \return                  The character that was being pointed to by \c str.
+*
+*   \remarks
+*       This behaves the same way as nextchar_utf8(const char *&, const char *). An unpaired high
+*       surrogate, including one that is split from its low surrogate by the end of the string,
+*       returns 0 without moving \c str.
+*/
+inline uchar32_t nextchar_utf16(const char16_t *&str, const char16_t *strEnd)
+{
+    assert(str != NULL);
+
+    if (str >= strEnd)
+    {
+        return 0;
+    }
+
+    uchar32_t ch = (uchar32_t)(uchar16_t)*str;
+
+#ifndef EASL_ONLY_ASCII
+    if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_HIGH_END)
+    {
+        if (strEnd - str < 2)
+        {
+            return 0;
+        }
+
+        uchar32_t ch2 = (uchar32_t)(uchar16_t)str[1];
+        if (ch2 < UNI_SUR_LOW_START || ch2 > UNI_SUR_LOW_END)
+        {
+            return 0;
+        }
+
+        str += 2;
+        return ((ch - UNI_SUR_HIGH_START) << UNI_HALF_SHIFT) + (ch2 - UNI_SUR_LOW_START) + UNI_HALF_BASE;
+    }
+#endif
+
+    ++str;
+    return ch;
+}
+
+/**
+*   \brief                   Retrieves the next character in a UTF-32 string without reading past the end of the string.
+*   \param  str    [in, out] The string whose next character should be retrieved.
+*   \param  strEnd [in]      Pointer to the end of the string.
+*   \return                  The character that was being pointed to by \c str; or 0 if \c str is at the end of the string.
+*/
+inline uchar32_t nextchar_utf32(const char32_t *&str, const char32_t *strEnd)
+{
+    assert(str != NULL);
+
+    if (str >= strEnd)
+    {
+        return 0;
+    }
+
+    return static_cast<uchar32_t>(*str++);
+}
+
+
 /**
 *   \brief                Retrieves the next character in a string and moves the pointer to the start of the next character.
 *   \param  str [in, out] Pointer to the string to retrieve the character from.
@@ -198,7 +457,17 @@ inline uchar32_t nextchar(const wchar_t *&str)
     switch (sizeof(wchar_t))
     {
     case 2: return nextchar_utf16((const char16_t *&)str);
-    case 4: return nextchar_utf32((const char32_t *&)str);
+    case 4:
+        {
+            // char32_t is not necessarily 32 bits, so we can't treat the string as a char32_t string.
+            uchar32_t ch = static_cast<uchar32_t>(static_cast<unsigned int>(*str));
+            if (ch != 0)
+            {
+                ++str;
+            }
+
+            return ch;
+        }
     }
 
     return nextchar_utf8((const char *&)str);
@@ -211,24 +480,74 @@ inline uchar32_t nextchar(T *&str)
 }
 
 
+/**
+*   \brief                   Retrieves the next character in a string without reading past the end of the string.
+*   \param  str    [in, out] Pointer to the string to retrieve the character from.
+*   \param  strEnd [in]      Pointer to the end of the string.
+*   \return                  The character that was being pointed to by \c str.
+*
+*   \remarks
+*       The string does not need to be null terminated, and null characters are decoded like any
+*       other character. If \c str is at the end of the string, or the character is invalid or is
+*       split by the end of the string, 0 is returned and \c str is not moved.
+*       \par
+*       Loops over a buffer should check \c str against \c strEnd rather than checking the returned
+*       character against the null terminator.
+*/
+inline uchar32_t nextchar(const char *&str, const char *strEnd)
+{
+    return nextchar_utf8(str, strEnd);
+}
+inline uchar32_t nextchar(const char16_t *&str, const char16_t *strEnd)
+{
+    return nextchar_utf16(str, strEnd);
+}
+inline uchar32_t nextchar(const char32_t *&str, const char32_t *strEnd)
+{
+    return nextchar_utf32(str, strEnd);
+}
+inline uchar32_t nextchar(const wchar_t *&str, const wchar_t *strEnd)
+{
+    switch (sizeof(wchar_t))
+    {
+    case 2: return nextchar_utf16((const char16_t *&)str, (const char16_t *)strEnd);
+    case 4:
+        {
+            if (str >= strEnd)
+            {
+                return 0;
+            }
+
+            return static_cast<uchar32_t>(static_cast<unsigned int>(*str++));
+        }
+    }
+
+    return nextchar_utf8((const char *&)str, (const char *)strEnd);
+}
+
+template <typename T>
+inline uchar32_t nextchar(T *&str, const T *strEnd)
+{
+    return nextchar((const T *&)str, strEnd);
+}
+
+
 /**
 *   \brief                Retrieves the next character in a string and moves the pointer to the start of the next character.
 *   \param  str [in, out] Pointer to the string to retrieve the character from.
 *   \return               The character that was being pointed to by \c str.
 *
 *   \remarks
-*       If this function returns NULL, the start character is either larger or equal to the end
-*       pointer. When this occurs, the start pointer is _not_ modified.
+*       If this function returns NULL and the start pointer was not moved, the start pointer is either
+*       larger or equal to the end pointer, or the next character is invalid or split by the end pointer.
+*       \par
+*       Nothing at or past the end pointer is read, so the referenced string does not need to be
+*       null terminated. Null characters inside the string are returned like any other character.
 */
 template <typename T>
 inline uchar32_t nextchar(reference_string<T> &str)
 {
-    if (str.start >= str.end)
-    {
-        return NULL;
-    }
-
-    return nextchar(str.start);
+    return nextchar(str.start, str.end);
 }
 
 
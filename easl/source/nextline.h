@@ -78,6 +78,54 @@ inline bool nextline(reference_string<T> &line, T *&str)
 }
 
 
+/**
+*   \brief                  Retrieves the line at the start of a reference string and moves the string to the next one.
+*   \param  line      [out] The reference string that will recieve the line.
+*   \param  str   [in, out] The string to retrieve the line from.
+*   \return                 True if a line was retrieved; false if \c str is empty.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated and nothing at or past the end of it
+*       is read. This makes it possible to walk over the lines of a memory mapped file directly.
+*       \par
+*       "\n" and "\r\n" both end a line. Neither is ever part of a continuation byte or surrogate, so
+*       the string is scanned T by T rather than being decoded.
+*       \par
+*       The returned string will not contain the new-line delimiter.
+*/
+template <typename T>
+inline bool nextline(reference_string<T> &line, reference_string<T> &str)
+{
+    if (str.start >= str.end)
+    {
+        return false;
+    }
+
+    line.start = str.start;
+
+    T *temp = str.start;
+    while (temp < str.end && *temp != '\n')
+    {
+        ++temp;
+    }
+
+    line.end = temp;
+    if (temp < str.end)
+    {
+        if (line.end > line.start && line.end[-1] == '\r')
+        {
+            --line.end;
+        }
+
+        ++temp;
+    }
+
+    str.start = temp;
+
+    return true;
+}
+
+
 }
 
 #endif // __EASL_NEXTLINE_H_
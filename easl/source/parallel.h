@@ -0,0 +1,564 @@
+/**
+*   \file   parallel.h
+*   \author Dave Reid
+*   \brief  Header file for the multi-threaded versions of copy(), copysize(), charcount() and validate_utf8().
+*
+*   Very large strings are split into chunks that each start on a character, and each chunk is then
+*   processed on its own thread. Conversions are done in two passes: the first pass measures the
+*   output of every chunk, a prefix sum of those sizes gives each chunk its place in the destination,
+*   and the second pass converts every chunk straight into that place.
+*
+*   The results are always the same as those of the single threaded functions, including where a
+*   conversion stops because of an invalid sequence or a destination that is too small. Strings that
+*   are smaller than EASL_PARALLEL_THRESHOLD bytes, and every string when EASL_HAS_THREADS is not
+*   defined, are simply passed on to the single threaded functions.
+*   \par
+*   The threads are started with std::thread, so GCC and Clang may need -pthread.
+*/
+#ifndef __EASL_PARALLEL_H_
+#define __EASL_PARALLEL_H_
+
+#include <vector>
+#include "setup.h"
+#include "copy.h"
+#include "copysize.h"
+#include "charcount.h"
+#include "validate.h"
+#include "encoding.h"
+
+#if defined(EASL_HAS_THREADS)
+#include <thread>
+#endif
+
+namespace easl
+{
+
+/// The size in bytes below which a string is always processed on the calling thread.
+#ifndef EASL_PARALLEL_THRESHOLD
+#define EASL_PARALLEL_THRESHOLD     (4 * 1024 * 1024)
+#endif
+
+/// The smallest chunk in bytes that is given a thread of it's own.
+#ifndef EASL_PARALLEL_CHUNK_SIZE
+#define EASL_PARALLEL_CHUNK_SIZE    (1024 * 1024)
+#endif
+
+
+/**
+*   \brief                  Retrieves the number of chunks a string should be split into.
+*   \param  bytes       [in] The size of the string in bytes.
+*   \param  threadCount [in] The largest number of threads to use; or 0 to use one for each core.
+*   \return                 The number of chunks. This is 1 when the string should not be split.
+*/
+inline size_t _parallel_chunk_count(size_t bytes, unsigned int threadCount)
+{
+#if defined(EASL_HAS_THREADS)
+    if (bytes < EASL_PARALLEL_THRESHOLD)
+    {
+        return 1;
+    }
+
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    size_t chunk_count = bytes / EASL_PARALLEL_CHUNK_SIZE;
+    if (chunk_count > threadCount)
+    {
+        chunk_count = threadCount;
+    }
+
+    return (chunk_count > 1) ? chunk_count : 1;
+#else
+    (void)bytes;
+    (void)threadCount;
+
+    return 1;
+#endif
+}
+
+/**
+*   \brief                 Calls a function once for each chunk, each on it's own thread.
+*   \param  chunkCount [in] The number of chunks.
+*   \param  func       [in] The function object to call. It is given the index of the chunk.
+*
+*   \remarks
+*       The first chunk is processed on the calling thread. This returns once every chunk is done.
+*/
+template <typename F>
+inline void _parallel_for(size_t chunkCount, const F &func)
+{
+#if defined(EASL_HAS_THREADS)
+    std::vector<std::thread> threads;
+    threads.reserve(chunkCount);
+
+    for (size_t i = 1; i < chunkCount; ++i)
+    {
+        threads.push_back(std::thread(func, i));
+    }
+
+    func(0);
+
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        threads[i].join();
+    }
+#else
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        func(i);
+    }
+#endif
+}
+
+/**
+*   \brief                 Moves an offset in a string to the start of the character it is in.
+*   \param  str       [in] The string.
+*   \param  offset    [in] The offset in T's. This must be larger than 0 and smaller than the length of the string.
+*   \return                The offset of a character boundary near \c offset.
+*
+*   \remarks
+*       UTF-8 is self-synchronising, so the start of a character is found by skipping back over at most
+*       3 continuation bytes. If there are more than that, the bytes are invalid anyway and the decoders
+*       will stop at them whichever chunk they're in. In UTF-16, a high surrogate is always kept in the
+*       same chunk as the unit after it.
+*/
+template <typename T>
+inline size_t _parallel_boundary(const T *str, size_t offset)
+{
+    if (sizeof(T) == 1)
+    {
+        for (int i = 0; i < 3 && offset > 1 && (_encoding_unit(str[offset]) & 0xC0) == 0x80; ++i)
+        {
+            --offset;
+        }
+    }
+    else if (sizeof(T) == 2)
+    {
+        uchar32_t prev = _encoding_unit(str[offset - 1]);
+        if (prev >= UNI_SUR_HIGH_START && prev <= UNI_SUR_HIGH_END)
+        {
+            ++offset;
+        }
+    }
+
+    return offset;
+}
+
+/**
+*   \brief                  Splits a string into chunks that each start on a character.
+*   \param  str        [in]  The string to split.
+*   \param  strLength  [in]  The length of the string in T's.
+*   \param  chunkCount [in]  The number of chunks.
+*   \param  bounds     [out] Receives chunkCount + 1 pointers. Chunk i is from bounds[i] up to bounds[i + 1].
+*/
+template <typename T>
+inline void _parallel_split(const T *str, size_t strLength, size_t chunkCount, std::vector<const T *> &bounds)
+{
+    bounds.resize(chunkCount + 1);
+    bounds[0] = str;
+
+    for (size_t i = 1; i < chunkCount; ++i)
+    {
+        bounds[i] = str + _parallel_boundary(str, strLength / chunkCount * i);
+    }
+
+    bounds[chunkCount] = str + strLength;
+}
+
+
+/**
+*   \brief  First pass of parallel_copy(). Measures the output of a chunk and where its conversion stops.
+*/
+template <typename T, typename U>
+struct _parallel_measure
+{
+    const U **bounds;
+    const U **stops;
+    size_t   *sizes;
+
+    void operator()(size_t i) const
+    {
+        const U *source = bounds[i];
+        sizes[i] = transcode((T *)NULL, (size_t)-1, source, bounds[i + 1]);
+        stops[i] = source;
+    }
+};
+
+/**
+*   \brief  Second pass of parallel_copy(). Converts a chunk into it's place in the destination.
+*/
+template <typename T, typename U>
+struct _parallel_convert
+{
+    T              *dest;
+    const U       **bounds;
+    const size_t   *offsets;
+    size_t         *sizes;
+
+    void operator()(size_t i) const
+    {
+        const U *source = bounds[i];
+        sizes[i] = transcode(dest + offsets[i], sizes[i], source, bounds[i + 1]);
+    }
+};
+
+/**
+*   \brief                     Copies a string over to another string, converting the string on several threads.
+*   \param  dest         [out] The destination buffer.
+*   \param  source       [in]  The source string.
+*   \param  destSize     [in]  The size of the destination buffer in T's.
+*   \param  sourceLength [in]  The maximum number of U's to copy from the source.
+*   \param  threadCount  [in]  The largest number of threads to use; or 0 to use one for each core.
+*   \return                    The number of T's that are copied to the destination.
+*
+*   \remarks
+*       This gives the same results as copy(T *, const U *, size_t, size_t). Strings that don't need to
+*       be converted are copied with a single memcpy(), since that is limited by memory bandwidth rather
+*       than by the CPU.
+*/
+template <typename T, typename U>
+inline size_t parallel_copy(T *dest, const U *source, size_t destSize = -1, size_t sourceLength = -1, unsigned int threadCount = 0)
+{
+    if (source == NULL || destSize == 0)
+    {
+        return 0;
+    }
+
+    if (sourceLength == (size_t)-1)
+    {
+        sourceLength = length(source);
+    }
+    else
+    {
+        sourceLength = length(source, sourceLength);
+    }
+
+    size_t chunk_count = _parallel_chunk_count(sourceLength * sizeof(U), threadCount);
+    if (chunk_count == 1)
+    {
+        return copy(dest, source, destSize, sourceLength);
+    }
+
+    std::vector<const U *> bounds;
+    _parallel_split(source, sourceLength, chunk_count, bounds);
+
+    std::vector<const U *> stops(chunk_count);
+    std::vector<size_t>    sizes(chunk_count);
+
+    _parallel_measure<T, U> measure;
+    measure.bounds = &bounds[0];
+    measure.stops  = &stops[0];
+    measure.sizes  = &sizes[0];
+    _parallel_for(chunk_count, measure);
+
+    // A chunk that stops early has an invalid sequence in it, which is where the conversion ends. The
+    // chunk is measured again up to the end of the whole string to make sure it stops in the same place
+    // as it would have without being split. Everything after it is dropped.
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        if (stops[i] != bounds[i + 1])
+        {
+            const U *temp = bounds[i];
+            sizes[i] = transcode((T *)NULL, (size_t)-1, temp, source + sourceLength);
+
+            bounds[i + 1] = temp;
+            chunk_count   = i + 1;
+            break;
+        }
+    }
+
+    // The prefix sum of the sizes gives each chunk its place in the destination.
+    std::vector<size_t> offsets(chunk_count + 1);
+    offsets[0] = 0;
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        offsets[i + 1] = offsets[i] + sizes[i];
+    }
+
+    if (dest == NULL)
+    {
+        return offsets[chunk_count] + 1;
+    }
+
+    // If it doesn't all fit, the chunk that reaches the end of the destination is given whatever room is
+    // left, which it will stop short of if a character doesn't fit. We need to leave room for the null
+    // terminator.
+    if (offsets[chunk_count] > destSize - 1)
+    {
+        size_t last = 0;
+        while (offsets[last + 1] <= destSize - 1)
+        {
+            ++last;
+        }
+
+        sizes[last] = destSize - 1 - offsets[last];
+        chunk_count = last + 1;
+    }
+
+    _parallel_convert<T, U> convert;
+    convert.dest    = dest;
+    convert.bounds  = &bounds[0];
+    convert.offsets = &offsets[0];
+    convert.sizes   = &sizes[0];
+    _parallel_for(chunk_count, convert);
+
+    size_t copy_size = offsets[chunk_count - 1] + sizes[chunk_count - 1];
+    dest[copy_size] = '\0';
+
+    return copy_size + 1;
+}
+
+template <typename T>
+inline size_t parallel_copy(T *dest, const T *source, size_t destSize = -1, size_t sourceLength = -1, unsigned int threadCount = 0)
+{
+    (void)threadCount;
+    return copy(dest, source, destSize, sourceLength);
+}
+
+
+/**
+*   \brief                    Determines the size required for a buffer to store the specified string, measuring the string on several threads.
+*   \param  source       [in] The string to look at to determine the size of the output buffer.
+*   \param  sourceLength [in] The length of the source strings in U's, not including the null terminator
+*   \param  threadCount  [in] The largest number of threads to use; or 0 to use one for each core.
+*   \return                   The minimum size that a buffer must be in order to store the specified string.
+*
+*   \remarks
+*       The T template parameter specifies the type of the destination buffer. This gives the same result
+*       as copysize().
+*/
+template <typename T, typename U>
+inline size_t parallel_copysize(const U *source, size_t sourceLength = -1, unsigned int threadCount = 0)
+{
+    return parallel_copy((T *)NULL, source, (size_t)-1, sourceLength, threadCount);
+}
+
+
+/**
+*   \brief                 Counts the characters in a chunk.
+*   \param  str       [in]  Pointer to the start of the chunk.
+*   \param  strEnd    [in]  Pointer to the end of the chunk.
+*   \param  stop      [out] Receives a pointer to where the counting stopped.
+*   \return                 The number of characters before \c stop.
+*/
+template <typename T>
+inline size_t _parallel_charcount_chunk(const T *str, const T *strEnd, const T *&stop)
+{
+    size_t count = 0;
+    while (str < strEnd)
+    {
+        const T *next = str;
+        nextchar(next, strEnd);
+
+        if (next == str)
+        {
+            break;
+        }
+
+        str = next;
+        ++count;
+    }
+
+    stop = str;
+    return count;
+}
+inline size_t _parallel_charcount_chunk(const char *str, const char *strEnd, const char *&stop)
+{
+    // UTF-8 is counted without decoding it, so it never stops early.
+    stop = strEnd;
+    return _charcount_span(str, strEnd);
+}
+inline size_t _parallel_charcount_chunk(const char16_t *str, const char16_t *strEnd, const char16_t *&stop)
+{
+#ifdef EASL_ONLY_ASCII
+    stop = strEnd;
+    return strEnd - str;
+#else
+    size_t units;
+    size_t count = _charcount_utf16(str, strEnd - str, &units);
+
+    stop = str + units;
+    return count;
+#endif
+}
+inline size_t _parallel_charcount_chunk(const char32_t *str, const char32_t *strEnd, const char32_t *&stop)
+{
+    stop = strEnd;
+    return strEnd - str;
+}
+inline size_t _parallel_charcount_chunk(const wchar_t *str, const wchar_t *strEnd, const wchar_t *&stop)
+{
+    if (sizeof(wchar_t) == 2)
+    {
+        const char16_t *temp;
+        size_t count = _parallel_charcount_chunk((const char16_t *)str, (const char16_t *)strEnd, temp);
+
+        stop = (const wchar_t *)temp;
+        return count;
+    }
+
+    stop = strEnd;
+    return strEnd - str;
+}
+
+/**
+*   \brief  Counts the characters in a chunk for parallel_charcount().
+*/
+template <typename T>
+struct _parallel_count
+{
+    const T **bounds;
+    const T **stops;
+    size_t   *counts;
+
+    void operator()(size_t i) const
+    {
+        counts[i] = _parallel_charcount_chunk(bounds[i], bounds[i + 1], stops[i]);
+    }
+};
+
+/**
+*   \brief                 Retrieves the number of characters in the given string, counting them on several threads.
+*   \param  str         [in] The string to check.
+*   \param  strLength   [in] The length in T's of the string, not including the null terminator.
+*   \param  threadCount [in] The largest number of threads to use; or 0 to use one for each core.
+*   \return                  The number of characters that make up the string.
+*
+*   \remarks
+*       This gives the same result as charcount(const T *, size_t).
+*/
+template <typename T>
+inline size_t parallel_charcount(const T *str, size_t strLength = -1, unsigned int threadCount = 0)
+{
+    strLength = (strLength == (size_t)-1) ? length(str) : length(str, strLength);
+
+    size_t chunk_count = _parallel_chunk_count(strLength * sizeof(T), threadCount);
+    if (chunk_count == 1)
+    {
+        return charcount(str, strLength);
+    }
+
+    std::vector<const T *> bounds;
+    _parallel_split(str, strLength, chunk_count, bounds);
+
+    std::vector<const T *> stops(chunk_count);
+    std::vector<size_t>    counts(chunk_count);
+
+    _parallel_count<T> count;
+    count.bounds = &bounds[0];
+    count.stops  = &stops[0];
+    count.counts = &counts[0];
+    _parallel_for(chunk_count, count);
+
+    // Counting ends at the first chunk that stops early.
+    size_t total = 0;
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        total += counts[i];
+
+        if (stops[i] != bounds[i + 1])
+        {
+            break;
+        }
+    }
+
+    return total;
+}
+
+
+/**
+*   \brief  Validates a chunk for parallel_validate_utf8().
+*/
+struct _parallel_validate
+{
+    const char **bounds;
+    bool        *results;
+
+    void operator()(size_t i) const
+    {
+        results[i] = validate_utf8(bounds[i], bounds[i + 1] - bounds[i]);
+    }
+};
+
+/**
+*   \brief                    Validates a UTF-8 string, checking it on several threads.
+*   \param  str          [in]  The string to validate.
+*   \param  strLength    [in]  The length in bytes of the string, or -1 if the string is null terminated.
+*   \param  errorOffset  [out] Pointer to the variable that will receive the offset of the first invalid sequence. Can be NULL.
+*   \param  threadCount  [in]  The largest number of threads to use; or 0 to use one for each core.
+*   \return                    True if the string is well formed UTF-8; false otherwise.
+*
+*   \remarks
+*       This gives the same results as validate_utf8(const char *, size_t, size_t *).
+*/
+inline bool parallel_validate_utf8(const char *str, size_t strLength = -1, size_t *errorOffset = NULL, unsigned int threadCount = 0)
+{
+    assert(str != NULL);
+
+    if (strLength == (size_t)-1)
+    {
+        strLength = length(str);
+    }
+
+    size_t chunk_count = _parallel_chunk_count(strLength, threadCount);
+    if (chunk_count == 1)
+    {
+        return validate_utf8(str, strLength, errorOffset);
+    }
+
+    std::vector<const char *> bounds;
+    _parallel_split(str, strLength, chunk_count, bounds);
+
+    // std::vector<bool> packs its elements into bits, which threads can't write to separately.
+    bool *results = new bool[chunk_count];
+
+    _parallel_validate validate;
+    validate.bounds  = &bounds[0];
+    validate.results = results;
+    _parallel_for(chunk_count, validate);
+
+    // The offset of the first error is found by validating again from the start of the first invalid
+    // chunk. That stops at the error, which is normally inside that chunk.
+    bool valid = true;
+    for (size_t i = 0; i < chunk_count; ++i)
+    {
+        if (!results[i])
+        {
+            size_t offset;
+            valid = validate_utf8(bounds[i], (str + strLength) - bounds[i], &offset);
+
+            if (errorOffset != NULL)
+            {
+                *errorOffset = (bounds[i] - str) + offset;
+            }
+
+            break;
+        }
+    }
+
+    delete [] results;
+
+    if (valid && errorOffset != NULL)
+    {
+        *errorOffset = strLength;
+    }
+
+    return valid;
+}
+
+inline bool parallel_validate_utf8(const reference_string<const char> &str, size_t *errorOffset = NULL, unsigned int threadCount = 0)
+{
+    return parallel_validate_utf8(str.start, length(str), errorOffset, threadCount);
+}
+
+inline bool parallel_validate_utf8(const reference_string<char> &str, size_t *errorOffset = NULL, unsigned int threadCount = 0)
+{
+    return parallel_validate_utf8(str.start, length(str), errorOffset, threadCount);
+}
+
+
+}
+
+#endif // __EASL_PARALLEL_H_
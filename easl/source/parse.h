@@ -7,16 +7,15 @@
 #define __EASL_PARSE_H_
 
 #include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
 #include <locale.h>
 #include "setup.h"
 #include "types.h"
 #include "findfirst.h"
 #include "equal.h"
 #include "copysize.h"
-
-#if (COMPILER & COMPILER_GCC)
-#include <wchar.h>
-#endif
+#include "allocator.h"
 
 namespace easl
 {
@@ -41,19 +40,22 @@ inline U parse(const T *str, size_t strLength = -1)
     // If a specialisation hasn't been created for the U data type, the compiler should
     // throw an error.
 
+    // The temporary buffer comes from temp_allocator, which avoids the heap for short strings.
+    temp_allocator allocator;
+
     size_t temp_size = easl::copysize<wchar_t>(str, strLength);
-    wchar_t *temp = new wchar_t[temp_size];
-    easl::copy(temp, str, temp_size);
+    wchar_t *temp = static_cast<wchar_t *>(allocator.allocate(temp_size * sizeof(wchar_t)));
+    easl::copy(temp, str, temp_size, strLength);
 
     U value = parse<U>(temp);
 
-    delete [] temp;
+    allocator.deallocate(temp);
 
     return value;
 }
 
 #ifdef EASL_ONLY_ASCII
-template <> inline __int64 parse(const char *str, size_t strLength)
+template <> inline int64 parse(const char *str, size_t strLength)
 {
     (void)strLength;
 
@@ -63,7 +65,7 @@ template <> inline __int64 parse(const char *str, size_t strLength)
     return ::strtoll(str, NULL, 10);
 #endif
 }
-template <> inline unsigned __int64 parse(const char *str, size_t strLength)
+template <> inline uint64 parse(const char *str, size_t strLength)
 {
     (void)strLength;
 
@@ -76,38 +78,38 @@ template <> inline unsigned __int64 parse(const char *str, size_t strLength)
 
 template <> inline int parse(const char *str, size_t strLength)
 {
-    return static_cast<int>(parse<__int64>(str, strLength));
+    return static_cast<int>(parse<int64>(str, strLength));
 }
 template <> inline unsigned int parse(const char *str, size_t strLength)
 {
-    return static_cast<unsigned int>(parse<unsigned __int64>(str, strLength));
+    return static_cast<unsigned int>(parse<uint64>(str, strLength));
 }
 
 template <> inline long parse(const char *str, size_t strLength)
 {
-    return static_cast<long>(parse<__int64>(str, strLength));
+    return static_cast<long>(parse<int64>(str, strLength));
 }
 template <> inline unsigned long parse(const char *str, size_t strLength)
 {
-    return static_cast<unsigned long>(parse<unsigned __int64>(str, strLength));
+    return static_cast<unsigned long>(parse<uint64>(str, strLength));
 }
 
 template <> inline short parse(const char *str, size_t strLength)
 {
-    return static_cast<short>(parse<__int64>(str, strLength));
+    return static_cast<short>(parse<int64>(str, strLength));
 }
 template <> inline unsigned short parse(const char *str, size_t strLength)
 {
-    return static_cast<unsigned short>(parse<unsigned __int64>(str, strLength));
+    return static_cast<unsigned short>(parse<uint64>(str, strLength));
 }
 
 template <> inline char parse(const char *str, size_t strLength)
 {
-    return static_cast<signed char>(parse<__int64>(str, strLength));
+    return static_cast<signed char>(parse<int64>(str, strLength));
 }
 template <> inline unsigned char parse(const char *str, size_t strLength)
 {
-    return static_cast<unsigned char>(parse<unsigned __int64>(str, strLength));
+    return static_cast<unsigned char>(parse<uint64>(str, strLength));
 }
 
 template <> inline float parse(const char *str, size_t strLength)
@@ -134,7 +136,7 @@ template <> inline bool parse(const char *str, size_t strLength)
 }
 #endif
 
-template <> inline __int64 parse(const wchar_t *str, size_t strLength)
+template <> inline int64 parse(const wchar_t *str, size_t strLength)
 {
     (void)strLength;
 
@@ -144,7 +146,7 @@ template <> inline __int64 parse(const wchar_t *str, size_t strLength)
     return ::wcstoll(str, NULL, 10);
 #endif
 }
-template <> inline unsigned __int64 parse(const wchar_t *str, size_t strLength)
+template <> inline uint64 parse(const wchar_t *str, size_t strLength)
 {
     (void)strLength;
 
@@ -157,38 +159,38 @@ template <> inline unsigned __int64 parse(const wchar_t *str, size_t strLength)
 
 template <> inline int parse(const wchar_t *str, size_t strLength)
 {
-    return static_cast<int>(parse<__int64>(str, strLength));
+    return static_cast<int>(parse<int64>(str, strLength));
 }
 template <> inline unsigned int parse(const wchar_t *str, size_t strLength)
 {
-    return static_cast<unsigned int>(parse<unsigned __int64>(str, strLength));
+    return static_cast<unsigned int>(parse<uint64>(str, strLength));
 }
 
 template <> inline long parse(const wchar_t *str, size_t strLength)
 {
-    return static_cast<long>(parse<__int64>(str, strLength));
+    return static_cast<long>(parse<int64>(str, strLength));
 }
 template <> inline unsigned long parse(const wchar_t *str, size_t strLength)
 {
-    return static_cast<unsigned long>(parse<unsigned __int64>(str, strLength));
+    return static_cast<unsigned long>(parse<uint64>(str, strLength));
 }
 
 template <> inline short parse(const wchar_t *str, size_t strLength)
 {
-    return static_cast<short>(parse<__int64>(str, strLength));
+    return static_cast<short>(parse<int64>(str, strLength));
 }
 template <> inline unsigned short parse(const wchar_t *str, size_t strLength)
 {
-    return static_cast<unsigned short>(parse<unsigned __int64>(str, strLength));
+    return static_cast<unsigned short>(parse<uint64>(str, strLength));
 }
 
 template <> inline signed char parse(const wchar_t *str, size_t strLength)
 {
-    return static_cast<signed char>(parse<__int64>(str, strLength));
+    return static_cast<signed char>(parse<int64>(str, strLength));
 }
 template <> inline unsigned char parse(const wchar_t *str, size_t strLength)
 {
-    return static_cast<unsigned char>(parse<unsigned __int64>(str, strLength));
+    return static_cast<unsigned char>(parse<uint64>(str, strLength));
 }
 
 template <> inline float parse(const wchar_t *str, size_t strLength)
@@ -208,9 +210,17 @@ template <> inline bool parse(const wchar_t *str, size_t strLength)
 {
     // How do we handle different languages for this? We might have to look at the locale and do
     // specific versions based on that locale... seems like it would be quite slow, though.
+#if (PLATFORM == PLATFORM_WINDOWS)
     wchar_t *locale = ::_wsetlocale(LC_ALL, NULL);
+    bool english = findfirst(locale, L"English") || findfirst(locale, L"english");
+#else
+    // Other platforms name their locales after the language code, such as "en_US.UTF-8". The
+    // default "C" locale is English as well.
+    const char *locale = ::setlocale(LC_ALL, NULL);
+    bool english = locale == NULL || ::strncmp(locale, "en", 2) == 0 || ::strcmp(locale, "C") == 0 || ::strcmp(locale, "POSIX") == 0;
+#endif
 
-    if (findfirst(locale, L"English") || findfirst(locale, L"english"))
+    if (english)
     {
         if (str == NULL || equal(str, L"false", false, strLength) || equal(str, L"0", false, strLength))
         {
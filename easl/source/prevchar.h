@@ -0,0 +1,205 @@
+/**
+*   \file   prevchar.h
+*   \author Dave Reid
+*   \brief  Header file for the prevchar() family of functions.
+*/
+#ifndef __EASL_PREVCHAR_H_
+#define __EASL_PREVCHAR_H_
+
+#include <assert.h>
+#include "_private.h"
+#include "reference_string.h"
+#include "nextchar.h"
+
+namespace easl
+{
+
+/**
+*   \brief                     Retrieves the previous character in a UTF-8 string without reading past the start of the string.
+*   \param  str      [in, out] Pointer to just past the character that should be retrieved.
+*   \param  strStart [in]      Pointer to the start of the string.
+*   \return                    The character that ends at \c str.
+*
+*   \remarks
+*       \c str is moved back to the start of the character. If \c str is at the start of the string, or
+*       the bytes before it don't end with a valid character, 0 is returned and \c str is not moved.
+*       \par
+*       The lead byte is found by stepping back over continuation bytes, and the character is then
+*       decoded forwards with nextchar_utf8(const char *&, const char *). A character is only valid if
+*       that decodes it as ending exactly at \c str, so walking a valid string backwards visits the same
+*       characters as walking it forwards.
+*/
+inline uchar32_t prevchar_utf8(const char *&str, const char *strStart)
+{
+    assert(str != NULL);
+
+    if (str <= strStart)
+    {
+        return 0;
+    }
+
+    const unsigned char *source = reinterpret_cast<const unsigned char *>(str);
+
+#ifdef EASL_ONLY_ASCII
+    --str;
+    return source[-1];
+#else
+    // ASCII is by far the most common case, so we get it out of the way first.
+    if (source[-1] < 0x80)
+    {
+        --str;
+        return source[-1];
+    }
+
+    // A character has at most three continuation bytes.
+    const char *start = str - 1;
+    while (start > strStart && str - start < 4 && (static_cast<unsigned char>(*start) & 0xC0) == 0x80)
+    {
+        --start;
+    }
+
+    const char *temp = start;
+    uchar32_t ch = nextchar_utf8(temp, str);
+    if (temp != str)
+    {
+        return 0;
+    }
+
+    str = start;
+    return ch;
+#endif
+}
+
+/**
+*   \brief                     Retrieves the previous character in a UTF-16 string without reading past the start of the string.
+*   \param  str      [in, out] Pointer to just past the character that should be retrieved.
+*   \param  strStart [in]      Pointer to the start of the string.
+*   \return                    The character that ends at \c str.
+*
+*   \remarks
+*       This behaves the same way as prevchar_utf8(const char *&, const char *). An unpaired high
+*       surrogate returns 0 without moving \c str, and an unpaired low surrogate is returned as it
+*       is, the same as nextchar_utf16(const char16_t *&, const char16_t *) does.
+*/
+inline uchar32_t prevchar_utf16(const char16_t *&str, const char16_t *strStart)
+{
+    assert(str != NULL);
+
+    if (str <= strStart)
+    {
+        return 0;
+    }
+
+    uchar32_t ch = (uchar32_t)(uchar16_t)str[-1];
+
+#ifndef EASL_ONLY_ASCII
+    if (ch >= UNI_SUR_HIGH_START && ch <= UNI_SUR_HIGH_END)
+    {
+        return 0;
+    }
+
+    if (ch >= UNI_SUR_LOW_START && ch <= UNI_SUR_LOW_END && str - strStart >= 2)
+    {
+        uchar32_t ch1 = (uchar32_t)(uchar16_t)str[-2];
+        if (ch1 >= UNI_SUR_HIGH_START && ch1 <= UNI_SUR_HIGH_END)
+        {
+            str -= 2;
+            return ((ch1 - UNI_SUR_HIGH_START) << UNI_HALF_SHIFT) + (ch - UNI_SUR_LOW_START) + UNI_HALF_BASE;
+        }
+    }
+#endif
+
+    --str;
+    return ch;
+}
+
+/**
+*   \brief                     Retrieves the previous character in a UTF-32 string without reading past the start of the string.
+*   \param  str      [in, out] Pointer to just past the character that should be retrieved.
+*   \param  strStart [in]      Pointer to the start of the string.
+*   \return                    The character that ends at \c str; or 0 if \c str is at the start of the string.
+*/
+inline uchar32_t prevchar_utf32(const char32_t *&str, const char32_t *strStart)
+{
+    assert(str != NULL);
+
+    if (str <= strStart)
+    {
+        return 0;
+    }
+
+    return static_cast<uchar32_t>(*--str);
+}
+
+
+/**
+*   \brief                     Retrieves the previous character in a string and moves the pointer back to the start of that character.
+*   \param  str      [in, out] Pointer to just past the character that should be retrieved.
+*   \param  strStart [in]      Pointer to the start of the string.
+*   \return                    The character that ends at \c str.
+*
+*   \remarks
+*       This is the reverse of nextchar(T *&, const T *). Nothing before \c strStart is read, and null
+*       characters are decoded like any other character. If \c str is at the start of the string, or
+*       the code units before it don't end with a valid character, 0 is returned and \c str is not moved.
+*       \par
+*       Loops that walk a string backwards should check \c str against \c strStart rather than checking
+*       the returned character against the null terminator.
+*/
+inline uchar32_t prevchar(const char *&str, const char *strStart)
+{
+    return prevchar_utf8(str, strStart);
+}
+inline uchar32_t prevchar(const char16_t *&str, const char16_t *strStart)
+{
+    return prevchar_utf16(str, strStart);
+}
+inline uchar32_t prevchar(const char32_t *&str, const char32_t *strStart)
+{
+    return prevchar_utf32(str, strStart);
+}
+inline uchar32_t prevchar(const wchar_t *&str, const wchar_t *strStart)
+{
+    switch (sizeof(wchar_t))
+    {
+    case 2: return prevchar_utf16((const char16_t *&)str, (const char16_t *)strStart);
+    case 4:
+        {
+            if (str <= strStart)
+            {
+                return 0;
+            }
+
+            return static_cast<uchar32_t>(static_cast<unsigned int>(*--str));
+        }
+    }
+
+    return prevchar_utf8((const char *&)str, (const char *)strStart);
+}
+
+template <typename T>
+inline uchar32_t prevchar(T *&str, const T *strStart)
+{
+    return prevchar((const T *&)str, strStart);
+}
+
+
+/**
+*   \brief                Retrieves the last character of a reference string and moves the end pointer back to the start of that character.
+*   \param  str [in, out] The string to retrieve the character from.
+*   \return               The last character in the string.
+*
+*   \remarks
+*       If this function returns NULL and the end pointer was not moved, the end pointer is either
+*       smaller or equal to the start pointer, or the last character is invalid.
+*/
+template <typename T>
+inline uchar32_t prevchar(reference_string<T> &str)
+{
+    return prevchar(str.end, str.start);
+}
+
+
+}
+
+#endif // __EASL_PREVCHAR_H_
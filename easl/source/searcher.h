@@ -0,0 +1,832 @@
+/**
+*   \file   searcher.h
+*   \author Dave Reid
+*   \brief  Header file for the searcher class.
+*/
+#ifndef __EASL_SEARCHER_H_
+#define __EASL_SEARCHER_H_
+
+#include <assert.h>
+#include <string.h>
+#include "types.h"
+#include "_simd.h"
+#include "length.h"
+
+namespace easl
+{
+
+#if defined(EASL_SIMD_SSE2)
+/**
+*   \brief              Fills a register with copies of a code unit.
+*   \param  unit  [in]  The code unit.
+*   \param  width [in]  The size of a code unit in bytes. This must be 1, 2 or 4.
+*/
+inline __m128i _searcher_broadcast(uchar32_t unit, size_t width)
+{
+    if (width == 1)
+    {
+        return _mm_set1_epi8(static_cast<char>(unit));
+    }
+    else if (width == 2)
+    {
+        return _mm_set1_epi16(static_cast<short>(unit));
+    }
+
+    return _mm_set1_epi32(static_cast<int>(unit));
+}
+
+/**
+*   \brief              Compares two registers code unit by code unit.
+*   \param  a     [in]  The first register.
+*   \param  b     [in]  The second register.
+*   \param  width [in]  The size of a code unit in bytes. This must be 1, 2 or 4.
+*/
+inline __m128i _searcher_cmpeq(__m128i a, __m128i b, size_t width)
+{
+    if (width == 1)
+    {
+        return _mm_cmpeq_epi8(a, b);
+    }
+    else if (width == 2)
+    {
+        return _mm_cmpeq_epi16(a, b);
+    }
+
+    return _mm_cmpeq_epi32(a, b);
+}
+
+/**
+*   \brief              Compares two registers code unit by code unit, checking if the first is greater.
+*   \param  a     [in]  The first register.
+*   \param  b     [in]  The second register.
+*   \param  width [in]  The size of a code unit in bytes. This must be 1, 2 or 4.
+*
+*   \remarks
+*       The code units are compared as signed integers.
+*/
+inline __m128i _searcher_cmpgt(__m128i a, __m128i b, size_t width)
+{
+    if (width == 1)
+    {
+        return _mm_cmpgt_epi8(a, b);
+    }
+    else if (width == 2)
+    {
+        return _mm_cmpgt_epi16(a, b);
+    }
+
+    return _mm_cmpgt_epi32(a, b);
+}
+#endif
+
+
+/**
+*   \brief               Finds a code unit between two pointers.
+*   \param  str    [in]  Pointer to the start of the string to search.
+*   \param  strEnd [in]  Pointer to the end of the string to search.
+*   \param  unit   [in]  The code unit to look for.
+*   \return              A pointer to the first occurance of the code unit; or NULL if it is not found.
+*
+*   \remarks
+*       A byte is looked for with memchr(). Wider code units are compared a whole register at a time.
+*/
+template <typename T>
+inline const T * _findfirst_unit(const T *str, const T *strEnd, T unit)
+{
+    if (sizeof(T) == 1)
+    {
+        return static_cast<const T *>(::memchr(str, static_cast<unsigned char>(unit), strEnd - str));
+    }
+
+#if defined(EASL_SIMD_SSE2)
+    if (sizeof(T) == 2 || sizeof(T) == 4)
+    {
+        const size_t  width  = sizeof(T);
+        const size_t  block  = 16 / width;
+        const __m128i needle = _searcher_broadcast(static_cast<uchar32_t>(unit), width);
+
+        while (static_cast<size_t>(strEnd - str) >= block)
+        {
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+                _searcher_cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i *>(str)), needle, width)));
+
+            if (mask != 0)
+            {
+                return str + _bitscan_forward(mask) / width;
+            }
+
+            str += block;
+        }
+    }
+#endif
+
+    for ( ; str < strEnd; ++str)
+    {
+        if (*str == unit)
+        {
+            return str;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+*   \brief                     Finds a short pattern between two pointers without any preprocessing.
+*   \param  str           [in] Pointer to the start of the string to search.
+*   \param  strEnd        [in] Pointer to the end of the string to search.
+*   \param  pattern       [in] The pattern to look for. This can not be empty.
+*   \param  patternLength [in] The length in T's of the pattern.
+*   \return                    A pointer to the first occurance of the pattern; or NULL if it is not found.
+*
+*   \remarks
+*       Candidates are found by comparing the first and last code unit of the pattern against a whole
+*       register of positions at once, and the rest of the pattern is checked with memcmp(). A single
+*       code unit is looked for with _findfirst_unit(). The time taken grows with the length of the pattern, so this
+*       is only used for patterns that are at most a few T's long, such as a single encoded character.
+*/
+template <typename T>
+inline const T * _findfirst_units(const T *str, const T *strEnd, const T *pattern, size_t patternLength)
+{
+    assert(patternLength > 0);
+
+    if (patternLength == 1)
+    {
+        return _findfirst_unit(str, strEnd, *pattern);
+    }
+
+#if defined(EASL_SIMD_SSE2)
+    if (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)
+    {
+        const size_t  width    = sizeof(T);
+        const size_t  block    = 16 / width;
+        const unsigned int lanes = (width == 1) ? 0xFFFF : (width == 2) ? 0x5555 : 0x1111;
+
+        const __m128i first = _searcher_broadcast(static_cast<uchar32_t>(pattern[0]), width);
+        const __m128i last  = _searcher_broadcast(static_cast<uchar32_t>(pattern[patternLength - 1]), width);
+
+        while (static_cast<size_t>(strEnd - str) >= patternLength + block - 1)
+        {
+            __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str));
+            __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + patternLength - 1));
+
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(
+                _searcher_cmpeq(head, first, width), _searcher_cmpeq(tail, last, width)))) & lanes;
+
+            while (mask != 0)
+            {
+                const T *candidate = str + _bitscan_forward(mask) / width;
+                if (patternLength <= 2 || ::memcmp(candidate + 1, pattern + 1, (patternLength - 2) * sizeof(T)) == 0)
+                {
+                    return candidate;
+                }
+
+                mask &= mask - 1;
+            }
+
+            str += block;
+        }
+    }
+#endif
+
+    for ( ; static_cast<size_t>(strEnd - str) >= patternLength; ++str)
+    {
+        if (*str == *pattern && ::memcmp(str, pattern, patternLength * sizeof(T)) == 0)
+        {
+            return str;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+*   \brief               Finds the last occurance of a code unit between two pointers.
+*   \param  str    [in]  Pointer to the start of the string to search.
+*   \param  strEnd [in]  Pointer to the end of the string to search.
+*   \param  unit   [in]  The code unit to look for.
+*   \return              A pointer to the last occurance of the code unit; or NULL if it is not found.
+*
+*   \remarks
+*       This works back from the end of the string a whole register at a time.
+*/
+template <typename T>
+inline const T * _findlast_unit(const T *str, const T *strEnd, T unit)
+{
+#if defined(EASL_SIMD_SSE2)
+    if (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)
+    {
+        const size_t  width  = sizeof(T);
+        const size_t  block  = 16 / width;
+        const __m128i needle = _searcher_broadcast(static_cast<uchar32_t>(unit), width);
+
+        while (static_cast<size_t>(strEnd - str) >= block)
+        {
+            strEnd -= block;
+
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+                _searcher_cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i *>(strEnd)), needle, width)));
+
+            if (mask != 0)
+            {
+                return strEnd + _bitscan_reverse(mask) / width;
+            }
+        }
+    }
+#endif
+
+    while (strEnd > str)
+    {
+        if (*--strEnd == unit)
+        {
+            return strEnd;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+*   \brief                     Finds the last occurance of a pattern between two pointers without any preprocessing.
+*   \param  str           [in] Pointer to the start of the string to search.
+*   \param  strEnd        [in] Pointer to the end of the string to search.
+*   \param  pattern       [in] The pattern to look for. This can not be empty.
+*   \param  patternLength [in] The length in T's of the pattern.
+*   \return                    A pointer to the last occurance of the pattern; or NULL if it is not found.
+*
+*   \remarks
+*       This is _findfirst_units() run backwards: candidates are found from the end of the string by
+*       comparing the first and last code unit of the pattern against a whole register of positions
+*       at once, and the rest of the pattern is checked with memcmp().
+*/
+template <typename T>
+inline const T * _findlast_units(const T *str, const T *strEnd, const T *pattern, size_t patternLength)
+{
+    assert(patternLength > 0);
+
+    if (patternLength == 1)
+    {
+        return _findlast_unit(str, strEnd, *pattern);
+    }
+
+#if defined(EASL_SIMD_SSE2)
+    if (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)
+    {
+        const size_t  width    = sizeof(T);
+        const size_t  block    = 16 / width;
+        const unsigned int lanes = (width == 1) ? 0xFFFF : (width == 2) ? 0x5555 : 0x1111;
+
+        const __m128i first = _searcher_broadcast(static_cast<uchar32_t>(pattern[0]), width);
+        const __m128i last  = _searcher_broadcast(static_cast<uchar32_t>(pattern[patternLength - 1]), width);
+
+        while (static_cast<size_t>(strEnd - str) >= patternLength + block - 1)
+        {
+            // The block of positions whose windows end in the last block of the string.
+            const T *starts = strEnd - patternLength - block + 1;
+
+            __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(starts));
+            __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(starts + patternLength - 1));
+
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(
+                _searcher_cmpeq(head, first, width), _searcher_cmpeq(tail, last, width)))) & lanes;
+
+            while (mask != 0)
+            {
+                unsigned int bit = _bitscan_reverse(mask);
+
+                const T *candidate = starts + bit / width;
+                if (patternLength <= 2 || ::memcmp(candidate + 1, pattern + 1, (patternLength - 2) * sizeof(T)) == 0)
+                {
+                    return candidate;
+                }
+
+                mask ^= 1U << bit;
+            }
+
+            strEnd -= block;
+        }
+    }
+#endif
+
+    while (static_cast<size_t>(strEnd - str) >= patternLength)
+    {
+        const T *candidate = strEnd - patternLength;
+        if (*candidate == *pattern && ::memcmp(candidate, pattern, patternLength * sizeof(T)) == 0)
+        {
+            return candidate;
+        }
+
+        --strEnd;
+    }
+
+    return NULL;
+}
+
+/**
+*   \brief  A string that has been prepared for searching.
+*
+*   The pattern is preprocessed once when the searcher is constructed, after which it can be
+*   looked for in any number of strings. This is what findfirst() and split() use internally,
+*   but when the same pattern is searched for many times it's cheaper to keep a searcher around:
+*
+*   \code
+*   easl::searcher<char> needle("\r\n");
+*   const char *line_end = easl::findfirst(text, needle, textLength);
+*   \endcode
+*
+*   The search is done with the Two-Way algorithm, so it never takes more than linear time
+*   regardless of the pattern. When SSE2 is available and T is 1, 2 or 4 bytes, candidates are
+*   first found by comparing the first and last code unit of the pattern against a whole register
+*   of positions at once. If the candidates turn out to be mostly false positives, the search
+*   switches over to Two-Way for the rest of the string. Patterns of up to four T's, which is the
+*   most a single character takes, skip Two-Way and only use the filter.
+*
+*   The pattern and the string are compared code unit by code unit without being decoded. Since
+*   UTF-8 and UTF-16 are self-synchronising, a valid pattern can only ever be found at the start of
+*   a character in a valid string.
+*
+*   The pattern is not copied, so it must stay valid for as long as the searcher is used.
+*/
+template <typename T>
+class searcher
+{
+public:
+
+    /**
+    *   \brief                     Constructor.
+    *   \param  pattern       [in] The string to search for.
+    *   \param  patternLength [in] The length in T's of the pattern, not including the null terminator.
+    *
+    *   \remarks
+    *       If the length is -1, the pattern must be null terminated.
+    */
+    searcher(const T *pattern, size_t patternLength = -1)
+        : m_pattern(pattern), m_length(patternLength), m_critical(0), m_period(1), m_memory(0)
+    {
+        assert(pattern != NULL);
+
+        if (m_length == (size_t)-1)
+        {
+            m_length = easl::length(pattern);
+        }
+
+        // The shift for each code unit is the distance from its last occurance in the pattern to
+        // the end of the pattern. Units that are wider than a byte share a slot with every other
+        // unit that has the same low byte, so the shift is the smallest of theirs.
+        for (size_t i = 0; i < 256; ++i)
+        {
+            m_shift[i] = 0;
+        }
+
+        for (size_t i = 0; i < m_length; ++i)
+        {
+            m_shift[_slot(m_pattern[i])] = i + 1;
+        }
+
+        if (m_length > 0)
+        {
+            _factorize();
+        }
+    }
+
+
+    /**
+    *   \brief               Finds the first occurance of the pattern between two pointers.
+    *   \param  str     [in] Pointer to the start of the string to search.
+    *   \param  strEnd  [in] Pointer to the end of the string to search.
+    *   \return              A pointer to the first occurance of the pattern; or NULL if it is not found.
+    *
+    *   \remarks
+    *       The string does not need to be null terminated and nothing at or past \c strEnd is read.
+    *       An empty pattern is found at the start of the string.
+    */
+    const T * find(const T *str, const T *strEnd) const
+    {
+        assert(str <= strEnd);
+
+        if (m_length == 0)
+        {
+            return str;
+        }
+
+        if (static_cast<size_t>(strEnd - str) < m_length)
+        {
+            return NULL;
+        }
+
+        // Short patterns like a single encoded character don't gain anything from Two-Way.
+        if (m_length == 1)
+        {
+            return _findfirst_unit(str, strEnd, *m_pattern);
+        }
+
+        if (m_length <= 4)
+        {
+            return _findfirst_units(str, strEnd, m_pattern, m_length);
+        }
+
+#if defined(EASL_SIMD_SSE2)
+        if (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)
+        {
+            return _find_filtered(str, strEnd);
+        }
+#endif
+
+        return _find_twoway(str, strEnd);
+    }
+
+    /**
+    *   \brief                  Finds the first occurance of the pattern inside a string.
+    *   \param  str       [in]  The string to search.
+    *   \param  strLength [in]  The length in T's of the string, not including the null terminator.
+    *   \return                 A pointer to the first occurance of the pattern; or NULL if it is not found.
+    *
+    *   \remarks
+    *       The search stops at the first null character, even when the length is given.
+    */
+    const T * find(const T *str, size_t strLength = -1) const
+    {
+        assert(str != NULL);
+
+        return find(str, str + ((strLength == (size_t)-1) ? easl::length(str) : easl::length(str, strLength)));
+    }
+
+
+    /**
+    *   \brief               Finds the last occurance of the pattern between two pointers.
+    *   \param  str     [in] Pointer to the start of the string to search.
+    *   \param  strEnd  [in] Pointer to the end of the string to search.
+    *   \return              A pointer to the last occurance of the pattern; or NULL if it is not found.
+    *
+    *   \remarks
+    *       The string is searched from the end, so the time taken depends on how far from the end the
+    *       pattern is rather than on the length of the string. An empty pattern is found at the end of
+    *       the string.
+    */
+    const T * find_last(const T *str, const T *strEnd) const
+    {
+        assert(str <= strEnd);
+
+        if (m_length == 0)
+        {
+            return strEnd;
+        }
+
+        if (static_cast<size_t>(strEnd - str) < m_length)
+        {
+            return NULL;
+        }
+
+        if (m_length <= 4)
+        {
+            return _findlast_units(str, strEnd, m_pattern, m_length);
+        }
+
+#if defined(EASL_SIMD_SSE2)
+        if (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)
+        {
+            return _find_last_filtered(str, strEnd);
+        }
+#endif
+
+        return _find_last_forward(str, strEnd);
+    }
+
+    /**
+    *   \brief                  Finds the last occurance of the pattern inside a string.
+    *   \param  str       [in]  The string to search.
+    *   \param  strLength [in]  The length in T's of the string, not including the null terminator.
+    *   \return                 A pointer to the last occurance of the pattern; or NULL if it is not found.
+    *
+    *   \remarks
+    *       The search stops at the first null character, even when the length is given.
+    */
+    const T * find_last(const T *str, size_t strLength = -1) const
+    {
+        assert(str != NULL);
+
+        return find_last(str, str + ((strLength == (size_t)-1) ? easl::length(str) : easl::length(str, strLength)));
+    }
+
+
+    /// Retrieves the pattern.
+    const T * pattern() const { return m_pattern; }
+
+    /// Retrieves the length in T's of the pattern, not including the null terminator.
+    size_t length() const { return m_length; }
+
+
+private:
+
+    /// Retrieves the slot in the shift table for a code unit.
+    static size_t _slot(T unit)
+    {
+        return static_cast<size_t>(static_cast<uchar32_t>(unit) & 0xFF);
+    }
+
+    /**
+    *   \brief  Computes the critical factorization and the period of the pattern.
+    *
+    *   \remarks
+    *       The critical position is the later of the maximal suffixes for the two orderings of
+    *       the code units. When the left half of the pattern repeats with the period, Two-Way
+    *       remembers how much of the pattern is already known to match after each shift.
+    */
+    void _factorize()
+    {
+        size_t critical1, period1;
+        size_t critical2, period2;
+        _maximal_suffix(false, critical1, period1);
+        _maximal_suffix(true,  critical2, period2);
+
+        // The critical positions are one before the start of the suffix, so -1 is the smallest.
+        if (critical2 + 1 > critical1 + 1)
+        {
+            m_critical = critical2;
+            m_period   = period2;
+        }
+        else
+        {
+            m_critical = critical1;
+            m_period   = period1;
+        }
+
+        if (::memcmp(m_pattern, m_pattern + m_period, (m_critical + 1) * sizeof(T)) != 0)
+        {
+            // Not periodic. Every mismatch in the left half can skip past the larger half.
+            m_memory = 0;
+            m_period = ((m_critical > m_length - m_critical - 1) ? m_critical : m_length - m_critical - 1) + 1;
+        }
+        else
+        {
+            m_memory = m_length - m_period;
+        }
+    }
+
+    /**
+    *   \brief                  Finds the maximal suffix of the pattern.
+    *   \param  reverse  [in]   Whether or not the code units are ordered in reverse.
+    *   \param  critical [out]  Receives the position just before the start of the suffix. This can be -1.
+    *   \param  period   [out]  Receives the period of the suffix.
+    */
+    void _maximal_suffix(bool reverse, size_t &critical, size_t &period) const
+    {
+        size_t i = (size_t)-1;
+        size_t j = 0;
+        size_t k = 1;
+        size_t p = 1;
+
+        while (j + k < m_length)
+        {
+            T a = m_pattern[i + k];
+            T b = m_pattern[j + k];
+
+            if (a == b)
+            {
+                if (k == p)
+                {
+                    j += p;
+                    k = 1;
+                }
+                else
+                {
+                    ++k;
+                }
+            }
+            else if (reverse ? (a < b) : (a > b))
+            {
+                j += k;
+                k = 1;
+                p = j - i;
+            }
+            else
+            {
+                i = j++;
+                k = p = 1;
+            }
+        }
+
+        critical = i;
+        period   = p;
+    }
+
+    /**
+    *   \brief               Finds the pattern with the Two-Way algorithm.
+    *   \param  str     [in] Pointer to the start of the string to search.
+    *   \param  strEnd  [in] Pointer to the end of the string to search.
+    *   \return              A pointer to the first occurance of the pattern; or NULL if it is not found.
+    */
+    const T * _find_twoway(const T *str, const T *strEnd) const
+    {
+        // The number of T's at the start of the window that are known to match.
+        size_t memory = 0;
+
+        while (static_cast<size_t>(strEnd - str) >= m_length)
+        {
+            // Check the last code unit of the window first, since that skips the most.
+            size_t shift = m_length - m_shift[_slot(str[m_length - 1])];
+            if (shift != 0)
+            {
+                str += (shift < memory) ? memory : shift;
+                memory = 0;
+                continue;
+            }
+
+            // Compare the right half.
+            size_t i = (m_critical + 1 > memory) ? m_critical + 1 : memory;
+            while (i < m_length && m_pattern[i] == str[i])
+            {
+                ++i;
+            }
+
+            if (i < m_length)
+            {
+                str += i - m_critical;
+                memory = 0;
+                continue;
+            }
+
+            // Compare the left half.
+            i = m_critical + 1;
+            while (i > memory && m_pattern[i - 1] == str[i - 1])
+            {
+                --i;
+            }
+
+            if (i <= memory)
+            {
+                return str;
+            }
+
+            str += m_period;
+            memory = m_memory;
+        }
+
+        return NULL;
+    }
+
+#if defined(EASL_SIMD_SSE2)
+    /**
+    *   \brief               Finds the pattern by filtering candidates on its first and last code units.
+    *   \param  str     [in] Pointer to the start of the string to search.
+    *   \param  strEnd  [in] Pointer to the end of the string to search.
+    *   \return              A pointer to the first occurance of the pattern; or NULL if it is not found.
+    *
+    *   \remarks
+    *       Each candidate is checked with memcmp(). The number of T's that may be compared is
+    *       limited to a constant plus twice the number of positions that have been filtered, and
+    *       once that is used up the rest of the string is left to Two-Way.
+    */
+    const T * _find_filtered(const T *str, const T *strEnd) const
+    {
+        const size_t  width    = sizeof(T);
+        const size_t  block    = 16 / width;
+        const unsigned int lanes = (width == 1) ? 0xFFFF : (width == 2) ? 0x5555 : 0x1111;
+
+        const __m128i first = _searcher_broadcast(static_cast<uchar32_t>(m_pattern[0]), width);
+        const __m128i last  = _searcher_broadcast(static_cast<uchar32_t>(m_pattern[m_length - 1]), width);
+
+        size_t budget = 256;
+
+        while (static_cast<size_t>(strEnd - str) >= m_length + block - 1)
+        {
+            __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str));
+            __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(str + m_length - 1));
+
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(
+                _searcher_cmpeq(head, first, width), _searcher_cmpeq(tail, last, width)))) & lanes;
+
+            while (mask != 0)
+            {
+                const T *candidate = str + _bitscan_forward(mask) / width;
+                if (m_length <= 2 || ::memcmp(candidate + 1, m_pattern + 1, (m_length - 2) * sizeof(T)) == 0)
+                {
+                    return candidate;
+                }
+
+                // Everything before the next candidate has already been ruled out.
+                if (budget < m_length)
+                {
+                    return _find_twoway(candidate + 1, strEnd);
+                }
+
+                budget -= m_length;
+                mask &= mask - 1;
+            }
+
+            str    += block;
+            budget += block * 2;
+        }
+
+        return _find_twoway(str, strEnd);
+    }
+
+    /**
+    *   \brief               Finds the last occurance of the pattern by filtering candidates from the end of the string.
+    *   \param  str     [in] Pointer to the start of the string to search.
+    *   \param  strEnd  [in] Pointer to the end of the string to search.
+    *   \return              A pointer to the last occurance of the pattern; or NULL if it is not found.
+    *
+    *   \remarks
+    *       This is _find_filtered() run backwards, with the same limit on the number of T's that may be
+    *       compared. Once that is used up, the part of the string that hasn't been ruled out is left
+    *       to _find_last_forward().
+    */
+    const T * _find_last_filtered(const T *str, const T *strEnd) const
+    {
+        const size_t  width    = sizeof(T);
+        const size_t  block    = 16 / width;
+        const unsigned int lanes = (width == 1) ? 0xFFFF : (width == 2) ? 0x5555 : 0x1111;
+
+        const __m128i first = _searcher_broadcast(static_cast<uchar32_t>(m_pattern[0]), width);
+        const __m128i last  = _searcher_broadcast(static_cast<uchar32_t>(m_pattern[m_length - 1]), width);
+
+        size_t budget = 256;
+
+        while (static_cast<size_t>(strEnd - str) >= m_length + block - 1)
+        {
+            const T *starts = strEnd - m_length - block + 1;
+
+            __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(starts));
+            __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(starts + m_length - 1));
+
+            unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(
+                _searcher_cmpeq(head, first, width), _searcher_cmpeq(tail, last, width)))) & lanes;
+
+            while (mask != 0)
+            {
+                unsigned int bit = _bitscan_reverse(mask);
+
+                const T *candidate = starts + bit / width;
+                if (::memcmp(candidate + 1, m_pattern + 1, (m_length - 2) * sizeof(T)) == 0)
+                {
+                    return candidate;
+                }
+
+                // Everything after the candidate has already been ruled out.
+                if (budget < m_length)
+                {
+                    return _find_last_forward(str, candidate + m_length - 1);
+                }
+
+                budget -= m_length;
+                mask ^= 1U << bit;
+            }
+
+            strEnd -= block;
+            budget += block * 2;
+        }
+
+        return _find_last_forward(str, strEnd);
+    }
+#endif
+
+    /**
+    *   \brief               Finds the last occurance of the pattern by finding each occurance from the start.
+    *   \param  str     [in] Pointer to the start of the string to search.
+    *   \param  strEnd  [in] Pointer to the end of the string to search.
+    *   \return              A pointer to the last occurance of the pattern; or NULL if it is not found.
+    *
+    *   \remarks
+    *       Two-Way doesn't slow down on near misses the way the filter does, so this is used once going
+    *       backwards keeps running into candidates that don't match.
+    */
+    const T * _find_last_forward(const T *str, const T *strEnd) const
+    {
+        const T *result = NULL;
+
+        const T *found;
+        while ((found = find(str, strEnd)) != NULL)
+        {
+            result = found;
+            str    = found + 1;
+        }
+
+        return result;
+    }
+
+
+    /// The pattern.
+    const T *m_pattern;
+
+    /// The length in T's of the pattern.
+    size_t m_length;
+
+    /// The position just before the right half of the pattern. This can be -1.
+    size_t m_critical;
+
+    /// How far the window moves when the right half matches but the left half doesn't.
+    size_t m_period;
+
+    /// The number of T's that are known to match after moving the window by the period.
+    size_t m_memory;
+
+    /// The shift table, indexed by the low byte of a code unit. 0 means that no code unit in the pattern uses the slot.
+    size_t m_shift[256];
+};
+
+
+}
+
+#endif // __EASL_SEARCHER_H_
@@ -25,6 +25,13 @@
 #define COMPILER_VC71		0x10000004
 #define COMPILER_VC80		0x10000008
 #define COMPILER_VC90		0x10000010
+#define COMPILER_VC100		0x10000020
+#define COMPILER_VC110		0x10000040
+#define COMPILER_VC120		0x10000080
+#define COMPILER_VC140		0x10000100
+#define COMPILER_VC141		0x10000200
+#define COMPILER_VC142		0x10000400
+#define COMPILER_VC143		0x10000800
 
 // GCC
 #define COMPILER_GCC		0x20000000
@@ -34,6 +41,25 @@
 #define COMPILER_GCC41		0x20000008
 #define COMPILER_GCC42		0x20000010
 #define COMPILER_GCC43		0x20000020
+#define COMPILER_GCC44		0x20000040
+#define COMPILER_GCC45		0x20000080
+#define COMPILER_GCC46		0x20000100
+#define COMPILER_GCC47		0x20000200
+#define COMPILER_GCC48		0x20000400
+#define COMPILER_GCC49		0x20000800
+#define COMPILER_GCC5		0x20001000
+#define COMPILER_GCC6		0x20002000
+#define COMPILER_GCC7		0x20004000
+#define COMPILER_GCC8		0x20008000
+#define COMPILER_GCC9		0x20010000
+#define COMPILER_GCC10		0x20020000
+#define COMPILER_GCC11		0x20040000
+#define COMPILER_GCC12		0x20080000
+#define COMPILER_GCC13		0x20100000
+#define COMPILER_GCC14		0x20200000
+
+// Clang. It also defines __GNUC__, but always claims to be GCC 4.2.
+#define COMPILER_CLANG		0x40000000
 
 
 // Setup our compiler.
@@ -69,18 +95,55 @@
 #define COMPILER COMPILER_VC90
 #endif
 
+#if (_MSC_VER == 1600)
+#define COMPILER COMPILER_VC100
+#endif
+
+#if (_MSC_VER == 1700)
+#define COMPILER COMPILER_VC110
+#endif
+
+#if (_MSC_VER == 1800)
+#define COMPILER COMPILER_VC120
+#endif
+
+#if (_MSC_VER == 1900)
+#define COMPILER COMPILER_VC140
+#endif
+
+#if (_MSC_VER >= 1910) && (_MSC_VER < 1920)
+#define COMPILER COMPILER_VC141
+#endif
+
+#if (_MSC_VER >= 1920) && (_MSC_VER < 1930)
+#define COMPILER COMPILER_VC142
+#endif
+
+#if (_MSC_VER >= 1930) && (_MSC_VER < 2000)
+#define COMPILER COMPILER_VC143
+#endif
+
+// Anything newer than we know about.
+#ifndef COMPILER
+#define COMPILER COMPILER_VC
+#endif
+
 #endif	// _MSC_VER
 
 // GCC
 #ifdef __GNUC__
 
 // Our architecture
-#if(defined(__WORDSIZE) && (__WORDSIZE == 64))
+#if(defined(__WORDSIZE) && (__WORDSIZE == 64)) || defined(__LP64__) || defined(_WIN64)
 #define TARGET_BITS			BITS64
 #else
 #define TARGET_BITS			BITS32
 #endif
 
+#if defined(__clang__)
+#define COMPILER			COMPILER_CLANG
+#else
+
 #if (__GNUC__ == 3) && (__GNUC_MINOR__ == 4)
 #define COMPILER			COMPILER_GCC34
 #endif
@@ -105,6 +168,78 @@
 #define COMPILER			COMPILER_GCC43
 #endif
 
+#if (__GNUC__ == 4) && (__GNUC_MINOR__ == 4)
+#define COMPILER			COMPILER_GCC44
+#endif
+
+#if (__GNUC__ == 4) && (__GNUC_MINOR__ == 5)
+#define COMPILER			COMPILER_GCC45
+#endif
+
+#if (__GNUC__ == 4) && (__GNUC_MINOR__ == 6)
+#define COMPILER			COMPILER_GCC46
+#endif
+
+#if (__GNUC__ == 4) && (__GNUC_MINOR__ == 7)
+#define COMPILER			COMPILER_GCC47
+#endif
+
+#if (__GNUC__ == 4) && (__GNUC_MINOR__ == 8)
+#define COMPILER			COMPILER_GCC48
+#endif
+
+#if (__GNUC__ == 4) && (__GNUC_MINOR__ == 9)
+#define COMPILER			COMPILER_GCC49
+#endif
+
+// From GCC 5 onwards only the major version number matters.
+#if (__GNUC__ == 5)
+#define COMPILER			COMPILER_GCC5
+#endif
+
+#if (__GNUC__ == 6)
+#define COMPILER			COMPILER_GCC6
+#endif
+
+#if (__GNUC__ == 7)
+#define COMPILER			COMPILER_GCC7
+#endif
+
+#if (__GNUC__ == 8)
+#define COMPILER			COMPILER_GCC8
+#endif
+
+#if (__GNUC__ == 9)
+#define COMPILER			COMPILER_GCC9
+#endif
+
+#if (__GNUC__ == 10)
+#define COMPILER			COMPILER_GCC10
+#endif
+
+#if (__GNUC__ == 11)
+#define COMPILER			COMPILER_GCC11
+#endif
+
+#if (__GNUC__ == 12)
+#define COMPILER			COMPILER_GCC12
+#endif
+
+#if (__GNUC__ == 13)
+#define COMPILER			COMPILER_GCC13
+#endif
+
+#if (__GNUC__ == 14)
+#define COMPILER			COMPILER_GCC14
+#endif
+
+// Anything newer than we know about.
+#ifndef COMPILER
+#define COMPILER			COMPILER_GCC
+#endif
+
+#endif	// __clang__
+
 #endif	// __GNUC__
 #endif	// COMPILER
 
@@ -123,4 +258,119 @@
 #endif	// PLATFORM
 
 
+// C++0x features. Visual C doesn't update __cplusplus, so it is checked separately.
+#if (defined(__cplusplus) && __cplusplus >= 201103L) || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#define EASL_HAS_RVALUE_REFERENCES
+#endif
+
+#if (defined(__cplusplus) && __cplusplus >= 201103L) || (defined(_MSC_VER) && _MSC_VER >= 1900)
+#define EASL_HAS_CHAR16_T
+#endif
+
+// Relaxed constexpr (C++14) lets loops run at compile time, which is what easl::literal needs to
+// transcode string literals while compiling. Without it, the same code runs at runtime instead.
+#if (defined(__cplusplus) && __cplusplus >= 201402L) || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L)
+#define EASL_HAS_RELAXED_CONSTEXPR
+#define EASL_CONSTEXPR      constexpr
+#else
+#define EASL_CONSTEXPR
+#endif
+
+// Thread local storage. The compiler specific versions only work with POD types, which is
+// all we use it for.
+#if (defined(__cplusplus) && __cplusplus >= 201103L)
+#define EASL_THREAD_LOCAL   thread_local
+#elif defined(_MSC_VER)
+#define EASL_THREAD_LOCAL   __declspec(thread)
+#elif defined(__GNUC__)
+#define EASL_THREAD_LOCAL   __thread
+#endif
+
+// std::thread, which the parallel_*() functions use to spread very large strings over several
+// cores. Without it they fall back to the single threaded functions. Define EASL_OPTION_NO_THREADS
+// to never start any threads.
+#if !defined(EASL_OPTION_NO_THREADS)
+#if (defined(__cplusplus) && __cplusplus >= 201103L) || (defined(_MSC_VER) && _MSC_VER >= 1700)
+#define EASL_HAS_THREADS
+#endif
+#endif
+
+
+// Find the instruction set extensions we can use for the vectorised code paths. These
+// are the extensions that the compiler has been told it may use, so they are safe to use
+// anywhere in the program. Define EASL_OPTION_NO_SIMD to force the scalar code paths.
+#ifndef EASL_OPTION_NO_SIMD
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EASL_SIMD_SSE2
+#endif
+
+// Visual C doesn't have a switch for SSSE3 on it's own. It's implied by /arch:AVX.
+#if defined(__SSSE3__) || (defined(_MSC_VER) && defined(__AVX__))
+#define EASL_SIMD_SSSE3
+#endif
+
+#if defined(__AVX2__)
+#define EASL_SIMD_AVX2
+#endif
+
+#if defined(__SSE4_2__) || (defined(_MSC_VER) && defined(__AVX__))
+#define EASL_SIMD_SSE42
+#endif
+
+#if defined(__AVX512BW__)
+#define EASL_SIMD_AVX512BW
+#endif
+
+#endif	// EASL_OPTION_NO_SIMD
+
+
+// Runtime instruction set dispatch. A program that is built for plain x86-64 can still use the
+// SSSE3, SSE4.2, AVX2 and AVX-512BW kernels when the CPU it runs on supports them. Those kernels
+// are compiled with a per-function target (EASL_TARGET) and are picked once the CPU has been
+// checked with cpu_features(). Instruction sets that the compiler has been told it may use
+// anywhere are never checked at runtime. Define EASL_OPTION_NO_DISPATCH to only use the
+// instruction sets that are enabled at compile time.
+#if !defined(EASL_OPTION_NO_SIMD) && !defined(EASL_OPTION_NO_DISPATCH) && (defined(__x86_64__) || defined(_M_X64))
+#if defined(__clang__)
+#if (__clang_major__ > 3) || (__clang_major__ == 3 && __clang_minor__ >= 8)
+#define EASL_SIMD_DISPATCH
+#endif
+#elif defined(__GNUC__)
+#if (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#define EASL_SIMD_DISPATCH
+#endif
+#elif defined(_MSC_VER)
+#if (_MSC_VER >= 1800)
+#define EASL_SIMD_DISPATCH
+#endif
+#endif
+#endif
+
+// Visual C lets any function use any intrinsic, so it doesn't need a target.
+#if defined(EASL_SIMD_DISPATCH) && defined(__GNUC__)
+#define EASL_TARGET(isa)    __attribute__((target(isa)))
+#else
+#define EASL_TARGET(isa)
+#endif
+
+// The kernels that can be used, either because the instruction set is always available or
+// because the CPU can be checked for it at runtime.
+#if defined(EASL_SIMD_SSSE3) || defined(EASL_SIMD_DISPATCH)
+#define EASL_KERNEL_SSSE3
+#endif
+
+#if defined(EASL_SIMD_SSE42) || defined(EASL_SIMD_DISPATCH)
+#define EASL_KERNEL_SSE42
+#endif
+
+#if defined(EASL_SIMD_AVX2) || defined(EASL_SIMD_DISPATCH)
+#define EASL_KERNEL_AVX2
+#endif
+
+#if defined(EASL_SIMD_AVX512BW) || defined(EASL_SIMD_DISPATCH)
+#define EASL_KERNEL_AVX512BW
+#endif
+
+
 #endif // __EASL_SETUP_H_
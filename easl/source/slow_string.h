@@ -5,28 +5,38 @@
 *
 *   The slow string implementation is essentially a wrapper around a C-style string.
 *   It contains only a single property - a pointer to the content of the string. This
-*   implementation is designed to keep memory consumption to a minumum.
+*   implementation is designed to keep memory consumption to a minumum. The destructor is
+*   virtual by default, which adds a vtable pointer to each object. Define
+*   EASL_OPTION_NON_VIRTUAL_STRING to remove it, in which case a slow_string is exactly the
+*   size of a pointer. Classes should not derive from the string classes in that case.
 *
 *   Internally the class uses easl::length(), so encoding '\0' anywhere in the string other
 *   than the end will cause the string to become corrupted as soon as it is modified.
 *   If the string remains static, however, a NULL character can be encoded by modifying
 *   the pointer directly from outside the class. This problem only affects slow_string.
 *   fast_string is not affected by this problem.
+*
+*   By default every append reallocates the string. If EASL_OPTION_SLOW_STRING_CAPACITY is
+*   defined, the capacity of the buffer is stored in a hidden header just before the string
+*   and the capacity grows geometrically, so building a string from many pieces takes linear
+*   time. The size of the object itself stays the same either way.
 */
 #ifndef __EASL_SLOW_STRING_H_
 #define __EASL_SLOW_STRING_H_
 
+#include <string.h>
 #include "length.h"
 #include "copysize.h"
 #include "getchar.h"
 #include "equal.h"
 #include "tostring.h"
+#include "allocator.h"
 
 namespace easl
 {
 
-template <typename T>
-class slow_string
+template <typename T, typename Allocator = heap_allocator>
+class slow_string : private Allocator
 {
 public:
 
@@ -42,6 +52,25 @@ public:
         this->assign((const T *)NULL);
     }
 
+    /**
+    *   \brief                 Constructor.
+    *   \param  allocator [in] The allocator to use for the string's memory.
+    */
+    explicit slow_string(const Allocator &allocator) : Allocator(allocator), data(NULL)
+    {
+        this->assign((const T *)NULL);
+    }
+
+    /**
+    *   \brief                 Constructor.
+    *   \param  str       [in] The string to initialise this string to.
+    *   \param  allocator [in] The allocator to use for the string's memory.
+    */
+    slow_string(const T *str, const Allocator &allocator) : Allocator(allocator), data(NULL)
+    {
+        this->assign(str);
+    }
+
     /**
     *   \brief           Constructor.
     *   \param  str [in] The string to initialise this string to.
@@ -74,26 +103,45 @@ public:
     *   \brief           Constructor.
     *   \param  str [in] The string to initialise this string to.
     */
-    slow_string(const slow_string<T> &str) : data(NULL)
+    slow_string(const slow_string<T, Allocator> &str) : Allocator(str), data(NULL)
     {
         this->assign(str.c_str());
     }
 
 #ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
-    template <typename U>
-    slow_string(const slow_string<U> &str) : data(NULL)
+    template <typename U, typename V>
+    slow_string(const slow_string<U, V> &str) : data(NULL)
     {
         this->assign(str.c_str());
     }
 #endif
 
+#ifdef EASL_HAS_RVALUE_REFERENCES
+    /**
+    *   \brief           Move constructor.
+    *   \param  str [in] The string to take the contents of.
+    *
+    *   \remarks
+    *       No memory is allocated. \c str is left without a buffer, so c_str() will return NULL
+    *       until something is assigned to it. It is otherwise treated as an empty string.
+    */
+    slow_string(slow_string<T, Allocator> &&str) : Allocator(str), data(str.data)
+    {
+        str.data = NULL;
+    }
+#endif
+
 
     /**
     *   \brief  Destructor.
     */
+#ifdef EASL_OPTION_NON_VIRTUAL_STRING
+    ~slow_string()
+#else
     virtual ~slow_string()
+#endif
     {
-        delete [] this->data;
+        _free(this->data);
     }
 
 
@@ -121,6 +169,10 @@ public:
     *       \par
     *       Because a reference is being returned, a pointer to the pointer can be retrieved with
     *       the address-of operator.
+    *       \par
+    *       If EASL_OPTION_SLOW_STRING_CAPACITY is defined, the pointer itself must not be replaced
+    *       because the capacity is stored in front of the buffer. Use reserve() to make room and
+    *       then write to the buffer instead.
     */
     T *& c_str()
     {
@@ -137,20 +189,17 @@ public:
     *       If the length of the input string is known, set \c len to the length of the string.
     *       This will prevent this string from manually retrieving the length of the string.
     */
-    slow_string<T> & assign(const T *str, size_t strLength = -1)
+    slow_string<T, Allocator> & assign(const T *str, size_t strLength = -1)
     {
         if (this->data == (const T *)str && this->data != NULL)
         {
             return *this;
         }
 
-        // No matter what happens, the data must be deallocated. Therefore, we will do it first.
-        delete [] data;
-
         // If the input string is NULL, we will set this string to an empty string.
         if (str == NULL)
         {
-            this->data = new T[1];
+            this->_replace(0);
             this->data[0] = '\0';
         }
         else
@@ -160,9 +209,16 @@ public:
                 strLength = easl::length(str);
             }
 
-            // Now we just need to copy the string over.
-            this->data = new T[strLength + 1];
-            easl::copy(this->data, str, strLength + 1, strLength);
+            // The input string may be a part of this string, so the old buffer is only freed
+            // after the string has been copied over.
+            T *old_data = this->_replace(strLength);
+            ::memmove(this->data, str, strLength * sizeof(T));
+            this->data[strLength] = '\0';
+
+            if (old_data != this->data)
+            {
+                _free(old_data);
+            }
         }
 
         return *this;
@@ -170,32 +226,33 @@ public:
 
 #ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
     template <typename U>
-    slow_string<T> & assign(const U *str, size_t strLength = (size_t)-1)
+    slow_string<T, Allocator> & assign(const U *str, size_t strLength = (size_t)-1)
     {
         if (this->data == (const T *)str && this->data != NULL)
         {
             return *this;
         }
 
-        // No matter what happens, the data must be deallocated. Therefore, we will do it first.
-        delete [] data;
-
         // If the input string is NULL, we will set this string to an empty string.
         if (str == NULL)
         {
-            this->data = new T[1];
-            this->data[0] = NULL;
+            this->_replace(0);
+            this->data[0] = '\0';
         }
         else
         {
-            if (strLength == (size_t)-1)
+            // All we're really doing is a simple conversion. Both of these go through the block
+            // transcoders. Note that strLength is the length of the input string in U's, whereas
+            // copy_size is the size of our buffer in T's.
+            size_t copy_size = easl::copysize<T>(str, strLength);
+
+            T *old_data = this->_replace(copy_size - 1);
+            if (old_data != this->data)
             {
-                strLength = easl::copysize<T>(str);
+                _free(old_data);
             }
 
-            // All we're really doing is a simple conversion.
-            this->data = new T[strLength];
-            easl::copy(this->data, str, strLength);
+            easl::copy(this->data, str, copy_size, strLength);
         }
 
         return *this;
@@ -213,7 +270,7 @@ public:
     *       The \c len parameter should specify the number of T's in \c str and not
     *       the number of characters.
     */
-    slow_string<T> & append(const T *str, size_t strLength = -1)
+    slow_string<T, Allocator> & append(const T *str, size_t strLength = -1)
     {
         if (str != NULL)
         {
@@ -227,20 +284,18 @@ public:
             // Now we need to find the length of this string.
             size_t this_size = this->length();
 
-            // Now grab our current pointer so we can copy it into our new memory space later.
-            T *old_data = this->data;
-
-            // Now we can allocate some more memory.
-            this->data = new T[this_size + strLength + 1];
+            // Make sure we have enough room. The old buffer is kept around until we're done in
+            // case the input string is a part of this string.
+            T *old_data = this->_grow(this_size, this_size + strLength);
 
-            // Copy our old data back into the string.
-            easl::copy(this->data, old_data, this_size + strLength + 1);
-
-            // Now we copy our input string into our new buffer.
-            easl::copy(this->data + this_size, str, strLength + 1);
+            // Now we copy our input string into our buffer.
+            easl::copy(this->data + this_size, str, strLength + 1, strLength);
 
             // Delete our previous data.
-            delete [] old_data;
+            if (old_data != this->data)
+            {
+                _free(old_data);
+            }
         }
 
         return *this;
@@ -248,33 +303,26 @@ public:
 
 #ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
     template <typename U>
-    slow_string<T> & append(const U *str, size_t strLength = -1)
+    slow_string<T, Allocator> & append(const U *str, size_t strLength = -1)
     {
-        (void)strLength;  // Warning silencer.
-
         if (str != NULL)
         {
             // First we need to determine how much extra space we need to allocate to append
             // the new string.
-            size_t copy_size = easl::copysize<T>(str);
+            size_t copy_size = easl::copysize<T>(str, strLength);
 
             // Now we need to find the length of this string.
             size_t this_size = this->length();
 
-            // Now grab our current pointer so we can copy it into our new memory space later.
-            T *old_data = this->data;
-
-            // Now we can allocate some more memory.
-            this->data = new T[this_size + copy_size];
-
-            // Copy our old data back into the string.
-            memcpy(this->data, old_data, sizeof(T) * this_size);
-
-            // Now we copy our input string into our new buffer.
-            easl::copy(this->data + this_size, str, copy_size);
+            // Make sure we have enough room.
+            T *old_data = this->_grow(this_size, this_size + copy_size - 1);
+            if (old_data != this->data)
+            {
+                _free(old_data);
+            }
 
-            // Delete our previous data.
-            delete [] old_data;
+            // Now we copy our input string into our buffer.
+            easl::copy(this->data + this_size, str, copy_size, strLength);
         }
 
         return *this;
@@ -286,22 +334,21 @@ public:
     *   \param  character [in]  The character to append.
     *   \return                 A reference to this string.
     */
-    slow_string<T> & append(uchar32_t character)
+    slow_string<T, Allocator> & append(uchar32_t character)
     {
-        // First we need to determine how many T's to increase the buffer by.
-        size_t added_size = easl::charwidth<T>(character);
+        // First we need to determine how many T's to increase the buffer by. writechar() will
+        // tell us when we don't give it a buffer, taking into account the replacement character.
+        size_t added_size = easl::writechar((T *)NULL, character);
 
         // We also need the length of this string.
         size_t this_size = this->length();
 
-        // Now grab our current pointer so we can copy it into our new memory space later.
-        T *old_data = this->data;
-
-        // Now we can allocate some more memory.
-        this->data = new T[this_size + added_size + 1];
-
-        // Copy our old data back into the string.
-        easl::copy(this->data, old_data, this_size + added_size + 1);
+        // Make sure we have enough room.
+        T *old_data = this->_grow(this_size, this_size + added_size);
+        if (old_data != this->data)
+        {
+            _free(old_data);
+        }
 
         // Now we need to write this character to the string.
         easl::writechar(this->data + this_size, character);
@@ -309,9 +356,6 @@ public:
         // Null terminate the string.
         this->data[this_size + added_size] = 0;
 
-        // Delete our previous data.
-        delete [] old_data;
-
         return *this;
     }
 
@@ -325,9 +369,94 @@ public:
     */
     size_t length() const
     {
+        if (this->data == NULL)
+        {
+            return 0;
+        }
+
         return easl::length(this->data);
     }
 
+    /**
+    *   \brief  Retrieves the number of T's the string can hold without reallocating.
+    *   \return The capacity of the string in T's, not including the null terminator.
+    *
+    *   \remarks
+    *       If EASL_OPTION_SLOW_STRING_CAPACITY is not defined, the capacity is not stored and
+    *       this is the same as length().
+    */
+    size_t capacity() const
+    {
+        return this->_capacity(this->length());
+    }
+
+    /**
+    *   \brief                   Makes sure the string can hold a number of T's without reallocating.
+    *   \param  newCapacity [in] The number of T's to reserve room for, not including the null terminator.
+    *
+    *   \remarks
+    *       This will never shrink the string. After calling this function, up to \c newCapacity
+    *       T's plus the null terminator can be written directly into the buffer returned by c_str().
+    *       \par
+    *       If EASL_OPTION_SLOW_STRING_CAPACITY is not defined, the next change to the string will
+    *       reallocate it again anyway.
+    */
+    void reserve(size_t newCapacity)
+    {
+        size_t this_size = this->length();
+
+        if (newCapacity > this->_capacity(this_size))
+        {
+            this->_reallocate(this_size, newCapacity);
+        }
+    }
+
+    /**
+    *   \brief  Frees any memory that is not needed to store the string.
+    *
+    *   \remarks
+    *       This does nothing if EASL_OPTION_SLOW_STRING_CAPACITY is not defined.
+    */
+    void shrink_to_fit()
+    {
+#ifdef EASL_OPTION_SLOW_STRING_CAPACITY
+        size_t this_size = this->length();
+
+        if (this->_capacity(this_size) > this_size)
+        {
+            this->_reallocate(this_size, this_size);
+        }
+#endif
+    }
+
+
+    /**
+    *   \brief           Swaps the contents of this string with another string.
+    *   \param  str [in] The string to swap with.
+    *
+    *   \remarks
+    *       Only the pointers and the allocators are swapped. No memory is allocated and nothing
+    *       is copied.
+    */
+    void swap(slow_string<T, Allocator> &str)
+    {
+        T *temp    = this->data;
+        this->data = str.data;
+        str.data   = temp;
+
+        Allocator other_allocator(*this);
+        static_cast<Allocator &>(*this) = static_cast<Allocator &>(str);
+        static_cast<Allocator &>(str)   = other_allocator;
+    }
+
+    /**
+    *   \brief  Retrieves the allocator used for the string's memory.
+    */
+    const Allocator & get_allocator() const
+    {
+        return *this;
+    }
+
 
     /**
     *   \brief  Determines if the strings contains any characters.
@@ -370,35 +499,51 @@ public:
     *   \remarks
     *       The C-style string must be null terminated.
     */
-    slow_string<T> & operator =(const T *str)
+    slow_string<T, Allocator> & operator =(const T *str)
     {
         return this->assign(str);
     }
-    slow_string<T> & operator =(const slow_string<T> &str)
+    slow_string<T, Allocator> & operator =(const slow_string<T, Allocator> &str)
     {
         return this->assign(str.c_str());
     }
-    slow_string<T> & operator =(const reference_string<T> &str)
+    slow_string<T, Allocator> & operator =(const reference_string<T> &str)
     {
         return this->assign(str.start, easl::length(str));
     }
 
+#ifdef EASL_HAS_RVALUE_REFERENCES
+    /**
+    *   \brief           Move assignment operator.
+    *   \param  str [in] The string to take the contents of.
+    *   \return          A reference to this string.
+    *
+    *   \remarks
+    *       The two buffers are swapped, so \c str ends up with the old contents of this string.
+    */
+    slow_string<T, Allocator> & operator =(slow_string<T, Allocator> &&str)
+    {
+        this->swap(str);
+        return *this;
+    }
+#endif
+
 #ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
     template <typename U>
-    slow_string<T> & operator =(const U *str)
+    slow_string<T, Allocator> & operator =(const U *str)
     {
         return this->assign(str);
     }
 
     /// \copydoc    slow_string::operator =(const T *)
-    template <typename U>
-    slow_string<T> & operator =(const slow_string<U> &str)
+    template <typename U, typename V>
+    slow_string<T, Allocator> & operator =(const slow_string<U, V> &str)
     {
         return this->assign(str.c_str());
     }
 
     template <typename U>
-    slow_string<T> & operator =(const reference_string<U> &str)
+    slow_string<T, Allocator> & operator =(const reference_string<U> &str)
     {
         return this->assign(str.start, easl::length(str));
     }
@@ -417,7 +562,7 @@ public:
     {
         return easl::equal(this->data, str);
     }
-    bool operator ==(const slow_string<T> &str) const
+    bool operator ==(const slow_string<T, Allocator> &str) const
     {
         return easl::equal(this->data, str.c_str());
     }
@@ -425,6 +570,11 @@ public:
     {
         return easl::equal(this->data, str);
     }
+    template <typename U, size_t N>
+    bool operator ==(const literal<U, N> &lit) const
+    {
+        return easl::equal(this->data, lit);
+    }
 
 #ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
     template <typename U>
@@ -434,8 +584,8 @@ public:
     }
 
     /// \copydoc    slow_string::operator ==(const U *) const
-    template <typename U>
-    bool operator ==(const slow_string<U> &str) const
+    template <typename U, typename V>
+    bool operator ==(const slow_string<U, V> &str) const
     {
         return easl::equal(this->data, str.c_str());
     }
@@ -459,7 +609,7 @@ public:
     {
         return !easl::equal(this->data, str);
     }
-    bool operator !=(const slow_string<T> &str) const
+    bool operator !=(const slow_string<T, Allocator> &str) const
     {
         return !easl::equal(this->data, str.c_str());
     }
@@ -467,6 +617,11 @@ public:
     {
         return !easl::equal(this->data, str);
     }
+    template <typename U, size_t N>
+    bool operator !=(const literal<U, N> &lit) const
+    {
+        return !easl::equal(this->data, lit);
+    }
 
 #ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
     template <typename U>
@@ -476,8 +631,8 @@ public:
     }
 
     /// \copydoc    slow_string::operator ==(const U *) const
-    template <typename U>
-    bool operator !=(const slow_string<U> &str) const
+    template <typename U, typename V>
+    bool operator !=(const slow_string<U, V> &str) const
     {
         return !easl::equal(this->data, str.c_str());
     }
@@ -498,35 +653,35 @@ public:
     *   \remarks
     *       The C-style string must be null terminated.
     */
-    slow_string<T> & operator +=(const T *str)
+    slow_string<T, Allocator> & operator +=(const T *str)
     {
         return this->append(str);
     }
-    slow_string<T> & operator +=(const slow_string<T> &str)
+    slow_string<T, Allocator> & operator +=(const slow_string<T, Allocator> &str)
     {
         return this->append(str.c_str());
     }
-    slow_string<T> & operator +=(const reference_string<T> &str)
+    slow_string<T, Allocator> & operator +=(const reference_string<T> &str)
     {
         return this->append(str.start, easl::length(str));
     }
 
 #ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
     template <typename U>
-    slow_string<T> & operator +=(const U *str)
+    slow_string<T, Allocator> & operator +=(const U *str)
     {
         return this->append(str);
     }
 
     /// \copydoc    slow_string::operator +=(const U *)
-    template <typename U>
-    slow_string<T> & operator +=(const slow_string<U> &str)
+    template <typename U, typename V>
+    slow_string<T, Allocator> & operator +=(const slow_string<U, V> &str)
     {
         return this->append(str.c_str());
     }
 
     template <typename U>
-    slow_string<T> & operator +=(const reference_string<U> &str)
+    slow_string<T, Allocator> & operator +=(const reference_string<U> &str)
     {
         return this->append(str.start, easl::length(str));
     }
@@ -537,7 +692,7 @@ public:
     *   \param  character [in] The character to append.
     *   \return                A reference to this string.
     */
-    slow_string<T> & operator +=(uchar32_t character)
+    slow_string<T, Allocator> & operator +=(uchar32_t character)
     {
         return this->append(character);
     }
@@ -551,42 +706,42 @@ public:
     *   \remarks
     *       The C-style string must be null terminated.
     */
-    slow_string<T> operator +(const T *str) const
+    slow_string<T, Allocator> operator +(const T *str) const
     {
-        slow_string<T> new_str(*this);
+        slow_string<T, Allocator> new_str(*this);
         return new_str += str;
     }
-    slow_string<T> operator +(const slow_string<T> &str) const
+    slow_string<T, Allocator> operator +(const slow_string<T, Allocator> &str) const
     {
-        slow_string<T> new_str(*this);
+        slow_string<T, Allocator> new_str(*this);
         return new_str += str;
     }
-    slow_string<T> operator +(const reference_string<T> &str) const
+    slow_string<T, Allocator> operator +(const reference_string<T> &str) const
     {
-        slow_string<T> new_str(*this);
+        slow_string<T, Allocator> new_str(*this);
         return new_str += str;
     }
 
 #ifndef EASL_OPTION_NO_GENERIC_OPERATIONS
     template <typename U>
-    slow_string<T> operator +(const U *str) const
+    slow_string<T, Allocator> operator +(const U *str) const
     {
-        slow_string<T> new_str(*this);
+        slow_string<T, Allocator> new_str(*this);
         return new_str += str;
     }
 
     /// \copydoc    slow_string::operator +(const U *)
-    template <typename U>
-    slow_string<T> operator +(const slow_string<U> &str) const
+    template <typename U, typename V>
+    slow_string<T, Allocator> operator +(const slow_string<U, V> &str) const
     {
-        slow_string<T> new_str(*this);
+        slow_string<T, Allocator> new_str(*this);
         return new_str += str;
     }
 
     template <typename U>
-    slow_string<T> operator +(const reference_string<U> &str) const
+    slow_string<T, Allocator> operator +(const reference_string<U> &str) const
     {
-        slow_string<T> new_str(*this);
+        slow_string<T, Allocator> new_str(*this);
         return new_str += str;
     }
 #endif
@@ -596,9 +751,9 @@ public:
     *   \param  character [in]  The character to be appended to the end of the new string.
     *   \return                 A new string equal to this string with the input character appeneded to the end.
     */
-    slow_string<T> operator +(uchar32_t character) const
+    slow_string<T, Allocator> operator +(uchar32_t character) const
     {
-        slow_string<T> new_str(*this);
+        slow_string<T, Allocator> new_str(*this);
         return new_str += character;
     }
 
@@ -616,7 +771,7 @@ public:
     *       This operator does not work reliably for individual characters. Use append() instead.
     */
     template <typename U>
-    slow_string<T> & operator << (const U &value)
+    slow_string<T, Allocator> & operator << (const U &value)
     {
         T temp[256];
         easl::tostring(value, temp);
@@ -624,19 +779,19 @@ public:
     }
 
     template <typename U>
-    slow_string<T> & operator << (U *value)
+    slow_string<T, Allocator> & operator << (U *value)
     {
         return this->append(value);
     }
 
-    template <typename U>
-    slow_string<T> & operator << (const slow_string<U> &value)
+    template <typename U, typename V>
+    slow_string<T, Allocator> & operator << (const slow_string<U, V> &value)
     {
         return this->append(value.c_str());
     }
 
     template <typename U>
-    slow_string<T> & operator << (const reference_string<U> &value)
+    slow_string<T, Allocator> & operator << (const reference_string<U> &value)
     {
         return this->append(value.start, easl::length(value));
     }
@@ -644,11 +799,168 @@ public:
 
 private:
 
+#ifdef EASL_OPTION_SLOW_STRING_CAPACITY
+    /**
+    *   \brief                Allocates a buffer with room for the given number of T's, plus the null terminator.
+    *   \param  capacity [in] The capacity of the new buffer.
+    *   \return               A pointer to the new buffer.
+    *
+    *   \remarks
+    *       The capacity is stored just before the string. Allocators return memory that is aligned
+    *       for a size_t, so the string will be properly aligned after the header.
+    */
+    T * _allocate(size_t capacity)
+    {
+        size_t *block = static_cast<size_t *>(this->allocate(sizeof(size_t) + (capacity + 1) * sizeof(T)));
+        block[0] = capacity;
+
+        return reinterpret_cast<T *>(block + 1);
+    }
+
+    /**
+    *   \brief            Frees a buffer that was allocated with _allocate().
+    *   \param  data [in] The buffer to free. Can be NULL.
+    */
+    void _free(T *data)
+    {
+        if (data != NULL)
+        {
+            this->deallocate(reinterpret_cast<size_t *>(data) - 1);
+        }
+    }
+
+    /**
+    *   \brief  Retrieves the capacity of the current buffer.
+    */
+    size_t _capacity(size_t) const
+    {
+        return (this->data != NULL) ? reinterpret_cast<const size_t *>(this->data)[-1] : 0;
+    }
+#else
+    T * _allocate(size_t capacity)
+    {
+        return static_cast<T *>(this->allocate((capacity + 1) * sizeof(T)));
+    }
+
+    void _free(T *data)
+    {
+        if (data != NULL)
+        {
+            this->deallocate(data);
+        }
+    }
+
+    // The capacity isn't stored, so all we know is that the current string fits.
+    size_t _capacity(size_t thisSize) const
+    {
+        return (this->data != NULL) ? thisSize : 0;
+    }
+#endif
+
+    /**
+    *   \brief                   Makes sure the buffer can hold a new string, without keeping the old one.
+    *   \param  newLength   [in] The length of the new string in T's.
+    *   \return                  The old buffer. If this is not the same as the new buffer, it must be freed with _free().
+    *
+    *   \remarks
+    *       The buffer is only replaced if the new string does not fit. Without
+    *       EASL_OPTION_SLOW_STRING_CAPACITY the capacity is unknown, so it is always replaced.
+    */
+    T * _replace(size_t newLength)
+    {
+        T *old_data = this->data;
+
+#ifdef EASL_OPTION_SLOW_STRING_CAPACITY
+        if (old_data != NULL && newLength <= this->_capacity(0))
+        {
+            return old_data;
+        }
+#endif
+
+        this->data = _allocate(newLength);
+        return old_data;
+    }
+
+    /**
+    *   \brief                  Makes sure the buffer can hold a longer string, keeping the current one.
+    *   \param  thisSize   [in] The length of the current string in T's.
+    *   \param  newLength  [in] The length of the string in T's that needs to fit.
+    *   \return                 The old buffer. If this is not the same as the new buffer, it must be freed with _free().
+    */
+    T * _grow(size_t thisSize, size_t newLength)
+    {
+        size_t capacity = this->_capacity(thisSize);
+        if (newLength <= capacity)
+        {
+            return this->data;
+        }
+
+#ifdef EASL_OPTION_SLOW_STRING_CAPACITY
+        // Growing geometrically means that each T is moved a constant number of times on average
+        // over a series of appends.
+        if (newLength < capacity * 2)
+        {
+            newLength = capacity * 2;
+        }
+#endif
+
+        T *old_data = this->data;
+
+        this->data = _allocate(newLength);
+        this->_copy_from(old_data, thisSize);
+
+        return old_data;
+    }
+
+    /**
+    *   \brief                 Copies the string from the old buffer into the current one.
+    *   \param  oldData   [in] The old buffer. This is NULL if the string has been moved from.
+    *   \param  thisSize  [in] The length of the string in the old buffer.
+    */
+    void _copy_from(const T *oldData, size_t thisSize)
+    {
+        if (oldData != NULL)
+        {
+            ::memcpy(this->data, oldData, (thisSize + 1) * sizeof(T));
+        }
+        else
+        {
+            this->data[0] = '\0';
+        }
+    }
+
+    /**
+    *   \brief                    Moves the string to a new buffer with the given capacity.
+    *   \param  thisSize    [in]  The length of the current string in T's.
+    *   \param  newCapacity [in]  The capacity of the new buffer. This must be at least \c thisSize.
+    */
+    void _reallocate(size_t thisSize, size_t newCapacity)
+    {
+        T *old_data = this->data;
+
+        this->data = _allocate(newCapacity);
+        this->_copy_from(old_data, thisSize);
+
+        _free(old_data);
+    }
+
+
     /// Pointer to the content of the string.
     T *data;
 
 };
 
+/**
+*   \brief          Swaps the contents of two strings.
+*   \param  a [in]  The first string.
+*   \param  b [in]  The second string.
+*/
+template <typename T, typename Allocator>
+inline void swap(slow_string<T, Allocator> &a, slow_string<T, Allocator> &b)
+{
+    a.swap(b);
+}
+
 }
 
 #endif // __EASL_SLOW_STRING_H_
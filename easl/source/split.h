@@ -8,6 +8,7 @@
 
 #include <vector>
 #include "findfirst.h"
+#include "searcher.h"
 #include "reference_string.h"
 
 namespace easl
@@ -28,6 +29,29 @@ namespace easl
 template <typename T>
 void split(T *str, const T *delimiter, std::vector<reference_string<T> > &list, bool includeDelimiter = true,
            size_t strLength = (size_t)-1, size_t delLength = (size_t)-1)
+{
+    split(str, delimiter, list, includeDelimiter, strLength, delLength, native_t());
+}
+
+/**
+*   \brief                         Splits a string and places each part in a list, decoding the string as described by an encoding tag.
+*   \param  str              [in]  The string to split.
+*   \param  delimiter        [in]  The string that is used to determine where the string should be split.
+*   \param  list             [out] A reference to the list that will recieve the different pieces.
+*   \param  includeDelimiter [in]  Determines if the delimiter should be included in the returned pieces.
+*   \param  strLength        [in]  The length in T's of the string, not including the null terminator.
+*   \param  delLength        [in]  The length in T's of the delimiter string, not including the null terminator.
+*   \param  encoding         [in]  The encoding tag of the string. See encoding.h.
+*
+*   \remarks
+*       The delimiter is matched T by T with a searcher, so the tag is only used to find the end of the last piece.
+*       With a strict tag, the last piece ends at the first invalid character.
+*       \par
+*       Empty strings are never added to the list.
+*/
+template <typename T, int Encoding, bool Strict>
+void split(T *str, const T *delimiter, std::vector<reference_string<T> > &list, bool includeDelimiter,
+           size_t strLength, size_t delLength, encoding_tag<Encoding, Strict> encoding)
 {
     assert(str != NULL);
 
@@ -39,10 +63,14 @@ void split(T *str, const T *delimiter, std::vector<reference_string<T> > &list,
         delLength = length(delimiter);
     }
 
-    T *temp = str;
+    // The delimiter is prepared once and searched for between two pointers, so the end of the
+    // string has to be known up front.
+    T *strEnd = str + length(str, strLength);
+    searcher<T> pattern(delimiter, delLength);
 
-    // Now we need to keep searching for our delimiter until we don't find any more.
-    while (strLength > 0 && (temp = findfirst(str, delimiter, strLength, delLength)) != NULL)
+    // An empty delimiter would be found everywhere without moving forward.
+    T *temp;
+    while (delLength > 0 && (temp = (T *)pattern.find(str, strEnd)) != NULL)
     {
         cur_string.start = str;
 
@@ -62,23 +90,23 @@ void split(T *str, const T *delimiter, std::vector<reference_string<T> > &list,
             list.push_back(cur_string);
         }
 
-        strLength -= (temp - str) + delLength;
-
         // We need to move past the delimiter that we just found.
         str = temp + delLength;
     }
 
     // We need to make sure that we have our very last part.
+    strLength = strEnd - str;
     if (strLength > 0)
     {
         cur_string.start = str;
         cur_string.end = str;
 
-        uchar32_t ch;
-        while (strLength > 0 && (ch = nextchar(cur_string.end)) != NULL)
+        T *prev_end = cur_string.end;
+        while (strLength > 0 && nextchar(cur_string.end, encoding) != '\0')
         {
-            strLength -= charwidth<T>(ch);
-        };
+            strLength -= cur_string.end - prev_end;
+            prev_end = cur_string.end;
+        }
 
         if (length(cur_string) > 0)
         {
@@ -87,6 +115,79 @@ void split(T *str, const T *delimiter, std::vector<reference_string<T> > &list,
     }
 }
 
+/**
+*   \brief  Implementation of split() for reference strings. T is given explicitly so that it can be const.
+*/
+template <typename T>
+void _split(const reference_string<T> &str, const T *delimiter, std::vector<reference_string<T> > &list, bool includeDelimiter, size_t delLength)
+{
+    assert(delimiter != NULL);
+
+    if (delLength == (size_t)-1)
+    {
+        delLength = length(delimiter);
+    }
+
+    reference_string<T> cur_string;
+    cur_string.start = str.start;
+
+    searcher<T> pattern(delimiter, delLength);
+
+    // An empty delimiter would be found everywhere without moving forward.
+    const T *temp;
+    while (delLength > 0 && (temp = pattern.find((const T *)cur_string.start, (const T *)str.end)) != NULL)
+    {
+        cur_string.end = (T *)temp;
+
+        if (includeDelimiter)
+        {
+            cur_string.end += delLength;
+        }
+
+        if (length(cur_string) > 0)
+        {
+            list.push_back(cur_string);
+        }
+
+        cur_string.start = (T *)temp + delLength;
+    }
+
+    // The last piece is everything after the last delimiter.
+    cur_string.end = str.end;
+    if (length(cur_string) > 0)
+    {
+        list.push_back(cur_string);
+    }
+}
+
+/**
+*   \brief                         Splits a reference string and places each part in a list.
+*   \param  str              [in]  The string to split.
+*   \param  delimiter        [in]  The string that is used to determine where the string should be split.
+*   \param  list             [out] A reference to the list that will recieve the different pieces.
+*   \param  includeDelimiter [in]  Determines if the delimiter should be included in the returned pieces.
+*   \param  delLength        [in]  The length in T's of the delimiter string, not including the null terminator.
+*
+*   \remarks
+*       The referenced string does not need to be null terminated. Nothing at or past the end of the
+*       string is read, so this can be used to split memory mapped files without copying them.
+*       \par
+*       Empty strings are never added to the list.
+*/
+template <typename T>
+void split(const reference_string<T> &str, const T *delimiter, std::vector<reference_string<T> > &list, bool includeDelimiter = true,
+           size_t delLength = (size_t)-1)
+{
+    _split<T>(str, delimiter, list, includeDelimiter, delLength);
+}
+
+template <typename T>
+void split(const reference_string<const T> &str, const T *delimiter, std::vector<reference_string<const T> > &list, bool includeDelimiter = true,
+           size_t delLength = (size_t)-1)
+{
+    _split<const T>(str, delimiter, list, includeDelimiter, delLength);
+}
+
 }
 
 #endif // __EASL_SPLIT_H_
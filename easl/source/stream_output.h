@@ -11,14 +11,34 @@
 #include "reference_string.h"
 #include "nextchar.h"
 
+template <typename T, typename Allocator>
+inline std::basic_ostream<T> & operator << (std::basic_ostream<T> &stream, const easl::slow_string<T, Allocator> &str)
+{
+    return stream.write(str.c_str(), static_cast<std::streamsize>(str.length()));
+}
+
+template <typename T, typename U, typename Allocator>
+inline std::basic_ostream<T> & operator << (std::basic_ostream<T> &stream, const easl::slow_string<U, Allocator> &str)
+{
+    const U *temp = str.c_str();
+
+    easl::uchar32_t ch;
+    while ((ch = easl::nextchar(temp)) != '\0')
+    {
+        stream.put((T)ch);
+    }
+
+    return stream;
+}
+
 template <typename T>
-inline std::basic_ostream<T> & operator << (std::basic_ostream<T> &stream, const easl::slow_string<T> &str)
+inline std::basic_ostream<T> & operator << (std::basic_ostream<T> &stream, const easl::fast_string<T> &str)
 {
     return stream.write(str.c_str(), static_cast<std::streamsize>(str.length()));
 }
 
 template <typename T, typename U>
-inline std::basic_ostream<T> & operator << (std::basic_ostream<T> &stream, const easl::slow_string<U> &str)
+inline std::basic_ostream<T> & operator << (std::basic_ostream<T> &stream, const easl::fast_string<U> &str)
 {
     const U *temp = str.c_str();
 
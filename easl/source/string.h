@@ -2,11 +2,18 @@
 *   \file   string.h
 *   \author Dave Reid
 *   \brief  Header file for the string classes.
+*
+*   Defining EASL_USING_FAST_STRING switches the typedefs below from slow_string to fast_string.
+*   fast_string has all of the members of slow_string, including reserve(), shrink_to_fit() and
+*   get_allocator(), so code written for one builds with the other. The exception is the allocator.
+*   Only slow_string takes one. fast_string always uses heap_allocator, so the constructors that take
+*   an allocator aren't available when the typedefs use it.
 */
 #ifndef __EASL_STRING_H_
 #define __EASL_STRING_H_
 
 #include "slow_string.h"
+#include "fast_string.h"
 
 namespace easl
 {
@@ -14,45 +14,53 @@ namespace easl
 {
 
 #ifdef EASL_ONLY_ASCII
-inline void tostring(__int64 value, char *dest, size_t destSize)
+inline void tostring(int64 value, char *dest, size_t destSize)
 {
+#if (PLATFORM == PLATFORM_WINDOWS)
     easl::format(dest, destSize, "%I64d", value);
+#else
+    easl::format(dest, destSize, "%lld", value);
+#endif
 }
-inline void tostring(unsigned __int64 value, char *dest, size_t destSize)
+inline void tostring(uint64 value, char *dest, size_t destSize)
 {
+#if (PLATFORM == PLATFORM_WINDOWS)
     easl::format(dest, destSize, "%I64u", value);
+#else
+    easl::format(dest, destSize, "%llu", value);
+#endif
 }
 inline void tostring(int value, char *dest, size_t destSize)
 {
-    easl::tostring(static_cast<__int64>(value), dest, destSize);
+    easl::tostring(static_cast<int64>(value), dest, destSize);
 }
 inline void tostring(unsigned int value, char *dest, size_t destSize)
 {
-    easl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    easl::tostring(static_cast<uint64>(value), dest, destSize);
 }
 inline void tostring(long value, char *dest, size_t destSize)
 {
-    easl::tostring(static_cast<__int64>(value), dest, destSize);
+    easl::tostring(static_cast<int64>(value), dest, destSize);
 }
 inline void tostring(unsigned long value, char *dest, size_t destSize)
 {
-    easl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    easl::tostring(static_cast<uint64>(value), dest, destSize);
 }
 inline void tostring(short value, char *dest, size_t destSize)
 {
-    easl::tostring(static_cast<__int64>(value), dest, destSize);
+    easl::tostring(static_cast<int64>(value), dest, destSize);
 }
 inline void tostring(unsigned short value, char *dest, size_t destSize)
 {
-    easl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    easl::tostring(static_cast<uint64>(value), dest, destSize);
 }
 inline void tostring(char value, char *dest, size_t destSize)
 {
-    easl::tostring(static_cast<__int64>(value), dest, destSize);
+    easl::tostring(static_cast<int64>(value), dest, destSize);
 }
 inline void tostring(unsigned char value, char *dest, size_t destSize)
 {
-    easl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    easl::tostring(static_cast<uint64>(value), dest, destSize);
 }
 inline void tostring(float value, char *dest, size_t destSize)
 {
@@ -77,49 +85,57 @@ inline void tostring(bool value, char *dest, size_t destSize)
 #endif
 
 
-inline void tostring(__int64 value, wchar_t *dest, size_t destSize)
+inline void tostring(int64 value, wchar_t *dest, size_t destSize)
 {
+#if (PLATFORM == PLATFORM_WINDOWS)
     easl::format(dest, destSize, L"%I64d", value);
+#else
+    easl::format(dest, destSize, L"%lld", value);
+#endif
 }
-inline void tostring(unsigned __int64 value, wchar_t *dest, size_t destSize)
+inline void tostring(uint64 value, wchar_t *dest, size_t destSize)
 {
+#if (PLATFORM == PLATFORM_WINDOWS)
     easl::format(dest, destSize, L"%I64u", value);
+#else
+    easl::format(dest, destSize, L"%llu", value);
+#endif
 }
 
 inline void tostring(int value, wchar_t *dest, size_t destSize)
 {
-    easl::tostring(static_cast<__int64>(value), dest, destSize);
+    easl::tostring(static_cast<int64>(value), dest, destSize);
 }
 inline void tostring(unsigned int value, wchar_t *dest, size_t destSize)
 {
-    easl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    easl::tostring(static_cast<uint64>(value), dest, destSize);
 }
 
 inline void tostring(long value, wchar_t *dest, size_t destSize)
 {
-    easl::tostring(static_cast<__int64>(value), dest, destSize);
+    easl::tostring(static_cast<int64>(value), dest, destSize);
 }
 inline void tostring(unsigned long value, wchar_t *dest, size_t destSize)
 {
-    easl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    easl::tostring(static_cast<uint64>(value), dest, destSize);
 }
 
 inline void tostring(short value, wchar_t *dest, size_t destSize)
 {
-    easl::tostring(static_cast<__int64>(value), dest, destSize);
+    easl::tostring(static_cast<int64>(value), dest, destSize);
 }
 inline void tostring(unsigned short value, wchar_t *dest, size_t destSize)
 {
-    easl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    easl::tostring(static_cast<uint64>(value), dest, destSize);
 }
 
 inline void tostring(char value, wchar_t *dest, size_t destSize)
 {
-    easl::tostring(static_cast<__int64>(value), dest, destSize);
+    easl::tostring(static_cast<int64>(value), dest, destSize);
 }
 inline void tostring(unsigned char value, wchar_t *dest, size_t destSize)
 {
-    easl::tostring(static_cast<unsigned __int64>(value), dest, destSize);
+    easl::tostring(static_cast<uint64>(value), dest, destSize);
 }
 
 inline void tostring(float value, wchar_t *dest, size_t destSize)
@@ -0,0 +1,300 @@
+/**
+*   \file   transcode.h
+*   \author Dave Reid
+*   \brief  Header file for the block transcoders.
+*
+*   The transcoders convert a block of a string from one encoding to another in one go rather
+*   than calling nextchar() and writechar() for each character. When vector instructions are
+*   available, runs of ASCII, runs of 2 byte UTF-8 sequences and runs of 3 byte UTF-8 sequences
+*   are converted several characters at a time. Anything else (surrogate pairs, 4 byte sequences,
+*   errors and the end of the buffers) goes through a scalar loop one character at a time, after
+*   which the vector loop is given another go.
+*
+*   copy() and copysize() use these functions for all of their conversions.
+*   \par
+*   The kernels themselves are in _transcode_kernels.h. When EASL_SIMD_DISPATCH is defined they
+*   are also built for SSSE3 and AVX2, and the fastest version that the CPU supports is used.
+*/
+#ifndef __EASL_TRANSCODE_H_
+#define __EASL_TRANSCODE_H_
+
+#include <assert.h>
+#include "_private.h"
+#include "_simd.h"
+#include "types.h"
+#include "nextchar.h"
+#include "writechar.h"
+#include "charwidth.h"
+#include "validate.h"
+#include "cpu.h"
+
+namespace easl
+{
+
+/**
+*   \brief                  Decodes a single UTF-8 character, checking that it is well formed.
+*   \param  source     [in]  Pointer to the first byte of the character.
+*   \param  sourceEnd  [in]  Pointer to the end of the buffer.
+*   \param  character  [out] Receives the decoded character.
+*   \return                  The number of bytes making up the character; or 0 if the character is invalid or truncated.
+*/
+inline size_t _decode_utf8_char(const unsigned char *source, const unsigned char *sourceEnd, uchar32_t &character)
+{
+    unsigned int state = UNI_UTF8_ACCEPT;
+    uchar32_t    ch    = 0;
+
+    for (const unsigned char *next = source; next < sourceEnd; )
+    {
+        decode_utf8(state, ch, *next++);
+
+        if (state == UNI_UTF8_ACCEPT)
+        {
+            character = ch;
+            return next - source;
+        }
+
+        if (state == UNI_UTF8_REJECT)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+*   \brief                  Encodes a single character as UTF-8.
+*   \param  dest      [out] The buffer that will receive the character. Can be NULL.
+*   \param  character [in]  The character to encode. This must be a valid Unicode scalar value.
+*   \return                 The number of bytes making up the encoded character.
+*/
+inline size_t _encode_utf8_char(unsigned char *dest, uchar32_t character)
+{
+    size_t width = charwidth<char>(character);
+
+    if (dest != NULL)
+    {
+        dest += width;
+
+        switch (width)
+        {
+        case 4: *--dest = static_cast<unsigned char>((character | 0x80) & 0xBF); character >>= 6;
+        case 3: *--dest = static_cast<unsigned char>((character | 0x80) & 0xBF); character >>= 6;
+        case 2: *--dest = static_cast<unsigned char>((character | 0x80) & 0xBF); character >>= 6;
+        case 1: *--dest = static_cast<unsigned char>(character | g_firstByteMark[width]);
+        }
+    }
+
+    return width;
+}
+
+}
+
+
+// The kernels for the instruction sets that are enabled at compile time.
+#define EASL_KERNEL_NAMESPACE   _transcode_base
+#define EASL_KERNEL_TARGET
+#if defined(EASL_SIMD_SSSE3)
+#define EASL_KERNEL_USE_SSSE3
+#endif
+#if defined(EASL_SIMD_AVX2)
+#define EASL_KERNEL_USE_AVX2
+#endif
+#include "_transcode_kernels.h"
+#undef EASL_KERNEL_NAMESPACE
+#undef EASL_KERNEL_TARGET
+#undef EASL_KERNEL_USE_SSSE3
+#undef EASL_KERNEL_USE_AVX2
+
+// The kernels that are picked at runtime. AVX2 implies SSSE3.
+#if defined(EASL_SIMD_DISPATCH) && !defined(EASL_SIMD_SSSE3)
+#define EASL_TRANSCODE_DISPATCH_SSSE3
+#define EASL_KERNEL_NAMESPACE   _transcode_ssse3
+#define EASL_KERNEL_TARGET      EASL_TARGET("ssse3")
+#define EASL_KERNEL_USE_SSSE3
+#include "_transcode_kernels.h"
+#undef EASL_KERNEL_NAMESPACE
+#undef EASL_KERNEL_TARGET
+#undef EASL_KERNEL_USE_SSSE3
+#endif
+
+#if defined(EASL_SIMD_DISPATCH) && !defined(EASL_SIMD_AVX2)
+#define EASL_TRANSCODE_DISPATCH_AVX2
+#define EASL_KERNEL_NAMESPACE   _transcode_avx2
+#define EASL_KERNEL_TARGET      EASL_TARGET("avx2")
+#define EASL_KERNEL_USE_SSSE3
+#define EASL_KERNEL_USE_AVX2
+#include "_transcode_kernels.h"
+#undef EASL_KERNEL_NAMESPACE
+#undef EASL_KERNEL_TARGET
+#undef EASL_KERNEL_USE_SSSE3
+#undef EASL_KERNEL_USE_AVX2
+#endif
+
+namespace easl
+{
+
+// Picks the fastest version of a transcoder that the CPU supports.
+#if defined(EASL_TRANSCODE_DISPATCH_AVX2)
+#define EASL_TRANSCODE_DISPATCH_TO_AVX2(function, args)     if (cpu_supports(EASL_CPU_AVX2)) { return _transcode_avx2::function args; }
+#else
+#define EASL_TRANSCODE_DISPATCH_TO_AVX2(function, args)
+#endif
+
+#if defined(EASL_TRANSCODE_DISPATCH_SSSE3)
+#define EASL_TRANSCODE_DISPATCH_TO_SSSE3(function, args)    if (cpu_supports(EASL_CPU_SSSE3)) { return _transcode_ssse3::function args; }
+#else
+#define EASL_TRANSCODE_DISPATCH_TO_SSSE3(function, args)
+#endif
+
+#define EASL_TRANSCODE_DISPATCH(function, args) \
+    EASL_TRANSCODE_DISPATCH_TO_AVX2(function, args) \
+    EASL_TRANSCODE_DISPATCH_TO_SSSE3(function, args) \
+    return _transcode_base::function args;
+
+/**
+*   \brief  UTF-8 to UTF-16 transcoder. T must be a 16-bit type.
+*/
+template <typename T>
+inline size_t _transcode_utf8_to_utf16(T *dest, size_t destSize, const char *&source, const char *sourceEnd)
+{
+    EASL_TRANSCODE_DISPATCH(_transcode_utf8_to_utf16, (dest, destSize, source, sourceEnd))
+}
+
+/**
+*   \brief  UTF-8 to UTF-32 transcoder. T must be at least 32 bits.
+*/
+template <typename T>
+inline size_t _transcode_utf8_to_utf32(T *dest, size_t destSize, const char *&source, const char *sourceEnd)
+{
+    EASL_TRANSCODE_DISPATCH(_transcode_utf8_to_utf32, (dest, destSize, source, sourceEnd))
+}
+
+/**
+*   \brief  UTF-16 to UTF-8 transcoder. T must be a 16-bit type.
+*/
+template <typename T>
+inline size_t _transcode_utf16_to_utf8(char *dest, size_t destSize, const T *&source, const T *sourceEnd)
+{
+    EASL_TRANSCODE_DISPATCH(_transcode_utf16_to_utf8, (dest, destSize, source, sourceEnd))
+}
+
+/**
+*   \brief  UTF-32 to UTF-8 transcoder. T must be at least 32 bits.
+*/
+template <typename T>
+inline size_t _transcode_utf32_to_utf8(char *dest, size_t destSize, const T *&source, const T *sourceEnd)
+{
+    EASL_TRANSCODE_DISPATCH(_transcode_utf32_to_utf8, (dest, destSize, source, sourceEnd))
+}
+
+#undef EASL_TRANSCODE_DISPATCH_TO_AVX2
+#undef EASL_TRANSCODE_DISPATCH_TO_SSSE3
+#undef EASL_TRANSCODE_DISPATCH
+
+
+/**
+*   \brief                    Converts a block of a string to another encoding.
+*   \param  dest       [out]    The buffer that will receive the converted string. Can be NULL.
+*   \param  destSize   [in]     The number of T's that can be written to \c dest.
+*   \param  source     [in,out] The string to convert. This is moved to the first character that was not converted.
+*   \param  sourceEnd  [in]     Pointer to the end of the source string.
+*   \return                     The number of T's that were written to \c dest.
+*
+*   \remarks
+*       Conversion stops at the end of the source string, at a null terminator, at the first invalid
+*       sequence in the source string or at the first character that does not fit in \c dest. The
+*       destination is _not_ null terminated.
+*       \par
+*       If \c dest is NULL, \c destSize is ignored and the function returns the number of T's required
+*       to store the converted string.
+*       \par
+*       A \c destSize of -1 means the size of \c dest is unknown. The vector paths store whole registers,
+*       which can run past the last character they convert, so in that case the whole string goes
+*       through the scalar path. Otherwise they are only used while \c dest has room for a full store.
+*       \par
+*       Characters that can not be represented in the destination encoding, such as unpaired low
+*       surrogates, are replaced with U+FFFD.
+*       \par
+*       The source is never read past \c sourceEnd.
+*/
+inline size_t transcode(char16_t *dest, size_t destSize, const char *&source, const char *sourceEnd)
+{
+    return _transcode_utf8_to_utf16(dest, destSize, source, sourceEnd);
+}
+inline size_t transcode(char32_t *dest, size_t destSize, const char *&source, const char *sourceEnd)
+{
+    return _transcode_utf8_to_utf32(dest, destSize, source, sourceEnd);
+}
+inline size_t transcode(wchar_t *dest, size_t destSize, const char *&source, const char *sourceEnd)
+{
+    if (sizeof(wchar_t) == 2)
+    {
+        return _transcode_utf8_to_utf16(dest, destSize, source, sourceEnd);
+    }
+
+    return _transcode_utf8_to_utf32(dest, destSize, source, sourceEnd);
+}
+inline size_t transcode(char *dest, size_t destSize, const char16_t *&source, const char16_t *sourceEnd)
+{
+    return _transcode_utf16_to_utf8(dest, destSize, source, sourceEnd);
+}
+inline size_t transcode(char *dest, size_t destSize, const char32_t *&source, const char32_t *sourceEnd)
+{
+    return _transcode_utf32_to_utf8(dest, destSize, source, sourceEnd);
+}
+inline size_t transcode(char *dest, size_t destSize, const wchar_t *&source, const wchar_t *sourceEnd)
+{
+    if (sizeof(wchar_t) == 2)
+    {
+        return _transcode_utf16_to_utf8(dest, destSize, source, sourceEnd);
+    }
+
+    return _transcode_utf32_to_utf8(dest, destSize, source, sourceEnd);
+}
+
+// Every other combination goes through nextchar() and writechar().
+template <typename T, typename U>
+inline size_t transcode(T *dest, size_t destSize, const U *&source, const U *sourceEnd)
+{
+    size_t count = 0;
+
+    while (source < sourceEnd)
+    {
+        const U *next = source;
+
+        uchar32_t ch = nextchar(next);
+        if (ch == '\0')
+        {
+            break;
+        }
+
+        // If the width is 0, writechar() will write the replacement character.
+        size_t width = charwidth<T>(ch);
+        if (width == 0)
+        {
+            width = charwidth<T>(UNI_REPLACEMENT_CHAR);
+        }
+
+        if (dest != NULL)
+        {
+            if (destSize - count < width)
+            {
+                break;
+            }
+
+            T *temp = dest + count;
+            writechar(temp, ch);
+        }
+
+        source = next;
+        count += width;
+    }
+
+    return count;
+}
+
+
+}
+
+#endif // __EASL_TRANSCODE_H_
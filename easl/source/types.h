@@ -6,6 +6,8 @@
 #ifndef __EASL_TYPES_H_
 #define __EASL_TYPES_H_
 
+#include "setup.h"
+
 namespace easl
 {
 
@@ -14,12 +16,25 @@ namespace easl
 // they're available on most compilers. If char8_t is not a proper type for the final
 // C++0x spec, we will keep the typedef for clarity. (It really should be a built-in
 // type).
+//
+// When the compiler has the built-in types they are keywords, so we use them instead.
+#ifndef EASL_HAS_CHAR16_T
 typedef short  char16_t;
 typedef long   char32_t;
+#endif
 
 typedef unsigned short  uchar16_t;
 typedef unsigned long   uchar32_t;
 
+// 64-bit integers. Visual C has __int64 where other compilers have long long.
+#if (COMPILER & COMPILER_VC)
+typedef __int64             int64;
+typedef unsigned __int64    uint64;
+#else
+typedef long long           int64;
+typedef unsigned long long  uint64;
+#endif
+
 
 // Enumerator for different locales. These are used for locale dependant routines.
 /*enum locale
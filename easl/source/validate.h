@@ -0,0 +1,450 @@
+/**
+*   \file   validate.h
+*   \author Dave Reid
+*   \brief  Header file for validate_utf8() implementations.
+*
+*   The vectorised kernels use the lookup table method described by John Keiser and
+*   Daniel Lemire in "Validating UTF-8 In Less Than One Instruction Per Byte". Each
+*   block of input is checked against the block before it by looking at the high and
+*   low nibbles of the previous byte and the high nibble of the current byte.
+*/
+#ifndef __EASL_VALIDATE_H_
+#define __EASL_VALIDATE_H_
+
+#include <assert.h>
+#include "_private.h"
+#include "_simd.h"
+#include "nextchar.h"
+#include "length.h"
+#include "reference_string.h"
+
+namespace easl
+{
+
+// Error flags used by the vectorised UTF-8 validator. A byte pair is invalid when the
+// same flag is set in each of the three lookups.
+#define EASL_UTF8_TOO_SHORT         (1 << 0)    // 11______ 0_______ or 11______ 11______
+#define EASL_UTF8_TOO_LONG          (1 << 1)    // 0_______ 10______
+#define EASL_UTF8_OVERLONG_3        (1 << 2)    // 11100000 100_____
+#define EASL_UTF8_TOO_LARGE         (1 << 3)    // 11110100 1001____ and above
+#define EASL_UTF8_SURROGATE         (1 << 4)    // 11101101 101_____
+#define EASL_UTF8_OVERLONG_2        (1 << 5)    // 1100000_ 10______
+#define EASL_UTF8_TOO_LARGE_1000    (1 << 6)    // 11110101 1000____ and above
+#define EASL_UTF8_OVERLONG_4        (1 << 6)    // 11110000 1000____
+#define EASL_UTF8_TWO_CONTS         (1 << 7)    // 10______ 10______
+#define EASL_UTF8_CARRY             (EASL_UTF8_TOO_SHORT | EASL_UTF8_TOO_LONG | EASL_UTF8_TWO_CONTS)
+
+/*
+ * Lookup table indexed by the high nibble of the first byte in a byte pair.
+ */
+static const unsigned char g_utf8Byte1High[16] = {
+    // 0_______ ________ <ASCII in byte 1>
+    EASL_UTF8_TOO_LONG, EASL_UTF8_TOO_LONG, EASL_UTF8_TOO_LONG, EASL_UTF8_TOO_LONG,
+    EASL_UTF8_TOO_LONG, EASL_UTF8_TOO_LONG, EASL_UTF8_TOO_LONG, EASL_UTF8_TOO_LONG,
+    // 10______ ________ <continuation in byte 1>
+    EASL_UTF8_TWO_CONTS, EASL_UTF8_TWO_CONTS, EASL_UTF8_TWO_CONTS, EASL_UTF8_TWO_CONTS,
+    // 1100____ ________ <two byte lead in byte 1>
+    EASL_UTF8_TOO_SHORT | EASL_UTF8_OVERLONG_2,
+    // 1101____ ________ <two byte lead in byte 1>
+    EASL_UTF8_TOO_SHORT,
+    // 1110____ ________ <three byte lead in byte 1>
+    EASL_UTF8_TOO_SHORT | EASL_UTF8_OVERLONG_3 | EASL_UTF8_SURROGATE,
+    // 1111____ ________ <four+ byte lead in byte 1>
+    EASL_UTF8_TOO_SHORT | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000 | EASL_UTF8_OVERLONG_4
+};
+
+/*
+ * Lookup table indexed by the low nibble of the first byte in a byte pair.
+ */
+static const unsigned char g_utf8Byte1Low[16] = {
+    // ____0000 ________
+    EASL_UTF8_CARRY | EASL_UTF8_OVERLONG_3 | EASL_UTF8_OVERLONG_2 | EASL_UTF8_OVERLONG_4,
+    // ____0001 ________
+    EASL_UTF8_CARRY | EASL_UTF8_OVERLONG_2,
+    // ____001_ ________
+    EASL_UTF8_CARRY,
+    EASL_UTF8_CARRY,
+    // ____0100 ________
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE,
+    // ____0101 ________
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000,
+    // ____011_ ________
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000,
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000,
+    // ____1___ ________
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000,
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000,
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000,
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000,
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000,
+    // ____1101 ________
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000 | EASL_UTF8_SURROGATE,
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000,
+    EASL_UTF8_CARRY | EASL_UTF8_TOO_LARGE | EASL_UTF8_TOO_LARGE_1000
+};
+
+/*
+ * Lookup table indexed by the high nibble of the second byte in a byte pair.
+ */
+static const unsigned char g_utf8Byte2High[16] = {
+    // ________ 0_______ <ASCII in byte 2>
+    EASL_UTF8_TOO_SHORT, EASL_UTF8_TOO_SHORT, EASL_UTF8_TOO_SHORT, EASL_UTF8_TOO_SHORT,
+    EASL_UTF8_TOO_SHORT, EASL_UTF8_TOO_SHORT, EASL_UTF8_TOO_SHORT, EASL_UTF8_TOO_SHORT,
+    // ________ 1000____
+    EASL_UTF8_TOO_LONG | EASL_UTF8_OVERLONG_2 | EASL_UTF8_TWO_CONTS | EASL_UTF8_OVERLONG_3 | EASL_UTF8_TOO_LARGE_1000 | EASL_UTF8_OVERLONG_4,
+    // ________ 1001____
+    EASL_UTF8_TOO_LONG | EASL_UTF8_OVERLONG_2 | EASL_UTF8_TWO_CONTS | EASL_UTF8_OVERLONG_3 | EASL_UTF8_TOO_LARGE,
+    // ________ 101_____
+    EASL_UTF8_TOO_LONG | EASL_UTF8_OVERLONG_2 | EASL_UTF8_TWO_CONTS | EASL_UTF8_SURROGATE | EASL_UTF8_TOO_LARGE,
+    EASL_UTF8_TOO_LONG | EASL_UTF8_OVERLONG_2 | EASL_UTF8_TWO_CONTS | EASL_UTF8_SURROGATE | EASL_UTF8_TOO_LARGE,
+    // ________ 11______
+    EASL_UTF8_TOO_SHORT, EASL_UTF8_TOO_SHORT, EASL_UTF8_TOO_SHORT, EASL_UTF8_TOO_SHORT
+};
+
+/*
+ * The largest value each of the last bytes in a block can have without starting a
+ * sequence that continues into the next block.
+ */
+static const unsigned char g_utf8IncompleteMax[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF
+};
+
+
+/**
+*   \brief                 Retrieves the number of bytes making up the valid UTF-8 sequence at the start of a buffer.
+*   \param  str       [in] Pointer to the first byte of the sequence.
+*   \param  strLength [in] The number of bytes remaining in the buffer.
+*   \return                The number of bytes in the sequence; or 0 if the sequence is invalid or truncated.
+*/
+inline size_t _utf8_sequence_length(const unsigned char *str, size_t strLength)
+{
+    unsigned int state = UNI_UTF8_ACCEPT;
+    uchar32_t    ch    = 0;
+
+    for (size_t i = 0; i < strLength; ++i)
+    {
+        decode_utf8(state, ch, str[i]);
+
+        if (state == UNI_UTF8_ACCEPT)
+        {
+            return i + 1;
+        }
+
+        if (state == UNI_UTF8_REJECT)
+        {
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+/**
+*   \brief                 Moves an offset back to the start of the code point that the byte just before it belongs to.
+*   \param  str       [in] The buffer.
+*   \param  offset    [in] The offset to move back.
+*   \return                The offset of the first byte of the code point.
+*
+*   \remarks
+*       This is used to restart validation at a code point boundary when a vectorised kernel stops
+*       in the middle of a buffer. A UTF-8 sequence is at most 4 bytes, so we never look back more
+*       than 3 bytes. The byte at \c offset itself is never read.
+*/
+inline size_t _utf8_rewind(const unsigned char *str, size_t offset)
+{
+    size_t start = offset;
+    for (int i = 0; i < 3 && start > 0; ++i)
+    {
+        --start;
+
+        if ((str[start] & 0xC0) != 0x80)
+        {
+            return start;
+        }
+    }
+
+    return offset;
+}
+
+/**
+*   \brief                 Scalar UTF-8 validator.
+*   \param  str       [in] The buffer to validate.
+*   \param  strLength [in] The size of the buffer in bytes.
+*   \return                The offset of the first invalid sequence; or \c strLength if the buffer is valid.
+*/
+inline size_t _validate_utf8_scalar(const unsigned char *str, size_t strLength)
+{
+    size_t offset = 0;
+    while (offset < strLength)
+    {
+        if (str[offset] < 0x80)
+        {
+            ++offset;
+        }
+        else
+        {
+            size_t width = _utf8_sequence_length(str + offset, strLength - offset);
+            if (width == 0)
+            {
+                break;
+            }
+
+            offset += width;
+        }
+    }
+
+    return offset;
+}
+
+#if defined(EASL_SIMD_SSE2)
+/**
+*   \brief  SSE2 implementation of the UTF-8 validator.
+*
+*   SSE2 doesn't have a byte shuffle, so we can't do the table lookups. Instead we skip
+*   over ASCII blocks 16 bytes at a time and validate everything else with the scalar
+*   validator.
+*/
+inline size_t _validate_utf8_sse2(const unsigned char *str, size_t strLength)
+{
+    size_t offset = 0;
+    while (offset + 16 <= strLength)
+    {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(str + offset))) == 0)
+        {
+            offset += 16;
+        }
+        else
+        {
+            // Validate each character until we've moved past this block.
+            size_t block_end = offset + 16;
+            while (offset < block_end)
+            {
+                if (str[offset] < 0x80)
+                {
+                    ++offset;
+                }
+                else
+                {
+                    size_t width = _utf8_sequence_length(str + offset, strLength - offset);
+                    if (width == 0)
+                    {
+                        return offset;
+                    }
+
+                    offset += width;
+                }
+            }
+        }
+    }
+
+    return offset + _validate_utf8_scalar(str + offset, strLength - offset);
+}
+#endif
+
+#if defined(EASL_KERNEL_SSSE3)
+/**
+*   \brief  SSSE3 implementation of the lookup table UTF-8 validator.
+*/
+EASL_TARGET("ssse3") inline size_t _validate_utf8_ssse3(const unsigned char *str, size_t strLength)
+{
+    const __m128i byte_1_high = _mm_loadu_si128((const __m128i *)g_utf8Byte1High);
+    const __m128i byte_1_low  = _mm_loadu_si128((const __m128i *)g_utf8Byte1Low);
+    const __m128i byte_2_high = _mm_loadu_si128((const __m128i *)g_utf8Byte2High);
+    const __m128i max_value   = _mm_loadu_si128((const __m128i *)(g_utf8IncompleteMax + 16));
+    const __m128i low_nibble  = _mm_set1_epi8(0x0F);
+    const __m128i zero        = _mm_setzero_si128();
+
+    __m128i prev_input      = zero;
+    __m128i prev_incomplete = zero;
+
+    size_t offset = 0;
+    for ( ; offset + 16 <= strLength; offset += 16)
+    {
+        __m128i input = _mm_loadu_si128((const __m128i *)(str + offset));
+        __m128i error;
+
+        bool is_ascii = _mm_movemask_epi8(input) == 0;
+        if (is_ascii)
+        {
+            // The block is pure ASCII. The only thing that can go wrong is a sequence
+            // from the previous block that didn't get to finish.
+            error = prev_incomplete;
+        }
+        else
+        {
+            __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+            __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+            __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+
+            __m128i special = _mm_and_si128(
+                _mm_and_si128(
+                    _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble)),
+                    _mm_shuffle_epi8(byte_1_low,  _mm_and_si128(prev1, low_nibble))),
+                _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble)));
+
+            // The third and fourth bytes of 3 and 4 byte sequences must be continuations. Only
+            // bytes that are at least 0xE0 or 0xF0 end up with their high bit set here.
+            __m128i must23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80))),
+                                          _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80))));
+
+            error = _mm_xor_si128(_mm_and_si128(must23, _mm_set1_epi8((char)0x80)), special);
+        }
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xFFFF)
+        {
+            break;
+        }
+
+        prev_input      = input;
+        prev_incomplete = is_ascii ? zero : _mm_subs_epu8(input, max_value);
+    }
+
+    // Whatever is left over, or the block containing the error, is finished off with the scalar
+    // validator. It will find the exact location of the error for us.
+    offset = _utf8_rewind(str, offset);
+
+    return offset + _validate_utf8_scalar(str + offset, strLength - offset);
+}
+#endif
+
+#if defined(EASL_KERNEL_AVX2)
+/**
+*   \brief  AVX2 implementation of the lookup table UTF-8 validator.
+*/
+EASL_TARGET("avx2") inline size_t _validate_utf8_avx2(const unsigned char *str, size_t strLength)
+{
+    const __m256i byte_1_high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)g_utf8Byte1High));
+    const __m256i byte_1_low  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)g_utf8Byte1Low));
+    const __m256i byte_2_high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)g_utf8Byte2High));
+    const __m256i max_value   = _mm256_loadu_si256((const __m256i *)g_utf8IncompleteMax);
+    const __m256i low_nibble  = _mm256_set1_epi8(0x0F);
+    const __m256i zero        = _mm256_setzero_si256();
+
+    __m256i prev_input      = zero;
+    __m256i prev_incomplete = zero;
+
+    size_t offset = 0;
+    for ( ; offset + 32 <= strLength; offset += 32)
+    {
+        __m256i input = _mm256_loadu_si256((const __m256i *)(str + offset));
+        __m256i error;
+
+        bool is_ascii = _mm256_movemask_epi8(input) == 0;
+        if (is_ascii)
+        {
+            error = prev_incomplete;
+        }
+        else
+        {
+            // alignr works on each 128-bit lane separately, so we need the previous input
+            // shifted across the lane boundary first.
+            __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+            __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+            __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+            __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+
+            __m256i special = _mm256_and_si256(
+                _mm256_and_si256(
+                    _mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble)),
+                    _mm256_shuffle_epi8(byte_1_low,  _mm256_and_si256(prev1, low_nibble))),
+                _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble)));
+
+            __m256i must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80))),
+                                             _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80))));
+
+            error = _mm256_xor_si256(_mm256_and_si256(must23, _mm256_set1_epi8((char)0x80)), special);
+        }
+
+        if (!_mm256_testz_si256(error, error))
+        {
+            break;
+        }
+
+        prev_input      = input;
+        prev_incomplete = is_ascii ? zero : _mm256_subs_epu8(input, max_value);
+    }
+
+    offset = _utf8_rewind(str, offset);
+
+    return offset + _validate_utf8_scalar(str + offset, strLength - offset);
+}
+#endif
+
+
+/**
+*   \brief                    Validates a UTF-8 string.
+*   \param  str          [in]  The string to validate.
+*   \param  strLength    [in]  The length in bytes of the string, or -1 if the string is null terminated.
+*   \param  errorOffset  [out] Pointer to the variable that will receive the offset of the first invalid sequence. Can be NULL.
+*   \return                    True if the string is well formed UTF-8; false otherwise.
+*
+*   \remarks
+*       A string is valid if it contains no overlong sequences, no encoded UTF-16 surrogates, no
+*       characters larger than U+10FFFF and no truncated sequences. If \c strLength is not -1, null
+*       characters are considered valid and will not end the validation.
+*       \par
+*       If the string is valid, \c errorOffset receives the length of the string. Otherwise it receives
+*       the offset in bytes of the first byte of the offending sequence.
+*       \par
+*       Once a string has been validated, nextchar_utf8_trusted() can be used to decode it without
+*       checking each character again.
+*       \par
+*       The fastest kernel that the CPU supports is used. See cpu_supports().
+*/
+inline bool validate_utf8(const char *str, size_t strLength = -1, size_t *errorOffset = NULL)
+{
+    assert(str != NULL);
+
+    if (strLength == (size_t)-1)
+    {
+        strLength = easl::length(str);
+    }
+
+    const unsigned char *source = reinterpret_cast<const unsigned char *>(str);
+
+    size_t offset;
+#if defined(EASL_KERNEL_AVX2)
+    if (cpu_supports(EASL_CPU_AVX2))
+    {
+        offset = _validate_utf8_avx2(source, strLength);
+    }
+    else
+#endif
+#if defined(EASL_KERNEL_SSSE3)
+    if (cpu_supports(EASL_CPU_SSSE3))
+    {
+        offset = _validate_utf8_ssse3(source, strLength);
+    }
+    else
+#endif
+    {
+#if defined(EASL_SIMD_SSE2)
+        offset = _validate_utf8_sse2(source, strLength);
+#else
+        offset = _validate_utf8_scalar(source, strLength);
+#endif
+    }
+
+    if (errorOffset != NULL)
+    {
+        *errorOffset = offset;
+    }
+
+    return offset == strLength;
+}
+
+inline bool validate_utf8(const reference_string<const char> &str, size_t *errorOffset = NULL)
+{
+    return validate_utf8(str.start, length(str), errorOffset);
+}
+
+inline bool validate_utf8(const reference_string<char> &str, size_t *errorOffset = NULL)
+{
+    return validate_utf8(str.start, length(str), errorOffset);
+}
+
+
+}
+
+#endif // __EASL_VALIDATE_H_
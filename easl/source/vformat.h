@@ -13,6 +13,7 @@
 #include <errno.h>
 #include <assert.h>
 #include "copy.h"
+#include "allocator.h"
 
 namespace easl
 {
@@ -37,8 +38,12 @@ namespace easl
 template <typename T>
 inline int vformat(T *dest, size_t destSize, const T *format, va_list args)
 {
+    // The temporary buffers come from temp_allocator, which avoids the heap for short strings.
+    // They need to be freed in the reverse order that they were allocated.
+    temp_allocator allocator;
+
     size_t format_size = easl::copysize<wchar_t>(format);
-    wchar_t *tmp_format = new wchar_t[format_size];
+    wchar_t *tmp_format = static_cast<wchar_t *>(allocator.allocate(format_size * sizeof(wchar_t)));
     easl::copy(tmp_format, format, format_size);
 
     int result;
@@ -47,22 +52,21 @@ inline int vformat(T *dest, size_t destSize, const T *format, va_list args)
     // but it's the simplest way to do it.
     if (dest != NULL)
     {
-        wchar_t *tmp_dest = new wchar_t[destSize];
-        easl::copy(tmp_dest, dest, destSize);
+        wchar_t *tmp_dest = static_cast<wchar_t *>(allocator.allocate(destSize * sizeof(wchar_t)));
 
         result = easl::vformat(tmp_dest, destSize, tmp_format, args);
 
         // Convert our string back.
-        easl::copy(dest, tmp_dest);
+        easl::copy(dest, tmp_dest, destSize);
 
-        delete [] tmp_dest;
+        allocator.deallocate(tmp_dest);
     }
     else
     {
         result = easl::vformat((wchar_t *)NULL, 0, tmp_format, args);
     }
 
-    delete [] tmp_format;
+    allocator.deallocate(tmp_format);
 
     return result;
 }
@@ -99,7 +103,7 @@ template <> inline int vformat(wchar_t *dest, size_t destSize, const wchar_t *fo
     }
 
     return ::_vscwprintf(format, args);
-#else
+#elif (PLATFORM == PLATFORM_WINDOWS)
     if (dest != NULL)
     {
         return ::vswprintf(dest, format, args);
@@ -110,6 +114,39 @@ template <> inline int vformat(wchar_t *dest, size_t destSize, const wchar_t *fo
     // Our temporary pointer.
     wchar_t temp[2];
     return _vsnwprintf(temp, 2, format, args) + 1;
+#else
+    if (dest != NULL)
+    {
+        return ::vswprintf(dest, destSize, format, args);
+    }
+
+    // Unlike vsnprintf(), the standard vswprintf() fails instead of returning the required size when
+    // the buffer is too small, so we format into a temporary buffer that is doubled until it fits.
+    temp_allocator allocator;
+
+    for (size_t temp_size = 256; temp_size <= (static_cast<size_t>(1) << 24); temp_size *= 2)
+    {
+        wchar_t *temp = static_cast<wchar_t *>(allocator.allocate(temp_size * sizeof(wchar_t)));
+
+        // The arguments can only be read once, so each attempt needs its own copy of them.
+        va_list args_copy;
+#if defined(va_copy)
+        va_copy(args_copy, args);
+#else
+        __builtin_va_copy(args_copy, args);
+#endif
+        int result = ::vswprintf(temp, temp_size, format, args_copy);
+        va_end(args_copy);
+
+        allocator.deallocate(temp);
+
+        if (result >= 0)
+        {
+            return result + 1;
+        }
+    }
+
+    return 0;
 #endif
 }
 
@@ -132,7 +132,16 @@ inline size_t writechar(wchar_t *&dest, uchar32_t character)
     switch (sizeof(wchar_t))
     {
     case 2: return writechar((char16_t *&)dest, character);
-    case 4: return writechar((char16_t *&)dest, character);
+    case 4:
+        {
+            // char32_t is not necessarily 32 bits, so we can't treat the string as a char32_t string.
+            if (dest != NULL)
+            {
+                *dest++ = static_cast<wchar_t>(validate_utf32_char(character));
+            }
+
+            return 1;
+        }
     }
 
     return writechar((char32_t *&)dest, character);
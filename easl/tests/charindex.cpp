@@ -0,0 +1,98 @@
+/**
+*   \file   charindex.cpp
+*   \author Dave Reid
+*   \brief  Tests for charindex and the functions that take one.
+*/
+#include "easl.h"
+#include "test.h"
+
+// An index built with an explicit length must match one built up to the null terminator.
+template <typename T>
+void check_same_as_terminated(const T *str, size_t strLength, size_t interval)
+{
+    easl::charindex<T> terminated(str, -1, interval);
+    easl::charindex<T> bounded(str, strLength, interval);
+
+    EASL_CHECK(bounded.charcount() == terminated.charcount());
+    EASL_CHECK(bounded.length() == terminated.length());
+
+    for (size_t i = 0; i <= terminated.charcount(); ++i)
+    {
+        EASL_CHECK(bounded.offset(i) == terminated.offset(i));
+        EASL_CHECK(bounded.getchar(i) == terminated.getchar(i));
+    }
+}
+
+int main()
+{
+    // 64 characters, which is a whole number of intervals.
+    const char *ascii = "The quick brown fox jumps over the lazy dog, then does it again!";
+    EASL_CHECK(easl::length(ascii) == 64);
+
+    check_same_as_terminated(ascii, 64, 32);
+    check_same_as_terminated(ascii, 64, 16);
+    check_same_as_terminated(ascii, 64, 64);
+    check_same_as_terminated(ascii, 64, 7);
+
+    easl::charindex<char> index(ascii, 64, 32);
+    EASL_CHECK(index.charcount() == 64);
+    EASL_CHECK(index.offset(40) == 40);
+    EASL_CHECK(index.getchar(40) == 'd');
+    EASL_CHECK(index.offset(64) == 64);
+    EASL_CHECK(index.offset(65) == (size_t)-1);
+
+    // 32 two byte characters.
+    const char *latin = "\xC3\xA0\xC3\xA1\xC3\xA2\xC3\xA3\xC3\xA4\xC3\xA5\xC3\xA6\xC3\xA7"
+                        "\xC3\xA8\xC3\xA9\xC3\xAA\xC3\xAB\xC3\xAC\xC3\xAD\xC3\xAE\xC3\xAF"
+                        "\xC3\xB0\xC3\xB1\xC3\xB2\xC3\xB3\xC3\xB4\xC3\xB5\xC3\xB6\xC3\xB7"
+                        "\xC3\xB8\xC3\xB9\xC3\xBA\xC3\xBB\xC3\xBC\xC3\xBD\xC3\xBE\xC3\xBF";
+    check_same_as_terminated(latin, 64, 16);
+    check_same_as_terminated(latin, 64, 8);
+
+    // A character split by the end of the string is left out.
+    easl::charindex<char> split(latin, 63, 16);
+    EASL_CHECK(split.charcount() == 31);
+    EASL_CHECK(split.length() == 62);
+    EASL_CHECK(split.offset(31) == 62);
+
+    // Reference strings are always indexed with an explicit length.
+    easl::reference_string<const char> ref = {ascii, ascii + 64};
+    easl::charindex<const char> refindex(ref, 32);
+    EASL_CHECK(refindex.charcount() == 64);
+    EASL_CHECK(refindex.getchar(40) == 'd');
+
+    easl::reference_string<const char> section = refindex.slice(35, 5);
+    EASL_CHECK(section.start == ascii + 35 && section.end == ascii + 40);
+
+    size_t indices[3] = {31, 40, 64};
+    size_t offsets[3];
+    refindex.offsets(indices, 3, offsets);
+    EASL_CHECK(offsets[0] == 31 && offsets[1] == 40 && offsets[2] == 64);
+
+    // A string that isn't null terminated and ends part way through a character. Nothing past the
+    // end may be read, which AddressSanitizer checks for since the buffer is on the heap.
+    char *unterminated = new char[3];
+    unterminated[0] = 'a';
+    unterminated[1] = 'b';
+    unterminated[2] = '\xE2';
+
+    easl::reference_string<const char> unterminatedref = {unterminated, unterminated + 3};
+    easl::charindex<const char> unterminatedindex(unterminatedref, 1);
+    EASL_CHECK(unterminatedindex.charcount() == 2);
+    EASL_CHECK(unterminatedindex.length() == 2);
+    EASL_CHECK(unterminatedindex.getchar(1) == 'b');
+
+    easl::charindex<char> unterminatedbuffer(unterminated, 3, 2);
+    EASL_CHECK(unterminatedbuffer.charcount() == 2);
+    EASL_CHECK(unterminatedbuffer.length() == 2);
+
+    delete [] unterminated;
+
+    char buffer[65];
+    easl::copy(buffer, ascii, 65);
+    easl::charindex<char> bufferindex(buffer, 64, 32);
+    easl::erase(buffer, 35, 20, bufferindex);
+    EASL_CHECK(easl::equal(buffer, "The quick brown fox jumps over the it again!"));
+
+    return easl_test_result();
+}
@@ -0,0 +1,121 @@
+/**
+*   \file   copy.cpp
+*   \author Dave Reid
+*   \brief  Tests for copy() and copysize().
+*/
+#include "easl.h"
+#include "equal.h"
+#include "test.h"
+
+// For char16_t and char32_t when the compiler doesn't have them.
+using namespace easl;
+
+// Copies into a buffer of exactly copysize() T's, with and without the size given. The buffer is
+// followed by a guard that must be left alone. Running under AddressSanitizer also catches writes
+// past the buffer without the guard.
+template <typename T, typename U>
+void check_exact_copy(const U *source)
+{
+    const size_t guard = 64;
+    const T      fill  = static_cast<T>('Z');
+
+    size_t size = easl::copysize<T>(source);
+
+    T *expected = new T[size];
+    EASL_CHECK(easl::copy(expected, source, size) == size);
+    EASL_CHECK(expected[size - 1] == '\0');
+
+    for (int known = 0; known < 2; ++known)
+    {
+        T *guarded = new T[size + guard];
+        for (size_t i = 0; i < size + guard; ++i)
+        {
+            guarded[i] = fill;
+        }
+
+        EASL_CHECK(easl::copy(guarded, source, known ? size : (size_t)-1) == size);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            EASL_CHECK(guarded[i] == expected[i]);
+        }
+
+        for (size_t i = size; i < size + guard; ++i)
+        {
+            EASL_CHECK(guarded[i] == fill);
+        }
+
+        delete [] guarded;
+
+        T *exact = new T[size];
+        EASL_CHECK(easl::copy(exact, source, known ? size : (size_t)-1) == size);
+        EASL_CHECK(easl::equal(exact, expected));
+        delete [] exact;
+    }
+
+    delete [] expected;
+}
+
+// Checks a UTF-8 string in every direction the block transcoders handle.
+void check_utf8(const char *source)
+{
+    check_exact_copy<char16_t>(source);
+    check_exact_copy<char32_t>(source);
+    check_exact_copy<wchar_t>(source);
+
+    size_t size16 = easl::copysize<char16_t>(source);
+    char16_t *utf16 = new char16_t[size16];
+    easl::copy(utf16, source, size16);
+    check_exact_copy<char>(utf16);
+
+    size_t size32 = easl::copysize<char32_t>(source);
+    char32_t *utf32 = new char32_t[size32];
+    easl::copy(utf32, source, size32);
+    check_exact_copy<char>(utf32);
+
+    // And back again.
+    char *utf8 = new char[size32 * 4];
+    easl::copy(utf8, utf16);
+    EASL_CHECK(easl::equal(utf8, source));
+    easl::copy(utf8, utf32);
+    EASL_CHECK(easl::equal(utf8, source));
+
+    delete [] utf8;
+    delete [] utf32;
+    delete [] utf16;
+}
+
+int main()
+{
+    // The output of a block is shorter than the registers that are stored.
+    check_utf8("a\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC\xE2\x82\xAC" "bc");
+    check_utf8("\xC3\xA9\xC3\xA9\xC3\xA9\xC3\xA9\xC3\xA9\xC3\xA9\xC3\xA9\xC3\xA9x");
+
+    // Runs of ASCII long enough for every vector path, ending at each offset around a store.
+    const char *ascii = "The quick brown fox jumps over the lazy dog, then does it again! And again.";
+    for (size_t i = 0; i <= easl::length(ascii); ++i)
+    {
+        char source[128];
+        easl::copy(source, ascii, i + 1, i);
+        check_utf8(source);
+    }
+
+    // Mixed widths, including characters outside the BMP.
+    check_utf8("H\xC3\xA9llo w\xC3\xB6rld, \xE2\x82\xAC" "5 \xF0\x9F\x98\x80 and some more text to fill a register or two");
+
+    // Code units of 0x80 and above aren't ASCII and end a copy with the ASCII tag. They must not be
+    // sign extended on their way into a wider type either.
+    char16_t ascii16[8];
+    EASL_CHECK(easl::copy(ascii16, "ab\xC3\xA9" "cd", 8, -1, easl::ascii_t()) == 3);
+    EASL_CHECK(ascii16[0] == 'a' && ascii16[1] == 'b' && ascii16[2] == 0);
+    EASL_CHECK(easl::copy((char16_t *)NULL, "ab\xC3\xA9" "cd", -1, -1, easl::ascii_t()) == 3);
+    EASL_CHECK(easl::copy(ascii16, "abcd", 8, 3, easl::ascii_t()) == 4);
+    EASL_CHECK(ascii16[2] == 'c' && ascii16[3] == 0);
+
+    const char32_t wide[] = {'x', 0xE9, 'y', 0};
+    char ascii8[8];
+    EASL_CHECK(easl::copy(ascii8, wide, 8, -1, easl::ascii_t()) == 2);
+    EASL_CHECK(easl::equal(ascii8, "x"));
+
+    return easl_test_result();
+}
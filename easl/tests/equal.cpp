@@ -0,0 +1,67 @@
+/**
+*   \file   equal.cpp
+*   \author Dave Reid
+*   \brief  Tests for equal().
+*/
+#include "easl.h"
+#include "equal.h"
+#include "test.h"
+
+// Checks a comparison both ways round and in both modes. \c folded is the expected result of a case
+// insensitive comparison, and a case sensitive comparison is expected to be false whenever it is.
+template <typename T, typename U>
+void check_equal(const T *str1, size_t str1Length, const U *str2, size_t str2Length, bool same, bool folded)
+{
+    EASL_CHECK(easl::equal(str1, str2, true, str1Length, str2Length) == same);
+    EASL_CHECK(easl::equal(str2, str1, true, str2Length, str1Length) == same);
+    EASL_CHECK(easl::equal(str1, str2, false, str1Length, str2Length) == folded);
+    EASL_CHECK(easl::equal(str2, str1, false, str2Length, str1Length) == folded);
+}
+
+int main()
+{
+    const size_t unknown = (size_t)-1;
+
+    // Null terminated strings, and strings with one or both lengths given.
+    check_equal("Hello", unknown, "Hello", unknown, true, true);
+    check_equal("Hello", unknown, "HELLO", unknown, false, true);
+    check_equal("Hello", 5, "Hello", unknown, true, true);
+    check_equal("Hello", 4, "Hello", unknown, false, false);
+    check_equal("Hello", 4, "Hell", 4, true, true);
+    check_equal("Hello", unknown, "Hello!", unknown, false, false);
+
+    // Different encodings.
+    check_equal("H\xC3\xA9llo \xF0\x9F\x98\x80", unknown, L"H\x00E9llo \U0001F600", unknown, true, true);
+    check_equal("H\xC3\xA9llo", unknown, L"H\x00C9LLO", unknown, false, true);
+    check_equal("H\xC3\xA9llo", 6, L"H\x00E9llo", 5, true, true);
+    check_equal("H\xC3\xA9llo", 5, L"H\x00E9llo", 5, false, false);
+
+    // A given length includes any null characters inside it, whether or not the comparison is
+    // case sensitive.
+    const char    embedded[]      = {'a', 'b', '\0', 'c', '\0'};
+    const wchar_t embeddedw[]     = {L'a', L'b', L'\0', L'c', L'\0'};
+    const wchar_t embeddedUpper[] = {L'A', L'B', L'\0', L'C', L'\0'};
+
+    check_equal(embedded, 4, "ab", 2, false, false);
+    check_equal(embedded, 4, "AB", 2, false, false);
+    check_equal(embedded, 4, embedded, 4, true, true);
+    check_equal(embedded, 4, embeddedw, 4, true, true);
+    check_equal(embedded, 4, embeddedUpper, 4, false, true);
+    check_equal(embedded, 4, L"ab", 2, false, false);
+    check_equal(embedded, 4, L"AB", 2, false, false);
+    check_equal(embedded, 2, L"AB", 2, false, true);
+
+    // Reference strings always have a length.
+    easl::reference_string<const char> ref      = {embedded, embedded + 4};
+    easl::reference_string<const char> refShort = {"AB", "AB" + 2};
+    EASL_CHECK(!easl::equal(ref, refShort, true));
+    EASL_CHECK(!easl::equal(ref, refShort, false));
+    EASL_CHECK(easl::equal(ref, ref, false));
+
+    // Literals.
+    EASL_CHECK(easl::equal("Content-Type", easl::make_literal("Content-Type")));
+    EASL_CHECK(easl::equal("content-type", easl::make_literal("Content-Type"), false));
+    EASL_CHECK(!easl::equal(embedded, easl::make_literal("AB"), false, 4));
+
+    return easl_test_result();
+}
@@ -0,0 +1,51 @@
+/**
+*   \file   fast_string.cpp
+*   \author Dave Reid
+*   \brief  Tests for the parts of fast_string that have to match slow_string.
+*/
+#include "easl.h"
+#include "test.h"
+
+int main()
+{
+    const char *text = "The quick brown fox jumps over the lazy dog";
+
+    // A string that has grown onto the heap and been cut back down goes back into the local buffer.
+    easl::fast_string<char> str(text);
+    EASL_CHECK(str.capacity() >= easl::length(text));
+    str = "short";
+    str.shrink_to_fit();
+    EASL_CHECK(str == "short");
+    EASL_CHECK(str.length() == 5);
+    EASL_CHECK(str.capacity() == EASL_OPTION_FAST_STRING_LOCAL_BYTES - 1);
+
+    // Shrinking a string in the local buffer does nothing.
+    str.shrink_to_fit();
+    EASL_CHECK(str == "short");
+    EASL_CHECK(str.capacity() == EASL_OPTION_FAST_STRING_LOCAL_BYTES - 1);
+
+    // A string that doesn't fit in the local buffer keeps a heap buffer of exactly its length.
+    easl::fast_string<char> heap(text);
+    heap.reserve(200);
+    EASL_CHECK(heap.capacity() == 200);
+    heap.shrink_to_fit();
+    EASL_CHECK(heap == text);
+    EASL_CHECK(heap.capacity() == heap.length());
+
+    heap += "!";
+    EASL_CHECK(heap.length() == easl::length(text) + 1);
+
+    // The allocator is always the heap.
+    easl::heap_allocator allocator = heap.get_allocator();
+    void *block = allocator.allocate(16);
+    allocator.deallocate(block);
+
+    // Code written against the typedefs builds with either class.
+    easl::string16 wide(text);
+    wide.reserve(100);
+    wide.shrink_to_fit();
+    EASL_CHECK(wide.length() == easl::length(text));
+    wide.get_allocator();
+
+    return easl_test_result();
+}
@@ -0,0 +1,62 @@
+/**
+*   \file   literal.cpp
+*   \author Dave Reid
+*   \brief  Tests for literal and the functions that take one.
+*/
+#include "easl.h"
+#include "equal.h"
+#include "test.h"
+
+static const char g_malformedByte[] = {'\xFF', '\0'};
+
+#ifdef EASL_HAS_RELAXED_CONSTEXPR
+// Transcoding at compile time fails to compile if a buffer is too small.
+static constexpr char g_malformedBytes[] = {'\xFF', '\xFE', '\x80', '\xC0', '\0'};
+static constexpr easl::literal<char, 5> g_compiled(g_malformedBytes);
+static_assert(g_compiled.length8() == 12, "Each malformed byte is a replacement character");
+static_assert(g_compiled.charcount() == 4, "Each malformed byte is a replacement character");
+#endif
+
+// Checks the lengths of every version of a literal, and that the UTF-8 version is what we expect.
+template <typename T, size_t N>
+void check_literal(const easl::literal<T, N> &lit, const char *utf8, size_t length16, size_t charcount)
+{
+    EASL_CHECK(lit.length8() == easl::length(utf8));
+    EASL_CHECK(easl::equal(lit.utf8(), utf8, true, lit.length8()));
+    EASL_CHECK(lit.utf8()[lit.length8()] == '\0');
+    EASL_CHECK(lit.length16() == length16);
+    EASL_CHECK(lit.utf16()[lit.length16()] == 0);
+    EASL_CHECK(lit.length32() == charcount);
+    EASL_CHECK(lit.charcount() == charcount);
+}
+
+int main()
+{
+    // A malformed byte becomes U+FFFD, which is three bytes in UTF-8.
+    easl::literal<char, 2> malformed(g_malformedByte);
+    check_literal(malformed, "\xEF\xBF\xBD", 1, 1);
+    EASL_CHECK(static_cast<easl::uchar16_t>(malformed.utf16()[0]) == 0xFFFD);
+    EASL_CHECK(static_cast<easl::uchar32_t>(malformed.utf32()[0]) == 0xFFFD);
+    EASL_CHECK(malformed.wide()[0] == 0xFFFD);
+
+    check_literal(easl::make_literal("\xFF\xFE\x80\xC0"), "\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD", 4, 4);
+
+    // A sequence that is cut short by the end of the literal.
+    check_literal(easl::make_literal("a\xE2\x82"), "a\xEF\xBF\xBD", 2, 2);
+
+    // Overlong forms, surrogates and characters past U+10FFFF.
+    check_literal(easl::make_literal("\xC0\xAF"), "\xEF\xBF\xBD\xEF\xBF\xBD", 2, 2);
+    check_literal(easl::make_literal("\xE0\x80\xAF"), "\xEF\xBF\xBD", 1, 1);
+    check_literal(easl::make_literal("\xED\xA0\x80"), "\xEF\xBF\xBD", 1, 1);
+    check_literal(easl::make_literal("\xF4\x90\x80\x80"), "\xEF\xBF\xBD", 1, 1);
+
+    // Well formed text is copied as it is.
+    check_literal(easl::make_literal("h\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"), "h\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80", 5, 4);
+
+    // Strings are compared against the version with the same encoding.
+    EASL_CHECK(easl::equal("\xEF\xBF\xBD", malformed));
+    EASL_CHECK(easl::equal(L"\xFFFD", malformed));
+    EASL_CHECK(!easl::equal("\xFF", malformed));
+
+    return easl_test_result();
+}
@@ -0,0 +1,35 @@
+/**
+*   \file   test.h
+*   \author Dave Reid
+*   \brief  Header file for the checks shared by the tests.
+*
+*   Each test is a program that runs its checks from main() and returns easl_test_result(). A
+*   failed check prints the file, line and condition, and the remaining checks still run.
+*/
+#ifndef __EASL_TEST_H_
+#define __EASL_TEST_H_
+
+#include <stdio.h>
+
+/// The number of checks that have failed so far.
+static int g_testFailures = 0;
+
+#define EASL_CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++g_testFailures; \
+        } \
+    } while (0)
+
+/**
+*   \brief  Retrieves the value main() should return.
+*/
+inline int easl_test_result()
+{
+    return (g_testFailures == 0) ? 0 : 1;
+}
+
+#endif // __EASL_TEST_H_